@@ -0,0 +1,63 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_CLIENT_BLOOM_FILTER_H_
+#define MAIDSAFE_NFS_CLIENT_BLOOM_FILTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace maidsafe {
+
+namespace nfs {
+
+// Fixed-size bloom filter over strings.  'Add' and 'MightContain' may be called concurrently.
+class BloomFilter {
+ public:
+  BloomFilter(uint64_t capacity, double false_positive_rate);
+
+  // Returns true if 'key' wasn't already (possibly) present.
+  bool Add(const std::string& key);
+  bool MightContain(const std::string& key) const;
+
+  uint64_t capacity() const { return kCapacity_; }
+  uint64_t size() const { return size_; }
+  // The false positive rate implied by the current number of entries.
+  double ExpectedFalsePositiveRate() const;
+
+ private:
+  BloomFilter(const BloomFilter&);
+  BloomFilter(BloomFilter&&);
+  BloomFilter& operator=(BloomFilter);
+
+  std::pair<uint64_t, uint64_t> Hash(const std::string& key) const;
+
+  const uint64_t kCapacity_, kBitCount_;
+  const uint32_t kHashCount_;
+  std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+  std::atomic<uint64_t> size_;
+};
+
+}  // namespace nfs
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_CLIENT_BLOOM_FILTER_H_
@@ -23,12 +23,16 @@
 #include <vector>
 
 #include "boost/exception/all.hpp"
+#include "boost/optional/optional.hpp"
 #include "boost/thread/future.hpp"
 
+#include "maidsafe/common/rsa.h"
 #include "maidsafe/common/data_types/structured_data_versions.h"
+#include "maidsafe/passport/types.h"
 
 #include "maidsafe/routing/timer.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/utils.h"
 #include "maidsafe/nfs/client/messages.h"
 #include "maidsafe/nfs/client/maid_node_dispatcher.h"
@@ -48,6 +52,9 @@ struct HandleGetResult {
 void HandlePutResponseResult(const ReturnCode& result,
                              std::shared_ptr<boost::promise<void>> promise);
 
+// Returns the public key from the result of getting a PublicPmid, or none if the get failed.
+boost::optional<asymm::PublicKey> PublicPmidKey(const DataNameAndContentOrReturnCode& result);
+
 void HandleSendMessageResponseResult(const ReturnCode& result,
                                      std::shared_ptr<boost::promise<void>> promise);
 void HandleGetMessageResponseResult(const MpidMessageOrReturnCode& result,
@@ -73,16 +80,16 @@ void HandleRegisterPmidResult(const ReturnCode& result,
 // ==================== Implementation =============================================================
 template <typename Data>
 void HandleGetResult<Data>::operator()(const DataNameAndContentOrReturnCode& result) const {
-  LOG(kVerbose) << "HandleGetResult<Data>::operator()";
+  NFS_LOG(kVerbose) << "HandleGetResult<Data>::operator()";
   try {
     if (result.content) {
       if (result.name.type != Data::Tag::kValue) {
         LOG(kError) << "HandleGetResult incorrect returned data";
         BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_argument));
       }
-      LOG(kInfo) << "HandleGetResult fetched chunk has name : "
-                 << HexSubstr(result.name.raw_name) << " and content : "
-                 << HexSubstr(result.content->data);
+      NFS_LOG(kInfo) << "HandleGetResult fetched chunk has name : "
+                     << HexSubstr(result.name.raw_name) << " and content : "
+                     << HexSubstr(result.content->data);
       Data data(typename Data::Name(result.name.raw_name),
                 typename Data::serialised_type(NonEmptyString(result.content->data)));
       promise->set_value(data);
@@ -33,6 +33,7 @@
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/timer.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/message_wrapper.h"
 #include "maidsafe/nfs/service.h"
 #include "maidsafe/nfs/utils.h"
@@ -40,6 +41,7 @@
 #include "maidsafe/nfs/client/data_getter_dispatcher.h"
 #include "maidsafe/nfs/client/data_getter_service.h"
 #include "maidsafe/nfs/client/get_handler.h"
+#include "maidsafe/nfs/client/ready_queue.h"
 
 namespace maidsafe {
 
@@ -61,6 +63,21 @@ class DataGetter {
       const DataName& data_name,
       const std::chrono::steady_clock::duration& timeout = std::chrono::seconds(120));
 
+  // As above, with the result given to 'promise', for callers which have already handed out its
+  // future.  If 'ready_queue' is given, the request is held by it until it's released, though the
+  // timeout starts immediately.
+  template <typename DataName>
+  void Get(const DataName& data_name,
+           std::shared_ptr<boost::promise<typename DataName::data_type>> promise,
+           const std::chrono::steady_clock::duration& timeout = std::chrono::seconds(120),
+           ReadyQueue* ready_queue = nullptr);
+
+  // As above, with the unparsed result given to 'response_functor' as soon as the get completes.
+  template <typename DataName>
+  void Get(const DataName& data_name,
+           std::function<void(const DataNameAndContentOrReturnCode&)> response_functor,
+           const std::chrono::steady_clock::duration& timeout = std::chrono::seconds(120));
+
   template <typename DataName>
   VersionNamesFuture GetVersions(const DataName& data_name,
                                  const std::chrono::steady_clock::duration& timeout =
@@ -102,10 +119,26 @@ template <typename DataName>
 boost::future<typename DataName::data_type> DataGetter::Get(
     const DataName& data_name,
     const std::chrono::steady_clock::duration& timeout) {
-  LOG(kVerbose) << "MaidClient Get " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "MaidClient Get " << HexSubstr(data_name.value);
   auto promise(std::make_shared<boost::promise<typename DataName::data_type>>());
-  get_handler_.Get(data_name, promise, timeout);
-  return promise->get_future();
+  auto future(promise->get_future());
+  Get(data_name, std::move(promise), timeout);
+  return future;
+}
+
+template <typename DataName>
+void DataGetter::Get(const DataName& data_name,
+                     std::shared_ptr<boost::promise<typename DataName::data_type>> promise,
+                     const std::chrono::steady_clock::duration& timeout,
+                     ReadyQueue* ready_queue) {
+  get_handler_.Get(data_name, std::move(promise), timeout, ready_queue);
+}
+
+template <typename DataName>
+void DataGetter::Get(const DataName& data_name,
+                     std::function<void(const DataNameAndContentOrReturnCode&)> response_functor,
+                     const std::chrono::steady_clock::duration& timeout) {
+  get_handler_.Get(data_name, std::move(response_functor), timeout);
 }
 
 template <typename DataName>
@@ -148,17 +181,22 @@ DataGetter::VersionNamesFuture DataGetter::GetBranch(
 
 template <typename T>
 void DataGetter::HandleMessage(const T& routing_message) {
-  auto wrapper_tuple(nfs::ParseMessageWrapper(routing_message.contents));
-  const auto& destination_persona(std::get<2>(wrapper_tuple));
-  static_assert(std::is_same<decltype(destination_persona),
-                             const nfs::detail::DestinationTaggedValue&>::value,
-                "The value retrieved from the tuple isn't the destination type, but should be.");
-  if (destination_persona.data == nfs::Persona::kDataGetter)
-    return service_.HandleMessage(wrapper_tuple, routing_message.sender, routing_message.receiver);
-  auto action(std::get<0>(wrapper_tuple));
-  auto source_persona(std::get<1>(wrapper_tuple).data);
-  LOG(kError) << " DataGetter::HandleMessage unhandled message from " << source_persona
-              << " " << action << " to " << destination_persona;
+  const auto view(nfs::ParseMessageWrapperView(routing_message.contents));
+  if (view.destination_persona != nfs::Persona::kDataGetter) {
+    LOG(kError) << " DataGetter::HandleMessage unhandled message from " << view.source_persona
+                << " " << view.action << " to " << view.destination_persona;
+    return;
+  }
+  // Under group fan-in most responses to a get arrive after it has completed; drop these before
+  // the (chunk-sized) contents are copied or parsed.
+  if ((view.action == nfs::MessageAction::kGetResponse ||
+       view.action == nfs::MessageAction::kGetCachedResponse) &&
+      !get_handler_.IsAwaiting(view.message_id.data)) {
+    NFS_LOG(kVerbose) << " DataGetter::HandleMessage dropping late " << view.action
+                      << " with message id " << view.message_id.data;
+    return;
+  }
+  service_.HandleMessage(view.ToTypeErased(), routing_message.sender, routing_message.receiver);
 }
 
 }  // namespace nfs_client
@@ -26,6 +26,7 @@
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/timer.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/message_types.h"
 #include "maidsafe/nfs/types.h"
 #include "maidsafe/nfs/client/messages.h"
@@ -65,8 +66,8 @@ class DataGetterDispatcher {
 // ==================== Implementation =============================================================
 template <typename DataName>
 void DataGetterDispatcher::SendGetRequest(routing::TaskId task_id, const DataName& data_name) {
-  LOG(kVerbose) << "DataGetterDispatcher::SendGetRequest " << HexSubstr(data_name.value)
-                << " with task_id : " << task_id;
+  NFS_LOG(kVerbose) << "DataGetterDispatcher::SendGetRequest " << HexSubstr(data_name.value)
+                    << " with task_id : " << task_id;
   typedef nfs::GetRequestFromDataGetterToDataManager NfsMessage;
   CheckSourcePersonaType<NfsMessage>();
   typedef routing::Message<NfsMessage::Sender, NfsMessage::Receiver> RoutingMessage;
@@ -78,8 +79,8 @@ void DataGetterDispatcher::SendGetRequest(routing::TaskId task_id, const DataNam
   NfsMessage::Receiver receiver(routing::GroupId(NodeId(data_name->string())));
   RoutingMessage routing_message(nfs_message.Serialise(), kThisNodeAsSender_, receiver, kCacheable);
   routing_.Send(routing_message);
-  LOG(kVerbose) << "DataGetterDispatcher::SendGetRequest " << HexSubstr(data_name.value)
-                << " routing message sent";
+  NFS_LOG(kVerbose) << "DataGetterDispatcher::SendGetRequest " << HexSubstr(data_name.value)
+                    << " routing message sent";
 }
 
 template <typename DataName>
@@ -94,8 +95,8 @@ void DataGetterDispatcher::SendGetVersionsRequest(routing::TaskId task_id,
   NfsMessage nfs_message(message_id, content);
   NfsMessage::Receiver receiver(routing::GroupId(NodeId(data_name->string())));
   routing_.Send(RoutingMessage(nfs_message.Serialise(), kThisNodeAsSender_, receiver));
-  LOG(kVerbose) << "DataGetterDispatcher::SendGetVersionsRequest " << HexSubstr(data_name.value)
-                << " routing message sent";
+  NFS_LOG(kVerbose) << "DataGetterDispatcher::SendGetVersionsRequest " << HexSubstr(data_name.value)
+                    << " routing message sent";
 }
 
 template <typename DataName>
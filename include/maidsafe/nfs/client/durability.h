@@ -0,0 +1,35 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_CLIENT_DURABILITY_H_
+#define MAIDSAFE_NFS_CLIENT_DURABILITY_H_
+
+namespace maidsafe {
+
+namespace nfs {
+
+// kNone leaves flushing to the OS.  kGroupCommit holds each write's future until the data has been
+// flushed to disk; writes arriving within the commit window of each other are flushed together,
+// each file and directory they touched being flushed once.
+enum class Durability : int { kNone = 0, kGroupCommit = 1 };
+
+}  // namespace nfs
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_CLIENT_DURABILITY_H_
@@ -19,9 +19,17 @@
 #ifndef MAIDSAFE_NFS_CLIENT_FAKE_STORE_H_
 #define MAIDSAFE_NFS_CLIENT_FAKE_STORE_H_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -42,6 +50,10 @@
 #include "maidsafe/common/data_types/structured_data_versions.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/nfs/log.h"
+#include "maidsafe/nfs/client/bloom_filter.h"
+#include "maidsafe/nfs/client/durability.h"
+
 namespace maidsafe {
 
 namespace nfs {
@@ -50,7 +62,13 @@ class FakeStore {
  public:
   typedef boost::future<std::vector<StructuredDataVersions::VersionName>> VersionNamesFuture;
 
-  FakeStore(const boost::filesystem::path& disk_path, DiskUsage max_disk_usage);
+  // How writes are flushed to disk; see durability.h.
+  typedef nfs::Durability Durability;
+
+  FakeStore(const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+            Durability durability = Durability::kNone,
+            const std::chrono::steady_clock::duration& commit_window =
+                std::chrono::milliseconds(2));
   ~FakeStore();
 
   template <typename DataName>
@@ -65,7 +83,11 @@ class FakeStore {
   boost::future<void> Delete(const DataName& data_name);
 
   void IncrementReferenceCount(const std::vector<ImmutableData::Name>& data_names);
+  // Decrements are journalled and applied by a background pass once 'grace_period' (see
+  // SetGarbageCollectionGracePeriod) has elapsed.  A chunk re-put or incremented before then keeps
+  // its file untouched.
   void DecrementReferenceCount(const std::vector<ImmutableData::Name>& data_names);
+  void SetGarbageCollectionGracePeriod(const std::chrono::steady_clock::duration& grace_period);
 
   template <typename DataName>
   boost::future<void> CreateVersionTree(const DataName& data_name,
@@ -101,19 +123,207 @@ class FakeStore {
   DiskUsage GetMaxDiskUsage() const;
   DiskUsage GetCurrentDiskUsage() const;
 
+  // Switches the store to cache mode.  Once usage reaches 'high_watermark' (as a fraction of the
+  // max disk usage) the least frequently accessed ImmutableData chunks with a reference count of
+  // one are evicted in the background until usage drops to 'low_watermark'.  Version trees are
+  // never evicted.  Writes are never refused for want of space while eviction is enabled: if
+  // eviction falls behind, usage overshoots the max until the next pass brings it back down.
+  void EnableEviction(double low_watermark = 0.8, double high_watermark = 0.9);
+  // Total bytes admitted beyond the max disk usage since eviction was enabled.
+  uint64_t GetEvictionOvershoot() const;
+
+  // Re-hashes every stored ImmutableData chunk on a background thread, reading at most
+  // 'bytes_per_second' from disk (0 for no limit).  Chunks whose content doesn't match their name
+  // are moved to a quarantine folder and passed to 'on_corruption'.  Progress is checkpointed, so
+  // a pass interrupted by StopScrubbing or by destruction resumes where it left off.  The future
+  // holds the number of corrupt chunks found.
+  boost::future<uint64_t> Scrub(
+      uint64_t bytes_per_second,
+      std::function<void(const ImmutableData::Name&)> on_corruption =
+          std::function<void(const ImmutableData::Name&)>());
+  void StopScrubbing();
+
+  // Streams every chunk (with its reference count) and version tree into a single archive file,
+  // optionally compressing each record.  The archive ends with a sorted index of record offsets, so
+  // GetFromArchive can binary search for a single entry.  Import merges an archive into this store;
+  // chunks already held have their reference counts added, existing version trees are left
+  // untouched.
+  void Export(const boost::filesystem::path& archive_path, bool compress) const;
+  // As Export, but for the store at 'disk_path', which is only read: nothing there is created,
+  // replayed, compacted or rewritten, and no background work is started.
+  static void Export(const boost::filesystem::path& disk_path,
+                     const boost::filesystem::path& archive_path, bool compress);
+  void Import(const boost::filesystem::path& archive_path);
+  static NonEmptyString GetFromArchive(const boost::filesystem::path& archive_path,
+                                       const DataNameVariant& data_name);
+
+  // A bloom filter of stored keys is built in the background when the store is opened, and rebuilt
+  // larger whenever it is half full.  Lookups it rules out never touch the disk.
+  struct KeyFilterStats {
+    KeyFilterStats()
+        : capacity(0), entries(0), lookups(0), definite_misses(0), false_positives(0),
+          expected_false_positive_rate(0.0), observed_false_positive_rate(0.0) {}
+    uint64_t capacity, entries, lookups, definite_misses, false_positives;
+    double expected_false_positive_rate, observed_false_positive_rate;
+  };
+  KeyFilterStats GetKeyFilterStats() const;
+
+  // Pages through everything held, in name order, from an in-memory index built in the background
+  // when the store is opened (the first call blocks until it's ready).  Each call resumes after
+  // 'cursor', returns at most 'max_entries' entries whose type is in 'types' (all types if empty),
+  // and sets 'cursor.done' once the end is reached.  Entries added or removed between calls are
+  // seen or skipped according to where they fall relative to the cursor.
+  struct StoredEntry {
+    StoredEntry(DataNameVariant name_in, uint64_t size_in, uint32_t reference_count_in,
+                bool versions_in)
+        : name(std::move(name_in)), size(size_in), reference_count(reference_count_in),
+          versions(versions_in) {}
+    DataNameVariant name;
+    uint64_t size;
+    uint32_t reference_count;
+    bool versions;
+  };
+  struct EnumerationCursor {
+    EnumerationCursor() : position(), done(false) {}
+    std::string position;
+    bool done;
+  };
+  std::vector<StoredEntry> Enumerate(
+      EnumerationCursor& cursor, size_t max_entries,
+      const std::vector<DataTagValue>& types = std::vector<DataTagValue>()) const;
+
+  // Bytes, objects and references held per data type.  The figures are atomics, so polling them is
+  // cheap.  Until the index above is ready, the figures saved at the last clean shutdown are
+  // returned (if any) and 'exact' is false.  References pending collection are counted until
+  // collected.
+  struct Usage {
+    Usage() : bytes(0), objects(0), references(0) {}
+    uint64_t bytes, objects, references;
+  };
+  struct UsageStats {
+    UsageStats() : exact(false), by_type() {}
+    bool exact;
+    std::map<DataTagValue, Usage> by_type;
+  };
+  UsageStats GetUsageStats() const;
+
+  // Snapshot fills 'destination' (which must be empty or absent) with an independent copy of this
+  // store, and Clone also opens a store there.  Files are reflinked where the filesystem supports
+  // it, else hard linked, else copied; the method used is returned.  Writes to either store never
+  // show through to the other.  A store opened over a snapshot starts with this store's usage.
+  // The store stays usable while the snapshot is taken, though writes made meanwhile may or may
+  // not be included.
+  enum class SnapshotMethod : int { kReflink = 0, kHardLink = 1, kCopy = 2 };
+  SnapshotMethod Snapshot(const boost::filesystem::path& destination) const;
+  std::unique_ptr<FakeStore> Clone(const boost::filesystem::path& destination) const;
+
  private:
   typedef DataNameVariant KeyType;
+  struct ReadOnly {};
   typedef boost::promise<std::vector<StructuredDataVersions::VersionName>> VersionNamesPromise;
 
+  struct AccessInfo {
+    AccessInfo() : hits(0), last_access(0) {}
+    uint64_t hits, last_access;
+  };
+
+  struct PendingDecrement {
+    PendingDecrement() : file_name(), count(0), recorded() {}
+    std::string file_name;
+    uint32_t count;
+    std::chrono::steady_clock::time_point recorded;
+  };
+
+  struct IndexEntry {
+    IndexEntry() : tag(), size(0), reference_count(0) {}
+    DataTagValue tag;
+    uint64_t size;
+    uint32_t reference_count;
+  };
+
+  struct UsageCounters {
+    UsageCounters() : bytes(0), objects(0), references(0) {}
+    std::atomic<uint64_t> bytes, objects, references;
+  };
+
+  struct PendingCommit {
+    PendingCommit(std::vector<boost::filesystem::path> paths_in,
+                  std::shared_ptr<boost::promise<void>> promise_in)
+        : paths(std::move(paths_in)), promise(std::move(promise_in)) {}
+    std::vector<boost::filesystem::path> paths;
+    std::shared_ptr<boost::promise<void>> promise;
+  };
+
+  // Opens an existing store for reading only.  Its journal is read but not compacted, no background
+  // threads are started and the usage ledger isn't written on destruction.
+  FakeStore(const boost::filesystem::path& disk_path, ReadOnly);
   FakeStore(const FakeStore&);
   FakeStore(FakeStore&&);
   FakeStore& operator=(FakeStore);
 
   NonEmptyString DoGet(const KeyType& key) const;
-  void DoPut(const KeyType& key, const NonEmptyString& value);
-  void DoDelete(const KeyType& key);
-  void DoIncrement(const std::vector<ImmutableData::Name>& data_names);
-  void DoDecrement(const std::vector<ImmutableData::Name>& data_names);
+  boost::filesystem::path DoPut(const KeyType& key, const NonEmptyString& value);
+  boost::filesystem::path DoDelete(const KeyType& key);
+  std::vector<boost::filesystem::path> DoIncrement(
+      const std::vector<ImmutableData::Name>& data_names);
+  std::vector<boost::filesystem::path> DoDecrement(
+      const std::vector<ImmutableData::Name>& data_names);
+
+  // Fulfils 'promise' (which may be null) once all of 'paths' are durable under the configured
+  // durability mode.
+  void Commit(std::vector<boost::filesystem::path> paths,
+              std::shared_ptr<boost::promise<void>> promise);
+  void CommitLoop();
+  void FlushToDisk(const std::vector<boost::filesystem::path>& paths) const;
+
+  // RecordAccess and ScheduleEviction must be called with 'mutex_' held.
+  void RecordAccess(const boost::filesystem::path& base_path) const;
+  void ScheduleEviction();
+  void Evict();
+
+  // PendingDecrements, CancelPendingDecrement, AppendToJournal and CompactJournal must be called
+  // with 'mutex_' held.  CompactJournal atomically rewrites the journal to hold just the
+  // outstanding decrements.
+  uint32_t PendingDecrements(const boost::filesystem::path& base_path) const;
+  bool CancelPendingDecrement(const boost::filesystem::path& base_path);
+  void AppendToJournal(const std::string& entries);
+  void CompactJournal();
+  void ReplayJournal();
+  void GarbageCollectionLoop();
+  void CollectGarbage();
+
+  bool MayContain(const std::string& file_name) const;
+  void RecordFalsePositive() const;
+  void AddToKeyFilter(const std::string& file_name);
+  // Must be called with 'filter_mutex_' held.
+  void ScheduleKeyFilterRebuild(uint64_t capacity);
+  void RebuildKeyFilter();
+
+  uint64_t DoScrub(uint64_t bytes_per_second,
+                   const std::function<void(const ImmutableData::Name&)>& on_corruption);
+  // Moves the chunk at 'path' to the quarantine folder if, checked again under 'mutex_', its
+  // content still doesn't match 'name'.  'file_name' is its full name, as given by WalkStore.
+  bool Quarantine(const boost::filesystem::path& path, const std::string& file_name,
+                  const ImmutableData::Name& name);
+
+  // Visits stored files in name order, skipping those named up to and including 'resume_after'.
+  // 'visit' is passed the file's path and its full name (the concatenation of the directories
+  // below the root and the file's stem), and returns false to stop the walk.
+  void WalkStore(const std::string& resume_after,
+                 const std::function<bool(const boost::filesystem::path&,
+                                          const std::string&)>& visit) const;
+
+  // The index is keyed by the file's full name, with ".ver" appended for version trees.
+  // IndexName, UpdateIndex, EraseFromIndex and Account must be called with 'mutex_' held.
+  std::string IndexName(const boost::filesystem::path& path) const;
+  void UpdateIndex(const boost::filesystem::path& path, uintmax_t size);
+  void EraseFromIndex(const boost::filesystem::path& path);
+  void Account(const IndexEntry& entry, bool add);
+  // The usage ledger records the disk usage and per-type figures.  SaveUsageLedger writes it into
+  // 'directory' and must be called with 'mutex_' held or once no other thread uses the store.
+  void LoadUsageLedger();
+  void SaveUsageLedger(const boost::filesystem::path& directory) const;
+  void BuildIndex();
 
   boost::filesystem::path GetFilePath(const KeyType& key) const;
   bool HasDiskSpace(uint64_t required_space) const;
@@ -126,15 +336,45 @@ class FakeStore {
                    const boost::filesystem::path& new_path);
 
   std::unique_ptr<StructuredDataVersions> ReadVersions(const KeyType& key) const;
-  void WriteVersions(
+  boost::filesystem::path WriteVersions(
       const KeyType& key, const StructuredDataVersions& versions, const bool creation);
 
   BoostAsioService asio_service_;
   const boost::filesystem::path kDiskPath_;
+  const bool kReadOnly_;
   DiskUsage max_disk_usage_, current_disk_usage_;
   const uint32_t kDepth_;
   mutable std::mutex mutex_;
   GetIdentityVisitor get_identity_visitor_;
+  bool eviction_enabled_, eviction_running_;
+  double low_watermark_, high_watermark_;
+  uint64_t eviction_overshoot_;
+  mutable std::map<boost::filesystem::path, AccessInfo> access_info_;
+  mutable uint64_t access_clock_;
+  const Durability kDurability_;
+  const std::chrono::steady_clock::duration kCommitWindow_;
+  std::vector<PendingCommit> pending_commits_;
+  std::mutex commit_mutex_;
+  std::condition_variable commit_condition_;
+  bool stop_committing_;
+  std::thread commit_thread_;
+  std::atomic<bool> stop_scrubbing_;
+  std::mutex scrub_mutex_;
+  std::condition_variable scrub_condition_;
+  std::thread scrub_thread_;
+  std::map<boost::filesystem::path, PendingDecrement> pending_decrements_;
+  std::chrono::steady_clock::duration gc_grace_period_;
+  std::mutex gc_mutex_;
+  std::condition_variable gc_condition_;
+  bool stop_gc_;
+  std::thread gc_thread_;
+  mutable std::mutex filter_mutex_;
+  std::shared_ptr<BloomFilter> key_filter_, next_key_filter_;
+  mutable std::atomic<uint64_t> filter_lookups_, filter_misses_, filter_false_positives_;
+  std::map<std::string, IndexEntry> index_;
+  boost::shared_future<void> index_ready_;
+  std::array<UsageCounters, 64> type_usage_;
+  std::unique_ptr<UsageStats> ledger_usage_;
 };
 
 // ==================== Implementation =============================================================
@@ -142,14 +382,14 @@ template <typename DataName>
 boost::future<typename DataName::data_type> FakeStore::Get(
     const DataName& data_name,
     const std::chrono::steady_clock::duration& /*timeout*/) {
-  LOG(kVerbose) << "Getting: " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "Getting: " << HexSubstr(data_name.value);
   auto promise(std::make_shared<boost::promise<typename DataName::data_type>>());
   auto async_future(boost::async([=] {
     try {
       auto result(this->DoGet(KeyType(data_name)));
       typename DataName::data_type data(data_name,
                                         typename DataName::data_type::serialised_type(result));
-      LOG(kVerbose) << "Got: " << HexSubstr(data_name.value) << "  " << HexSubstr(result);
+      NFS_LOG(kVerbose) << "Got: " << HexSubstr(data_name.value) << "  " << HexSubstr(result);
       promise->set_value(data);
     }
     catch (const std::exception& e) {
@@ -163,13 +403,14 @@ boost::future<typename DataName::data_type> FakeStore::Get(
 
 template <typename Data>
 boost::future<void> FakeStore::Put(const Data& data) {
-  LOG(kVerbose) << "Putting: " << HexSubstr(data.name().value) << "  "
-                << HexSubstr(data.Serialise().data);
+  NFS_LOG(kVerbose) << "Putting: " << HexSubstr(data.name().value) << "  "
+                    << HexSubstr(data.Serialise().data);
   const auto promise(std::make_shared<boost::promise<void>>());
   asio_service_.service().post([this, data, promise] {
     try {
-      DoPut(KeyType(data.name()), data.Serialise());
-      promise->set_value();
+      Commit(std::vector<boost::filesystem::path>(1, DoPut(KeyType(data.name()),
+                                                           data.Serialise())),
+             promise);
     }
     catch (const std::exception& e) {
       LOG(kWarning) << "Put failed: " << boost::diagnostic_information(e);
@@ -181,12 +422,11 @@ boost::future<void> FakeStore::Put(const Data& data) {
 
 template <typename DataName>
 boost::future<void> FakeStore::Delete(const DataName& data_name) {
-  LOG(kVerbose) << "Deleting: " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "Deleting: " << HexSubstr(data_name.value);
   const auto promise(std::make_shared<boost::promise<void>>());
   asio_service_.service().post([this, data_name, promise] {
     try {
-      DoDelete(KeyType(data_name));
-      promise->set_value();
+      Commit(std::vector<boost::filesystem::path>(1, DoDelete(KeyType(data_name))), promise);
     }
     catch (const std::exception& e) {
       LOG(kWarning) << "Delete failed: " << boost::diagnostic_information(e);
@@ -202,15 +442,18 @@ boost::future<void> FakeStore::CreateVersionTree(const DataName& data_name,
                        const StructuredDataVersions::VersionName& version_name,
                        uint32_t max_versions, uint32_t max_branches,
                        const std::chrono::steady_clock::duration& /*timeout*/) {
-  LOG(kVerbose) << "Create Version " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "Create Version " << HexSubstr(data_name.value);
   auto promise(std::make_shared<boost::promise<void>>());
   try {
     KeyType key(data_name);
     StructuredDataVersions versions(max_versions, max_branches);
-    std::lock_guard<std::mutex> lock(this->mutex_);
-    versions.Put(StructuredDataVersions::VersionName(), version_name);
-    WriteVersions(key, versions, true);
-    promise->set_value();
+    boost::filesystem::path file_path;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex_);
+      versions.Put(StructuredDataVersions::VersionName(), version_name);
+      file_path = WriteVersions(key, versions, true);
+    }
+    Commit(std::vector<boost::filesystem::path>(1, file_path), promise);
   }
   catch (const std::exception& e) {
     LOG(kError) << "Failed creating versions: " << e.what();
@@ -222,7 +465,7 @@ boost::future<void> FakeStore::CreateVersionTree(const DataName& data_name,
 template <typename DataName>
 FakeStore::VersionNamesFuture FakeStore::GetVersions(
     const DataName& data_name, const std::chrono::steady_clock::duration& /*timeout*/) {
-  LOG(kVerbose) << "Getting versions: " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "Getting versions: " << HexSubstr(data_name.value);
   auto promise(std::make_shared<VersionNamesPromise>());
   auto async_future(boost::async([=] {
     try {
@@ -246,8 +489,8 @@ template <typename DataName>
 FakeStore::VersionNamesFuture FakeStore::GetBranch(
     const DataName& data_name, const StructuredDataVersions::VersionName& branch_tip,
     const std::chrono::steady_clock::duration& /*timeout*/) {
-  LOG(kVerbose) << "Getting branch: " << HexSubstr(data_name.value) << ".  Tip: "
-                << branch_tip.index << "-" << HexSubstr(branch_tip.id.value);
+  NFS_LOG(kVerbose) << "Getting branch: " << HexSubstr(data_name.value) << ".  Tip: "
+                    << branch_tip.index << "-" << HexSubstr(branch_tip.id.value);
   auto promise(std::make_shared<VersionNamesPromise>());
   auto async_future(boost::async([=] {
     try {
@@ -272,52 +515,62 @@ boost::future<void> FakeStore::PutVersion(
     const DataName& data_name,
     const StructuredDataVersions::VersionName& old_version_name,
     const StructuredDataVersions::VersionName& new_version_name) {
-  LOG(kVerbose) << "Putting version: " << HexSubstr(data_name.value) << ".  Old: "
-                << (old_version_name.id.value.IsInitialised() ?
-                       (std::to_string(old_version_name.index) + "-" +
-                           HexSubstr(old_version_name.id.value)) : "N/A") << "  New: "
-                << new_version_name.index << "-" << HexSubstr(new_version_name.id.value);
+  NFS_LOG(kVerbose) << "Putting version: " << HexSubstr(data_name.value) << ".  Old: "
+                    << (old_version_name.id.value.IsInitialised() ?
+                           (std::to_string(old_version_name.index) + "-" +
+                               HexSubstr(old_version_name.id.value)) : "N/A") << "  New: "
+                    << new_version_name.index << "-" << HexSubstr(new_version_name.id.value);
+  auto promise(std::make_shared<boost::promise<void>>());
   try {
     KeyType key(data_name);
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto versions(ReadVersions(key));
-    if (!versions) {
-      LOG(kError) << "Failed to read versions";
-      return boost::make_exceptional_future<void>(MakeError(VaultErrors::no_such_account));
+    boost::filesystem::path file_path;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto versions(ReadVersions(key));
+      if (!versions) {
+        LOG(kError) << "Failed to read versions";
+        return boost::make_exceptional_future<void>(MakeError(VaultErrors::no_such_account));
+      }
+      versions->Put(old_version_name, new_version_name);
+      file_path = WriteVersions(key, *versions, false);
     }
-    versions->Put(old_version_name, new_version_name);
-    WriteVersions(key, *versions, false);
+    Commit(std::vector<boost::filesystem::path>(1, file_path), promise);
   }
   catch (const std::exception& e) {
     LOG(kError) << "Failed putting version: " << boost::diagnostic_information(e);
     return boost::make_exceptional_future<void>(boost::current_exception());
   }
 
-  return boost::make_ready_future();
+  return promise->get_future();
 }
 
 template <typename DataName>
 boost::future<void> FakeStore::DeleteBranchUntilFork(
     const DataName& data_name,
     const StructuredDataVersions::VersionName& branch_tip) {
-  LOG(kVerbose) << "Deleting branch: " << HexSubstr(data_name.value) << ".  Tip: "
-                << branch_tip.index << "-" << HexSubstr(branch_tip.id.value);
+  NFS_LOG(kVerbose) << "Deleting branch: " << HexSubstr(data_name.value) << ".  Tip: "
+                    << branch_tip.index << "-" << HexSubstr(branch_tip.id.value);
+  auto promise(std::make_shared<boost::promise<void>>());
   try {
     KeyType key(data_name);
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto versions(ReadVersions(key));
-    if (!versions) {
-      return boost::make_exceptional_future<void>(MakeError(CommonErrors::no_such_element));
+    boost::filesystem::path file_path;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto versions(ReadVersions(key));
+      if (!versions) {
+        return boost::make_exceptional_future<void>(MakeError(CommonErrors::no_such_element));
+      }
+      versions->DeleteBranchUntilFork(branch_tip);
+      file_path = WriteVersions(key, *versions, false);
     }
-    versions->DeleteBranchUntilFork(branch_tip);
-    WriteVersions(key, *versions, false);
+    Commit(std::vector<boost::filesystem::path>(1, file_path), promise);
   }
   catch (const std::exception& e) {
     LOG(kError) << "Failed deleting branch: " << boost::diagnostic_information(e);
     return boost::make_exceptional_future<void>(boost::current_exception());
   }
 
-  return boost::make_ready_future();
+  return promise->get_future();
 }
 
 }  // namespace nfs
@@ -19,9 +19,12 @@
 #ifndef MAIDSAFE_NFS_CLIENT_GET_HANDLER_H_
 #define MAIDSAFE_NFS_CLIENT_GET_HANDLER_H_
 
-#include <map>
-#include <tuple>
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "boost/thread/future.hpp"
@@ -31,12 +34,14 @@
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/timer.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/service.h"
 #include "maidsafe/nfs/client/maid_node_dispatcher.h"
 #include "maidsafe/nfs/client/maid_node_service.h"
 #include "maidsafe/nfs/client/mpid_node_dispatcher.h"
 #include "maidsafe/nfs/client/mpid_node_service.h"
 #include "maidsafe/nfs/client/client_utils.h"
+#include "maidsafe/nfs/client/ready_queue.h"
 
 namespace maidsafe {
 
@@ -50,8 +55,8 @@ class GetHandlerVisitor : public boost::static_visitor<> {
 
   template <typename Name>
   void operator()(const Name& data_name) {
-    LOG(kVerbose) << "Get handler visitor sending get request for chunk "
-                  << HexSubstr(data_name.value.string());
+    NFS_LOG(kVerbose) << "Get handler visitor sending get request for chunk "
+                      << HexSubstr(data_name.value.string());
     dispatcher_.SendGetRequest(kTaskId_, data_name);
   }
 
@@ -62,6 +67,7 @@ class GetHandlerVisitor : public boost::static_visitor<> {
 
 class ValidateDataVisitor : public boost::static_visitor<bool> {
  public:
+  // 'content' must outlive the visitor.
   explicit ValidateDataVisitor(const nfs_vault::Content& content) : content_(content) {}
 
   template<typename DataNameType>
@@ -72,12 +78,34 @@ class ValidateDataVisitor : public boost::static_visitor<bool> {
   }
 
  private:
-  nfs_vault::Content content_;
+  const nfs_vault::Content& content_;
 };
 
 template <typename DispatcherType>
 class GetHandler {
-  typedef std::tuple<size_t, routing::TaskId, DataNameVariant> GetInfo;
+  // A get keeps its original task id (which the timer knows it by) for its whole life, and is
+  // given a new current task id each time it's retried.  The table maps both to the same GetInfo,
+  // so a retry just adds a key, and responses to superseded task ids are ignored.
+  struct GetInfo {
+    GetInfo(routing::TaskId task_id, DataNameVariant data_name_in)
+        : mutex(), response_count(0), kOriginalTaskId(task_id), current_task_id(task_id),
+          finished(false), validated(false), kDataName(std::move(data_name_in)) {}
+    std::mutex mutex;
+    size_t response_count;
+    const routing::TaskId kOriginalTaskId;
+    routing::TaskId current_task_id;
+    // 'validated' is set once a response's content has been validated and passed to the timer;
+    // further content is then dropped without being validated.
+    bool finished, validated;
+    const DataNameVariant kDataName;
+  };
+
+  struct Shard {
+    Shard() : mutex(), get_info() {}
+    std::mutex mutex;
+    std::unordered_map<routing::TaskId, std::shared_ptr<GetInfo>> get_info;
+  };
+
   enum class Operation : int {
     kNoOperation = 0,
     kAddResponse = 1,
@@ -88,21 +116,43 @@ class GetHandler {
  public:
   GetHandler(routing::Timer<DataNameAndContentOrReturnCode>& get_timer,
              DispatcherType& dispatcher)
-      : get_timer_(get_timer), dispatcher_(dispatcher), get_info_(), mutex_() {}
+      : get_timer_(get_timer), dispatcher_(dispatcher), shards_() {}
 
+  // If 'ready_queue' is given, the request is held by it until it's released.  The timeout starts
+  // immediately regardless, so a get which is held too long fails rather than waiting forever.
   template <typename DataName>
   void Get(const DataName& data_name,
            std::shared_ptr<boost::promise<typename DataName::data_type>> promise,
-           const std::chrono::steady_clock::duration& timeout);
+           const std::chrono::steady_clock::duration& timeout,
+           ReadyQueue* ready_queue = nullptr);
+
+  // As above, but with the result given to 'response_functor' by the thread completing the get.
+  template <typename DataName>
+  void Get(const DataName& data_name,
+           std::function<void(const DataNameAndContentOrReturnCode&)> response_functor,
+           const std::chrono::steady_clock::duration& timeout,
+           ReadyQueue* ready_queue = nullptr);
 
   void AddResponse(routing::TaskId task_id, const DataNameAndContentOrReturnCode& response);
 
+  // Returns false if a response for 'task_id' would be ignored by 'AddResponse' (the get has
+  // completed, been retried under a new task id, or was never made), so that the response can be
+  // dropped before its contents are parsed.
+  bool IsAwaiting(routing::TaskId task_id);
+
  private:
   bool ValidateData(const nfs_vault::Content& content, const DataNameVariant& data_name);
+
+  // Task ids are allocated sequentially, so consecutive gets land in different shards.
+  Shard& GetShard(routing::TaskId task_id) { return shards_[task_id % shards_.size()]; }
+  void Insert(routing::TaskId task_id, std::shared_ptr<GetInfo> get_info);
+  std::shared_ptr<GetInfo> Find(routing::TaskId task_id);
+  std::shared_ptr<GetInfo> Erase(routing::TaskId task_id);
+  void Finish(routing::TaskId original_task_id);
+
   routing::Timer<DataNameAndContentOrReturnCode>& get_timer_;
   DispatcherType& dispatcher_;
-  std::map<routing::TaskId, GetInfo> get_info_;
-  std::mutex mutex_;
+  std::array<Shard, 32> shards_;
 };
 
 template <typename DispatcherType>
@@ -110,66 +160,71 @@ template <typename DataName>
 void GetHandler<DispatcherType>::Get(
     const DataName& data_name,
     std::shared_ptr<boost::promise<typename DataName::data_type>> promise,
-    const std::chrono::steady_clock::duration& timeout) {
+    const std::chrono::steady_clock::duration& timeout, ReadyQueue* ready_queue) {
+  Get(data_name,
+      std::function<void(const DataNameAndContentOrReturnCode&)>(
+          HandleGetResult<typename DataName::data_type>(std::move(promise))),
+      timeout, ready_queue);
+}
+
+template <typename DispatcherType>
+template <typename DataName>
+void GetHandler<DispatcherType>::Get(
+    const DataName& data_name,
+    std::function<void(const DataNameAndContentOrReturnCode&)> response_functor,
+    const std::chrono::steady_clock::duration& timeout, ReadyQueue* ready_queue) {
   auto task_id(get_timer_.NewTaskId());
-  HandleGetResult<typename DataName::data_type> response_functor(promise);
   auto op_data(
            std::make_shared<nfs::OpData<DataNameAndContentOrReturnCode>>(1, response_functor));
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    get_info_.insert(std::make_pair(task_id, std::make_tuple(0, task_id,
-                                    GetDataNameVariant(DataName::data_type::Tag::kValue,
-                                                       data_name.value))));
-  }
+  Insert(task_id, std::make_shared<GetInfo>(
+                      task_id, GetDataNameVariant(DataName::data_type::Tag::kValue,
+                                                  data_name.value)));
   get_timer_.AddTask(timeout,
                      [op_data, data_name, task_id, this](
                          DataNameAndContentOrReturnCode get_response) {
-                        LOG(kVerbose) << "GetHandler Get HandleResponseContents for "
-                                      << HexSubstr(data_name.value);
+                        NFS_LOG(kVerbose) << "GetHandler Get HandleResponseContents for "
+                                          << HexSubstr(data_name.value);
                         op_data->HandleResponseContents(std::move(get_response));
-                        {
-                          std::lock_guard<std::mutex> lock(mutex_);
-                          auto iter(std::find_if(std::begin(get_info_), std::end(get_info_),
-                                                 [task_id](const std::pair<routing::TaskId,
-                                                                           GetInfo>& info) {
-                                                   return std::get<1>(info.second) == task_id;
-                                                 }));
-                          if (iter != std::end(get_info_))
-                            get_info_.erase(iter);
-                        }
+                        Finish(task_id);
                      }, 1, task_id);
-  dispatcher_.SendGetRequest(task_id, data_name);
+  if (ready_queue) {
+    ready_queue->Run([this, task_id, data_name] {
+      dispatcher_.SendGetRequest(task_id, data_name);
+    });
+  } else {
+    dispatcher_.SendGetRequest(task_id, data_name);
+  }
 }
 
 template <typename DispatcherType>
 void GetHandler<DispatcherType>::AddResponse(routing::TaskId task_id,
                                               const DataNameAndContentOrReturnCode& response) {
-  LOG(kVerbose) << " GetHandler::AddResponse "  << task_id;
+  NFS_LOG(kVerbose) << " GetHandler::AddResponse "  << task_id;
+  const auto get_info(Find(task_id));
+  if (!get_info)
+    return;
+
   Operation operation(Operation::kNoOperation);
   routing::TaskId new_task_id(0);
-  GetInfo get_info;
-
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto found(get_info_.find(task_id));
-    if (found == std::end(get_info_))
+    std::lock_guard<std::mutex> lock(get_info->mutex);
+    if (get_info->finished || get_info->current_task_id != task_id)
       return;
 
-    if (std::get<1>(get_info_[task_id]) == 0)
-      return;
-
-    get_info = get_info_[task_id];
-    std::get<0>(get_info_[task_id])++;
-    if (response.content && ValidateData(*response.content, std::get<2>(get_info_[task_id]))) {
+    ++get_info->response_count;
+    if (response.content) {
+      if (get_info->validated)
+        return;
       operation = Operation::kAddResponse;
     } else if (response.return_code &&
                response.return_code->value.code() != make_error_code(CommonErrors::defaulted) &&
-               (std::get<0>(get_info_[task_id]) == routing::Parameters::group_size - 1)) {
+               (get_info->response_count == routing::Parameters::group_size - 1)) {
       new_task_id = get_timer_.NewTaskId();
-      get_info_.insert(std::make_pair(new_task_id,
-                                      std::make_tuple(0, std::get<1>(get_info_[task_id]),
-                                                      std::get<2>(get_info_[task_id]))));
-      get_info_.erase(task_id);
+      get_info->current_task_id = new_task_id;
+      get_info->response_count = 0;
+      Insert(new_task_id, get_info);
+      if (task_id != get_info->kOriginalTaskId)
+        Erase(task_id);
       operation = Operation::kSendRequest;
     } else if (response.return_code &&
                response.return_code->value.code() == make_error_code(CommonErrors::defaulted) &&
@@ -179,18 +234,87 @@ void GetHandler<DispatcherType>::AddResponse(routing::TaskId task_id,
     }
   }
 
-  LOG(kVerbose) << " GetHandler::AddResponse "  << task_id
-                << " original task id: " << std::get<1>(get_info_[task_id])
-                << " operation " << static_cast<int>(operation);
+  // Validation parses the content and hashes it, so is done unlocked, letting responses to the
+  // same get be validated concurrently.  The first valid one completes the get, even if it was
+  // retried meanwhile.
+  if (operation == Operation::kAddResponse) {
+    if (!ValidateData(*response.content, get_info->kDataName)) {
+      LOG(kWarning) << "GetHandler::AddResponse " << task_id << " content failed validation";
+      return;
+    }
+    std::lock_guard<std::mutex> lock(get_info->mutex);
+    if (get_info->finished || get_info->validated)
+      return;
+    get_info->validated = true;
+  }
+
+  NFS_LOG(kVerbose) << " GetHandler::AddResponse "  << task_id
+                    << " original task id: " << get_info->kOriginalTaskId
+                    << " operation " << static_cast<int>(operation);
 
   if (operation == Operation::kAddResponse) {
-    get_timer_.AddResponse(std::get<1>(get_info), response);
+    get_timer_.AddResponse(get_info->kOriginalTaskId, response);
   } else if (operation == Operation::kSendRequest) {
     GetHandlerVisitor<DispatcherType> get_handler_visitor(dispatcher_, new_task_id);
-    boost::apply_visitor(get_handler_visitor, std::get<2>(get_info_[new_task_id]));
+    boost::apply_visitor(get_handler_visitor, get_info->kDataName);
   } else if (operation == Operation::kCancelTask) {
-    get_timer_.CancelTask(std::get<1>(get_info));
+    get_timer_.CancelTask(get_info->kOriginalTaskId);
+  }
+}
+
+template <typename DispatcherType>
+bool GetHandler<DispatcherType>::IsAwaiting(routing::TaskId task_id) {
+  const auto get_info(Find(task_id));
+  if (!get_info)
+    return false;
+  std::lock_guard<std::mutex> lock(get_info->mutex);
+  return !get_info->finished && get_info->current_task_id == task_id;
+}
+
+template <typename DispatcherType>
+void GetHandler<DispatcherType>::Insert(routing::TaskId task_id,
+                                        std::shared_ptr<GetInfo> get_info) {
+  auto& shard(GetShard(task_id));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.get_info[task_id] = std::move(get_info);
+}
+
+template <typename DispatcherType>
+std::shared_ptr<typename GetHandler<DispatcherType>::GetInfo> GetHandler<DispatcherType>::Find(
+    routing::TaskId task_id) {
+  auto& shard(GetShard(task_id));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  const auto found(shard.get_info.find(task_id));
+  return found == std::end(shard.get_info) ? nullptr : found->second;
+}
+
+template <typename DispatcherType>
+std::shared_ptr<typename GetHandler<DispatcherType>::GetInfo> GetHandler<DispatcherType>::Erase(
+    routing::TaskId task_id) {
+  std::shared_ptr<GetInfo> get_info;
+  auto& shard(GetShard(task_id));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  const auto found(shard.get_info.find(task_id));
+  if (found != std::end(shard.get_info)) {
+    get_info = std::move(found->second);
+    shard.get_info.erase(found);
+  }
+  return get_info;
+}
+
+template <typename DispatcherType>
+void GetHandler<DispatcherType>::Finish(routing::TaskId original_task_id) {
+  const auto get_info(Erase(original_task_id));
+  if (!get_info)
+    return;
+  routing::TaskId current_task_id(0);
+  {
+    std::lock_guard<std::mutex> lock(get_info->mutex);
+    get_info->finished = true;
+    current_task_id = get_info->current_task_id;
   }
+  if (current_task_id != original_task_id)
+    Erase(current_task_id);
 }
 
 template <typename DispatcherType>
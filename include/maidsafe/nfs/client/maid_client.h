@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 
+#include "boost/filesystem/path.hpp"
 #include "boost/signals2/signal.hpp"
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -44,12 +45,15 @@
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/timer.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/message_wrapper.h"
+#include "maidsafe/nfs/public_key_cache.h"
 #include "maidsafe/nfs/service.h"
 #include "maidsafe/nfs/utils.h"
 #include "maidsafe/nfs/client/client_utils.h"
 #include "maidsafe/nfs/client/maid_node_dispatcher.h"
 #include "maidsafe/nfs/client/maid_node_service.h"
+#include "maidsafe/nfs/client/ready_queue.h"
 #include "maidsafe/nfs/client/data_getter.h"
 
 namespace maidsafe {
@@ -64,10 +68,32 @@ class MaidClient : public std::enable_shared_from_this<MaidClient>  {
   typedef boost::future<void> PutVersionFuture;
   typedef boost::signals2::signal<void(int32_t)> OnNetworkHealthChange;
 
+  static const size_t kMaxPutManyBatchBytes;
+  static const int kDefaultReadyHealth = 100;
+
+  // If 'public_key_cache_path' is given, the peers' public keys saved there by a previous client
+  // for the same maid are loaded, saving fetching them again while joining, and the keys are saved
+  // back there on Stop().
+
   // Logging in for already existing maid accounts
-  static std::shared_ptr<MaidClient> MakeShared(const passport::Maid& maid);
+  static std::shared_ptr<MaidClient> MakeShared(
+      const passport::Maid& maid,
+      const boost::filesystem::path& public_key_cache_path = boost::filesystem::path());
   // Creates maid account and logs in. Throws on failure to create account.
-  static std::shared_ptr<MaidClient> MakeShared(const passport::MaidAndSigner& maid_and_signer);
+  static std::shared_ptr<MaidClient> MakeShared(
+      const passport::MaidAndSigner& maid_and_signer,
+      const boost::filesystem::path& public_key_cache_path = boost::filesystem::path());
+  // As above, but return without waiting for the network.  Requests made before the network
+  // health first reaches 'ready_health' are queued, and sent in order once it does; a request's
+  // timeout includes the time it spends queued.  The account creation request is queued ahead of
+  // any others, and its outcome is given by 'account_created'.
+  static std::shared_ptr<MaidClient> MakeSharedAsync(
+      const passport::Maid& maid, int ready_health = kDefaultReadyHealth,
+      const boost::filesystem::path& public_key_cache_path = boost::filesystem::path());
+  static std::shared_ptr<MaidClient> MakeSharedAsync(
+      const passport::MaidAndSigner& maid_and_signer, boost::future<void>& account_created,
+      int ready_health = kDefaultReadyHealth,
+      const boost::filesystem::path& public_key_cache_path = boost::filesystem::path());
   // Disconnects from network and all unfinished tasks will be cancelled
   void Stop();
 
@@ -83,6 +109,13 @@ class MaidClient : public std::enable_shared_from_this<MaidClient>  {
   boost::future<void> Put(const Data& data, const std::chrono::steady_clock::duration& timeout =
                                                 std::chrono::seconds(360));
 
+  // Puts 'data' in batches, each carrying at most kMaxPutManyBatchBytes of content (a larger
+  // chunk is sent alone) in a single request.  The returned futures are in the order of 'data'.
+  template <typename Data>
+  std::vector<boost::future<void>> PutMany(const std::vector<Data>& data,
+                                           const std::chrono::steady_clock::duration& timeout =
+                                               std::chrono::seconds(360));
+
   template <typename DataName>
   void Delete(const DataName& data_name);
 
@@ -137,7 +170,8 @@ class MaidClient : public std::enable_shared_from_this<MaidClient>  {
   typedef std::function<void(const StructuredDataNameAndContentOrReturnCode&)> GetBranchFunctor;
   typedef boost::promise<std::vector<StructuredDataVersions::VersionName>> VersionNamesPromise;
 
-  explicit MaidClient(const passport::Maid& maid);
+  MaidClient(const passport::Maid& maid, int ready_health,
+             const boost::filesystem::path& public_key_cache_path);
 
   MaidClient(const MaidClient&);
   MaidClient(MaidClient&&);
@@ -153,16 +187,23 @@ class MaidClient : public std::enable_shared_from_this<MaidClient>  {
 
   void Init();
 
+  void InitAsync();
+
   void InitZeroState(const passport::MaidAndSigner& maid_and_signer,
                      const std::vector<passport::PublicPmid>& public_pmids);
 
   void CreateAccount(const passport::PublicMaid& public_maid,
                      const passport::PublicAnmaid& public_anmaid);
   void InitRouting(std::vector<passport::PublicPmid> = std::vector<passport::PublicPmid>());
+  void JoinRouting(std::vector<passport::PublicPmid> public_pmids);
 
   routing::Functors InitialiseRoutingCallbacks();
   void OnNetworkStatusChange(int updated_network_health);
 
+  void SendPutManyBatch(std::vector<nfs_vault::DataNameAndContent> batch,
+                        std::vector<std::shared_ptr<boost::promise<void>>> promises,
+                        const std::chrono::steady_clock::duration& timeout);
+
   template <typename T>
   void OnMessageReceived(const T& routing_message);
 
@@ -171,15 +212,18 @@ class MaidClient : public std::enable_shared_from_this<MaidClient>  {
                      const Receiver& receiver);
 
   const passport::Maid kMaid_;
+  const int kReadyHealth_;
+  const boost::filesystem::path kPublicKeyCachePath_;
   BoostAsioService asio_service_;
   MaidNodeService::RpcTimers rpc_timers_;
   std::mutex network_health_mutex_;
   std::condition_variable network_health_condition_variable_;
   int network_health_;
+  ReadyQueue ready_queue_;
   OnNetworkHealthChange network_health_change_signal_;
+  nfs::detail::PublicKeyCache public_key_cache_;
   std::unique_ptr<routing::Routing> routing_;
   DataGetter data_getter_;
-  nfs::detail::PublicPmidHelper public_pmid_helper_;
   MaidNodeDispatcher dispatcher_;
   nfs::Service<MaidNodeService> service_;
 };
@@ -193,14 +237,16 @@ template <typename DataName>
 boost::future<typename DataName::data_type> MaidClient::Get(
     const DataName& data_name,
     const std::chrono::steady_clock::duration& timeout) {
-  return data_getter_.Get(data_name, timeout);
+  auto promise(std::make_shared<boost::promise<typename DataName::data_type>>());
+  auto future(promise->get_future());
+  data_getter_.Get(data_name, promise, timeout, &ready_queue_);
+  return future;
 }
 
 template <typename Data>
 boost::future<void> MaidClient::Put(const Data& data,
                                      const std::chrono::steady_clock::duration& timeout) {
-  LOG(kVerbose) << "MaidClient put " << HexSubstr(data.name().value.string())
-                << " of size " << data.Serialise().data.string().size();
+  NFS_LOG(kVerbose) << "MaidClient put " << HexSubstr(data.name().value.string());
   typedef MaidNodeService::PutResponse::Contents ResponseContents;
   auto promise(std::make_shared<boost::promise<void>>());
   NodeId node_id;
@@ -214,19 +260,52 @@ boost::future<void> MaidClient::Put(const Data& data,
   rpc_timers_.put_timer.AddTask(
       timeout,
       [op_data, data](ResponseContents put_response) {
-        LOG(kVerbose) << "MaidClient Put HandleResponseContents for "
-                      << HexSubstr(data.name().value);
+        NFS_LOG(kVerbose) << "MaidClient Put HandleResponseContents for "
+                          << HexSubstr(data.name().value);
         op_data->HandleResponseContents(std::move(put_response));
       },
       routing::Parameters::group_size - 1, task_id);
-  rpc_timers_.put_timer.PrintTaskIds();
-  dispatcher_.SendPutRequest(task_id, data);
+  if (NFS_LOG_ENABLED(kVerbose))
+    rpc_timers_.put_timer.PrintTaskIds();
+  // The data is only copied if the request has to be held.
+  if (ready_queue_.released())
+    dispatcher_.SendPutRequest(task_id, data);
+  else
+    ready_queue_.Run([=] { dispatcher_.SendPutRequest(task_id, data); });
   return promise->get_future();
 }
 
+template <typename Data>
+std::vector<boost::future<void>> MaidClient::PutMany(
+    const std::vector<Data>& data, const std::chrono::steady_clock::duration& timeout) {
+  NFS_LOG(kVerbose) << "MaidClient PutMany of " << data.size() << " chunks";
+  std::vector<boost::future<void>> futures;
+  futures.reserve(data.size());
+  std::vector<nfs_vault::DataNameAndContent> batch;
+  std::vector<std::shared_ptr<boost::promise<void>>> promises;
+  size_t batch_bytes(0);
+  for (const auto& item : data) {
+    nfs_vault::DataNameAndContent contents(item);
+    const size_t item_bytes(contents.content.string().size());
+    if (!batch.empty() && batch_bytes + item_bytes > kMaxPutManyBatchBytes) {
+      SendPutManyBatch(std::move(batch), std::move(promises), timeout);
+      batch.clear();
+      promises.clear();
+      batch_bytes = 0;
+    }
+    promises.push_back(std::make_shared<boost::promise<void>>());
+    futures.push_back(promises.back()->get_future());
+    batch.push_back(std::move(contents));
+    batch_bytes += item_bytes;
+  }
+  if (!batch.empty())
+    SendPutManyBatch(std::move(batch), std::move(promises), timeout);
+  return futures;
+}
+
 template <typename DataName>
 void MaidClient::Delete(const DataName& data_name) {
-  dispatcher_.SendDeleteRequest(data_name);
+  ready_queue_.Run([=] { dispatcher_.SendDeleteRequest(data_name); });
 }
 
 template <typename DataName>
@@ -242,7 +321,7 @@ boost::future<void> MaidClient::CreateVersionTree(const DataName& data_name,
                        const StructuredDataVersions::VersionName& version_name,
                        uint32_t max_versions, uint32_t max_branches,
                        const std::chrono::steady_clock::duration& timeout) {
-  LOG(kVerbose) << "MaidClient Create Version " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "MaidClient Create Version " << HexSubstr(data_name.value);
   typedef MaidNodeService::CreateVersionTreeResponse::Contents ResponseContents;
   auto promise(std::make_shared<boost::promise<void>>());
   auto response_functor([promise](const nfs_client::ReturnCode& result) {
@@ -253,21 +332,24 @@ boost::future<void> MaidClient::CreateVersionTree(const DataName& data_name,
   rpc_timers_.create_version_tree_timer.AddTask(
       timeout,
       [op_data, data_name](ResponseContents get_response) {
-        LOG(kVerbose) << "MaidClient CreateVersionTree HandleResponseContents for "
-                      << HexSubstr(data_name.value);
+        NFS_LOG(kVerbose) << "MaidClient CreateVersionTree HandleResponseContents for "
+                          << HexSubstr(data_name.value);
         op_data->HandleResponseContents(std::move(get_response));
       },
       routing::Parameters::group_size * 3, task_id);
-  rpc_timers_.create_version_tree_timer.PrintTaskIds();
-  dispatcher_.SendCreateVersionTreeRequest(task_id, data_name, version_name, max_versions,
-                                           max_branches);
+  if (NFS_LOG_ENABLED(kVerbose))
+    rpc_timers_.create_version_tree_timer.PrintTaskIds();
+  ready_queue_.Run([=] {
+    dispatcher_.SendCreateVersionTreeRequest(task_id, data_name, version_name, max_versions,
+                                             max_branches);
+  });
   return promise->get_future();
 }
 
 template <typename DataName>
 MaidClient::VersionNamesFuture MaidClient::GetVersions(
     const DataName& data_name, const std::chrono::steady_clock::duration& timeout) {
-  LOG(kVerbose) << "MaidClient Get Version for " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "MaidClient Get Version for " << HexSubstr(data_name.value);
   typedef MaidNodeService::GetVersionsResponse::Contents ResponseContents;
   auto promise(std::make_shared<VersionNamesPromise>());
   auto response_functor([promise](const StructuredDataNameAndContentOrReturnCode&
@@ -280,7 +362,7 @@ MaidClient::VersionNamesFuture MaidClient::GetVersions(
                },
       // TODO(Fraser#5#): 2013-08-18 - Confirm expected count
       routing::Parameters::group_size * 2, task_id);
-  dispatcher_.SendGetVersionsRequest(task_id, data_name);
+  ready_queue_.Run([=] { dispatcher_.SendGetVersionsRequest(task_id, data_name); });
   return promise->get_future();
 }
 
@@ -288,7 +370,7 @@ template <typename DataName>
 MaidClient::VersionNamesFuture MaidClient::GetBranch(
     const DataName& data_name, const StructuredDataVersions::VersionName& branch_tip,
     const std::chrono::steady_clock::duration& timeout) {
-  LOG(kVerbose) << "MaidClient Get Branch for " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "MaidClient Get Branch for " << HexSubstr(data_name.value);
   typedef MaidNodeService::GetBranchResponse::Contents ResponseContents;
   auto promise(std::make_shared<VersionNamesPromise>());
   auto response_functor([promise](const StructuredDataNameAndContentOrReturnCode &
@@ -301,7 +383,7 @@ MaidClient::VersionNamesFuture MaidClient::GetBranch(
       },
       // TODO(Fraser#5#): 2013-08-18 - Confirm expected count
       routing::Parameters::group_size * 2, task_id);
-  dispatcher_.SendGetBranchRequest(task_id, data_name, branch_tip);
+  ready_queue_.Run([=] { dispatcher_.SendGetBranchRequest(task_id, data_name, branch_tip); });
   return promise->get_future();
 }
 
@@ -310,9 +392,9 @@ MaidClient::PutVersionFuture MaidClient::PutVersion(
     const DataName& data_name, const StructuredDataVersions::VersionName& old_version_name,
     const StructuredDataVersions::VersionName& new_version_name,
     const std::chrono::steady_clock::duration& timeout) {
-  LOG(kVerbose) << "MaidClient::PutVersion put new version "
-                << DebugId(new_version_name.id) << " after old version "
-                << DebugId(old_version_name.id) << " for " << HexSubstr(data_name.value);
+  NFS_LOG(kVerbose) << "MaidClient::PutVersion put new version "
+                    << DebugId(new_version_name.id) << " after old version "
+                    << DebugId(old_version_name.id) << " for " << HexSubstr(data_name.value);
   typedef MaidNodeService::PutVersionResponse::Contents ResponseContents;
   auto promise(
       std::make_shared<boost::promise<void>>());
@@ -324,34 +406,38 @@ MaidClient::PutVersionFuture MaidClient::PutVersion(
   rpc_timers_.put_version_timer.AddTask(
       timeout,
       [op_data, data_name, new_version_name, old_version_name](ResponseContents get_response) {
-        LOG(kVerbose) << "MaidClient PutVersion HandleResponseContents put new version "
-                      << DebugId(new_version_name.id) << " after old version "
-                      << DebugId(old_version_name.id) << " for " << HexSubstr(data_name.value);
+        NFS_LOG(kVerbose) << "MaidClient PutVersion HandleResponseContents put new version "
+                          << DebugId(new_version_name.id) << " after old version "
+                          << DebugId(old_version_name.id) << " for " << HexSubstr(data_name.value);
         op_data->HandleResponseContents(std::move(get_response));
       },
       routing::Parameters::group_size * 3, task_id);
-  rpc_timers_.put_version_timer.PrintTaskIds();
-  dispatcher_.SendPutVersionRequest(task_id, data_name, old_version_name, new_version_name);
+  if (NFS_LOG_ENABLED(kVerbose))
+    rpc_timers_.put_version_timer.PrintTaskIds();
+  ready_queue_.Run([=] {
+    dispatcher_.SendPutVersionRequest(task_id, data_name, old_version_name, new_version_name);
+  });
   return promise->get_future();
 }
 
 template <typename DataName>
 void MaidClient::DeleteBranchUntilFork(const DataName& data_name,
                                         const StructuredDataVersions::VersionName& branch_tip) {
-  dispatcher_.SendDeleteBranchUntilForkRequest(data_name, branch_tip);
+  ready_queue_.Run([=] { dispatcher_.SendDeleteBranchUntilForkRequest(data_name, branch_tip); });
 }
 
 template <typename T>
 void MaidClient::OnMessageReceived(const T& routing_message) {
-  auto wrapper_tuple(nfs::ParseMessageWrapper(routing_message.contents));
-  const auto& destination_persona(std::get<2>(wrapper_tuple));
-  if (destination_persona.data == nfs::Persona::kDataGetter)
+  // Only the header is decoded here; the contents are copied once, into the posted task.
+  const auto view(nfs::ParseMessageWrapperView(routing_message.contents));
+  if (view.destination_persona == nfs::Persona::kDataGetter)
     return data_getter_.HandleMessage(routing_message);
 
   std::shared_ptr<MaidClient> this_ptr(shared_from_this());
-  asio_service_.service().post([=] {
-    this_ptr->HandleMessage(wrapper_tuple, routing_message.sender, routing_message.receiver);
-  });
+  auto wrapper_tuple(std::make_shared<nfs::TypeErasedMessageWrapper>(view.ToTypeErased()));
+  auto sender(routing_message.sender);
+  auto receiver(routing_message.receiver);
+  asio_service_.service().post([=] { this_ptr->HandleMessage(*wrapper_tuple, sender, receiver); });
 }
 
 template <typename Sender, typename Receiver>
@@ -30,9 +30,11 @@
 #include "maidsafe/routing/routing_api.h"
 #include "maidsafe/routing/timer.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/message_types.h"
 #include "maidsafe/nfs/types.h"
 #include "maidsafe/nfs/client/messages.h"
+#include "maidsafe/nfs/client/send_gate.h"
 #include "maidsafe/nfs/vault/messages.h"
 
 namespace maidsafe {
@@ -51,6 +53,8 @@ class MaidNodeDispatcher {
   template <typename Data>
   void SendPutRequest(routing::TaskId task_id, const Data& data);
 
+  void SendPutManyRequest(routing::TaskId task_id, nfs_vault::DataNamesAndContents batch);
+
   template <typename DataName>
   void SendDeleteRequest(const DataName& data_name);
 
@@ -92,8 +96,7 @@ class MaidNodeDispatcher {
   template <typename RoutingMessage>
   void RoutingSend(const RoutingMessage& routing_message);
 
-  bool running_;
-  std::mutex running_mutex_;
+  SendGate send_gate_;
   routing::Routing& routing_;
   const routing::SingleSource kThisNodeAsSender_;
   const routing::GroupId kMaidManagerReceiver_;
@@ -103,14 +106,14 @@ class MaidNodeDispatcher {
 
 template <typename Data>
 void MaidNodeDispatcher::SendPutRequest(routing::TaskId task_id, const Data& data) {
-  LOG(kVerbose) << "MaidNodeDispatcher::SendPutRequest for chunk "
-                << HexSubstr(data.name().value.string());
   typedef nfs::PutRequestFromMaidNodeToMaidManager NfsMessage;
   CheckSourcePersonaType<NfsMessage>();
   typedef routing::Message<NfsMessage::Sender, NfsMessage::Receiver> RoutingMessage;
-  NfsMessage::Contents contents;
-  contents = nfs_vault::DataNameAndContent(data);
-  NfsMessage nfs_message(nfs::MessageId(task_id), contents);
+  // The data is serialised once here; the wrapper then references it while building the message.
+  NfsMessage nfs_message(nfs::MessageId(task_id), nfs_vault::DataNameAndContent(data));
+  NFS_LOG(kVerbose) << "MaidNodeDispatcher::SendPutRequest for chunk "
+                    << HexSubstr(data.name().value.string()) << " of size "
+                    << nfs_message.contents->content.string().size();
   RoutingSend(RoutingMessage(nfs_message.Serialise(), kThisNodeAsSender_, kMaidManagerReceiver_));
 }
 
@@ -200,8 +203,8 @@ void MaidNodeDispatcher::CheckSourcePersonaType() const {
 
 template <typename RoutingMessage>
 void MaidNodeDispatcher::RoutingSend(const RoutingMessage& routing_message) {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (!running_) {
+  SendGate::Pass pass(send_gate_);
+  if (!pass) {
     LOG(kWarning) << " Shutting down. Send ignored !";
     return;
   }
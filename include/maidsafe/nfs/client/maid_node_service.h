@@ -41,6 +41,7 @@ class MaidNodeService {
 
   typedef nfs::PutResponseFromMaidManagerToMaidNode PutResponse;
   typedef nfs::PutFailureFromMaidManagerToMaidNode PutFailure;
+  typedef nfs::PutManyResponseFromMaidManagerToMaidNode PutManyResponse;
   typedef nfs::GetVersionsResponseFromVersionHandlerToMaidNode GetVersionsResponse;
   typedef nfs::PutVersionResponseFromMaidManagerToMaidNode PutVersionResponse;
   typedef nfs::GetBranchResponseFromVersionHandlerToMaidNode GetBranchResponse;
@@ -52,6 +53,7 @@ class MaidNodeService {
     void CancellAll();
 
     routing::Timer<PutResponse::Contents> put_timer;
+    routing::Timer<PutManyResponse::Contents> put_many_timer;
     routing::Timer<GetVersionsResponse::Contents> get_versions_timer;
     routing::Timer<GetBranchResponse::Contents> get_branch_timer;
     routing::Timer<CreateAccountResponse::Contents> create_account_timer;
@@ -67,6 +69,9 @@ class MaidNodeService {
   void HandleMessage(const PutFailure& message, const PutFailure::Sender& sender,
                      const PutFailure::Receiver& receiver);
 
+  void HandleMessage(const PutManyResponse& message, const PutManyResponse::Sender& sender,
+                     const PutManyResponse::Receiver& receiver);
+
   void HandleMessage(const GetVersionsResponse& message, const GetVersionsResponse::Sender& sender,
                      const GetVersionsResponse::Receiver& receiver);
 
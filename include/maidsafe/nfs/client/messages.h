@@ -108,6 +108,25 @@ struct DataNameAndReturnCode {
 bool operator==(const DataNameAndReturnCode& lhs, const DataNameAndReturnCode& rhs);
 void swap(DataNameAndReturnCode& lhs, DataNameAndReturnCode& rhs) MAIDSAFE_NOEXCEPT;
 
+// ==================== DataNamesAndReturnCodes ====================================================
+// Per-item results of a batched request, in the order the items were sent.
+struct DataNamesAndReturnCodes {
+  DataNamesAndReturnCodes();
+  explicit DataNamesAndReturnCodes(
+      std::vector<DataNameAndReturnCode> data_names_and_return_codes_in);
+  DataNamesAndReturnCodes(const DataNamesAndReturnCodes& other);
+  DataNamesAndReturnCodes(DataNamesAndReturnCodes&& other);
+  DataNamesAndReturnCodes& operator=(DataNamesAndReturnCodes other);
+
+  explicit DataNamesAndReturnCodes(const std::string& serialised_copy);
+  std::string Serialise() const;
+
+  std::vector<DataNameAndReturnCode> data_names_and_return_codes;
+};
+
+bool operator==(const DataNamesAndReturnCodes& lhs, const DataNamesAndReturnCodes& rhs);
+void swap(DataNamesAndReturnCodes& lhs, DataNamesAndReturnCodes& rhs) MAIDSAFE_NOEXCEPT;
+
 // ============================ DataNameAndSizeAndReturnCode ======================================
 struct DataNameAndSizeAndReturnCode {
   template<typename DataNameType>
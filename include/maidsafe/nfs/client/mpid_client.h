@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 
+#include "boost/filesystem/path.hpp"
 #include "boost/signals2/signal.hpp"
 #ifdef _MSC_VER
 #pragma warning(push)
@@ -45,6 +46,7 @@
 #include "maidsafe/routing/timer.h"
 
 #include "maidsafe/nfs/message_wrapper.h"
+#include "maidsafe/nfs/public_key_cache.h"
 #include "maidsafe/nfs/service.h"
 #include "maidsafe/nfs/utils.h"
 #include "maidsafe/nfs/client/client_utils.h"
@@ -60,10 +62,18 @@ class MpidClient : public std::enable_shared_from_this<MpidClient>  {
  public:
   typedef boost::signals2::signal<void(int32_t)> OnNetworkHealthChange;
 
+  // If 'public_key_cache_path' is given, the peers' public keys saved there by a previous client
+  // for the same mpid are loaded, saving fetching them again while joining, and the keys are saved
+  // back there on Stop().
+
   // Logging in for already existing mpid accounts
-  static std::shared_ptr<MpidClient> MakeShared(const passport::Mpid& mpid);
+  static std::shared_ptr<MpidClient> MakeShared(
+      const passport::Mpid& mpid,
+      const boost::filesystem::path& public_key_cache_path = boost::filesystem::path());
   // Creates mpid account and logs in. Throws on failure to create account.
-  static std::shared_ptr<MpidClient> MakeShared(const passport::MpidAndSigner& mpid_and_signer);
+  static std::shared_ptr<MpidClient> MakeShared(
+      const passport::MpidAndSigner& mpid_and_signer,
+      const boost::filesystem::path& public_key_cache_path = boost::filesystem::path());
   // Disconnects from network and all unfinished tasks will be cancelled
 
   MpidClient(const MpidClient&) = delete;
@@ -95,7 +105,7 @@ class MpidClient : public std::enable_shared_from_this<MpidClient>  {
       const std::chrono::steady_clock::duration& timeout = std::chrono::seconds(120));
 
  private:
-  explicit MpidClient(const passport::Mpid& mpid);
+  MpidClient(const passport::Mpid& mpid, const boost::filesystem::path& public_key_cache_path);
 
   void Init(const passport::MpidAndSigner& mpid_and_signer);
   void Init();
@@ -114,14 +124,15 @@ class MpidClient : public std::enable_shared_from_this<MpidClient>  {
   void HandleMessage(const T& routing_message);
 
   const passport::Mpid kMpid_;
+  const boost::filesystem::path kPublicKeyCachePath_;
   BoostAsioService asio_service_;
   MpidNodeService::RpcTimers rpc_timers_;
   std::mutex network_health_mutex_;
   std::condition_variable network_health_condition_variable_;
   int network_health_;
   OnNetworkHealthChange network_health_change_signal_;
+  nfs::detail::PublicKeyCache public_key_cache_;
   std::unique_ptr<routing::Routing> routing_;
-  nfs::detail::PublicPmidHelper public_pmid_helper_;
   MpidNodeDispatcher dispatcher_;
   GetHandler<MpidNodeDispatcher> get_handler_;
   nfs::Service<MpidNodeService> service_;
@@ -33,6 +33,7 @@
 #include "maidsafe/nfs/message_types.h"
 #include "maidsafe/nfs/types.h"
 #include "maidsafe/nfs/client/messages.h"
+#include "maidsafe/nfs/client/send_gate.h"
 #include "maidsafe/nfs/vault/messages.h"
 
 namespace maidsafe {
@@ -70,8 +71,7 @@ class MpidNodeDispatcher {
   template <typename RoutingMessage>
   void RoutingSend(const RoutingMessage& routing_message);
 
-  bool running_;
-  std::mutex running_mutex_;
+  SendGate send_gate_;
   routing::Routing& routing_;
   const routing::SingleSource kThisNodeAsSender_;
   const routing::GroupId kMpidManagerReceiver_;
@@ -102,8 +102,8 @@ void MpidNodeDispatcher::CheckSourcePersonaType() const {
 
 template <typename RoutingMessage>
 void MpidNodeDispatcher::RoutingSend(const RoutingMessage& routing_message) {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  if (!running_) {
+  SendGate::Pass pass(send_gate_);
+  if (!pass) {
     LOG(kWarning) << " Shutting down. Send ignored !";
     return;
   }
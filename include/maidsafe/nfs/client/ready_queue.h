@@ -0,0 +1,75 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_CLIENT_READY_QUEUE_H_
+#define MAIDSAFE_NFS_CLIENT_READY_QUEUE_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace maidsafe {
+
+namespace nfs_client {
+
+// Holds requests made before the client is ready to send them, and runs them in the order they
+// were made once 'Release' is called.  Requests made after that run immediately on the caller's
+// thread.
+class ReadyQueue {
+ public:
+  ReadyQueue();
+
+  template <typename Request>
+  void Run(Request&& request);
+  // Runs the held requests on the calling thread.  Subsequent calls do nothing.
+  void Release();
+  // Discards the held requests without running them.
+  void Clear();
+  bool released() const { return released_.load(std::memory_order_acquire); }
+
+ private:
+  ReadyQueue(const ReadyQueue&);
+  ReadyQueue(ReadyQueue&&);
+  ReadyQueue& operator=(ReadyQueue);
+
+  std::atomic<bool> released_;
+  std::mutex mutex_;
+  bool releasing_;
+  std::vector<std::function<void()>> held_;
+};
+
+// ==================== Implementation =============================================================
+template <typename Request>
+void ReadyQueue::Run(Request&& request) {
+  if (!released()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!released_.load(std::memory_order_relaxed)) {
+      held_.emplace_back(std::forward<Request>(request));
+      return;
+    }
+  }
+  request();
+}
+
+}  // namespace nfs_client
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_CLIENT_READY_QUEUE_H_
@@ -0,0 +1,77 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_CLIENT_SEND_GATE_H_
+#define MAIDSAFE_NFS_CLIENT_SEND_GATE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace maidsafe {
+
+namespace nfs_client {
+
+// Lets any number of senders through concurrently until 'Stop' is called.  'Stop' blocks until
+// every sender already admitted has left, so no send can start or be in progress once it returns.
+class SendGate {
+ public:
+  SendGate();
+
+  // Returns false once the gate is stopped.  On true, the caller must call 'Leave' when done.
+  bool Enter();
+  void Leave();
+  // Must not be called by a thread which is currently inside the gate.
+  void Stop();
+
+  // Enters the gate for the lifetime of the object.
+  class Pass {
+   public:
+    explicit Pass(SendGate& gate) : gate_(gate), admitted_(gate.Enter()) {}
+    ~Pass() {
+      if (admitted_)
+        gate_.Leave();
+    }
+    explicit operator bool() const { return admitted_; }
+
+   private:
+    Pass(const Pass&);
+    Pass(Pass&&);
+    Pass& operator=(Pass);
+
+    SendGate& gate_;
+    const bool admitted_;
+  };
+
+ private:
+  SendGate(const SendGate&);
+  SendGate(SendGate&&);
+  SendGate& operator=(SendGate);
+
+  // The lowest bit is the stopped flag; the remaining bits count the senders inside the gate.
+  std::atomic<uint64_t> state_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+};
+
+}  // namespace nfs_client
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_CLIENT_SEND_GATE_H_
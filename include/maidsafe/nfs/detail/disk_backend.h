@@ -18,7 +18,9 @@
 #ifndef MAIDSAFE_NFS_DETAIL_DISK_BACKEND_H_
 #define MAIDSAFE_NFS_DETAIL_DISK_BACKEND_H_
 
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #ifdef _MSC_VER
@@ -30,11 +32,14 @@
 #pragma warning(pop)
 #endif
 
+#include "boost/filesystem/path.hpp"
+
+#include "maidsafe/common/types.h"
 #include "maidsafe/common/data_types/immutable_data.h"
-#include "maidsafe/nfs/client/fake_store.h"
 #include "maidsafe/nfs/container_version.h"
 #include "maidsafe/nfs/detail/container_id.h"
 #include "maidsafe/nfs/detail/network.h"
+#include "maidsafe/nfs/detail/storage_engine.h"
 
 namespace maidsafe {
 namespace nfs {
@@ -43,11 +48,16 @@ namespace detail {
 // For legacy reasons, the network and disk versions are not using virtual dispatch
 class DiskBackend : public Network::Interface {
  public:
-  template<typename... Args>
-  explicit DiskBackend(Args... args)
-    : Network::Interface(),
-      backend_(std::forward<Args>(args)...) {
-  }
+  DiskBackend(
+      const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+      StorageEngineType engine_type = StorageEngineType::kFilesystem,
+      Durability durability = Durability::kNone,
+      const std::chrono::steady_clock::duration& commit_window = std::chrono::milliseconds(2));
+  DiskBackend(
+      const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+      Durability durability,
+      const std::chrono::steady_clock::duration& commit_window = std::chrono::milliseconds(2));
+  explicit DiskBackend(std::unique_ptr<StorageEngine> engine);
 
   virtual ~DiskBackend();
 
@@ -76,7 +86,7 @@ class DiskBackend : public Network::Interface {
   virtual boost::future<ImmutableData> DoGetChunk(const ImmutableData::Name& name) override final;
 
  private:
-  FakeStore backend_;
+  const std::unique_ptr<StorageEngine> backend_;
 };
 
 }  // namespace detail
@@ -0,0 +1,81 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_DETAIL_FILESYSTEM_ENGINE_H_
+#define MAIDSAFE_NFS_DETAIL_FILESYSTEM_ENGINE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "maidsafe/nfs/client/fake_store.h"
+#include "maidsafe/nfs/detail/storage_engine.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+// Stores each chunk and version tree as its own file, via FakeStore.
+class FilesystemEngine : public StorageEngine {
+ public:
+  FilesystemEngine(
+      const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+      FakeStore::Durability durability = FakeStore::Durability::kNone,
+      const std::chrono::steady_clock::duration& commit_window = std::chrono::milliseconds(2));
+  virtual ~FilesystemEngine();
+
+  // For the features which only the filesystem layout supports (eviction, scrubbing, archiving).
+  FakeStore& store() { return store_; }
+
+  virtual std::uint32_t Capabilities() const override final;
+
+  virtual boost::future<void> PutChunk(const ImmutableData& data) override final;
+  virtual boost::future<ImmutableData> GetChunk(const ImmutableData::Name& name) override final;
+  virtual boost::future<void> DeleteChunk(const ImmutableData::Name& name) override final;
+  virtual void IncrementReferenceCount(
+      const std::vector<ImmutableData::Name>& names) override final;
+  virtual void DecrementReferenceCount(
+      const std::vector<ImmutableData::Name>& names) override final;
+
+  virtual boost::future<void> CreateVersions(
+      const ContainerId& container_id,
+      const ContainerVersion& initial_version,
+      std::uint32_t max_versions,
+      std::uint32_t max_branches) override final;
+  virtual boost::future<void> PutVersion(
+      const ContainerId& container_id,
+      const ContainerVersion& old_version,
+      const ContainerVersion& new_version) override final;
+  virtual boost::future<std::vector<ContainerVersion>> GetVersions(
+      const ContainerId& container_id) override final;
+  virtual boost::future<std::vector<ContainerVersion>> GetBranch(
+      const ContainerId& container_id, const ContainerVersion& tip) override final;
+  virtual boost::future<void> DeleteBranchUntilFork(
+      const ContainerId& container_id, const ContainerVersion& tip) override final;
+
+  virtual DiskUsage GetCurrentDiskUsage() const override final;
+
+ private:
+  FakeStore store_;
+};
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_DETAIL_FILESYSTEM_ENGINE_H_
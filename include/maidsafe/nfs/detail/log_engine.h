@@ -0,0 +1,128 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_DETAIL_LOG_ENGINE_H_
+#define MAIDSAFE_NFS_DETAIL_LOG_ENGINE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "maidsafe/common/data_types/structured_data_versions.h"
+#include "maidsafe/nfs/detail/storage_engine.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+/* Holds everything in a single append-only log file.  Every put, reference
+   count change and version tree update appends a record, and an in-memory
+   index maps each live key to its latest record, so a get is one positioned
+   read.  The index is rebuilt by replaying the log on construction; a torn
+   record at the end of the log is discarded.  Superseded records are
+   reclaimed by rewriting the live ones into a fresh log once more than half
+   of the file is dead. */
+class LogEngine : public StorageEngine {
+ public:
+  LogEngine(const boost::filesystem::path& disk_path, DiskUsage max_disk_usage);
+  virtual ~LogEngine();
+
+  virtual std::uint32_t Capabilities() const override final;
+
+  virtual boost::future<void> PutChunk(const ImmutableData& data) override final;
+  virtual boost::future<ImmutableData> GetChunk(const ImmutableData::Name& name) override final;
+  virtual boost::future<void> DeleteChunk(const ImmutableData::Name& name) override final;
+  virtual void IncrementReferenceCount(
+      const std::vector<ImmutableData::Name>& names) override final;
+  virtual void DecrementReferenceCount(
+      const std::vector<ImmutableData::Name>& names) override final;
+
+  virtual boost::future<void> CreateVersions(
+      const ContainerId& container_id,
+      const ContainerVersion& initial_version,
+      std::uint32_t max_versions,
+      std::uint32_t max_branches) override final;
+  virtual boost::future<void> PutVersion(
+      const ContainerId& container_id,
+      const ContainerVersion& old_version,
+      const ContainerVersion& new_version) override final;
+  virtual boost::future<std::vector<ContainerVersion>> GetVersions(
+      const ContainerId& container_id) override final;
+  virtual boost::future<std::vector<ContainerVersion>> GetBranch(
+      const ContainerId& container_id, const ContainerVersion& tip) override final;
+  virtual boost::future<void> DeleteBranchUntilFork(
+      const ContainerId& container_id, const ContainerVersion& tip) override final;
+
+  virtual DiskUsage GetCurrentDiskUsage() const override final;
+
+  // Rewrites the live records into a new log, regardless of how much of the current one is dead.
+  void Compact();
+  std::uint64_t GetLogSize() const;
+
+ private:
+  LogEngine(const LogEngine&) = delete;
+  LogEngine(LogEngine&&) = delete;
+
+  LogEngine& operator=(const LogEngine&) = delete;
+  LogEngine& operator=(LogEngine&&) = delete;
+
+  enum class RecordType : std::uint8_t { kChunk = 0, kReferenceCount = 1, kVersions = 2 };
+
+  // 'offset' is that of the record's value; a record's header and key precede it.
+  struct Location {
+    Location() : offset(0), size(0), reference_count(0) {}
+    std::uint64_t offset;
+    std::uint32_t size, reference_count;
+  };
+  typedef std::unordered_map<std::string, Location> Index;
+
+  template<typename Result>
+  static boost::future<Result> Complete(const std::function<Result()>& operation);
+
+  // All of the following must be called with 'mutex_' held.
+  void OpenLog();
+  void Replay();
+  std::uint64_t Append(RecordType type, const std::string& key, std::uint32_t reference_count,
+                       const std::string& value);
+  std::string Read(const Location& location) const;
+  std::unique_ptr<StructuredDataVersions> ReadVersions(const std::string& key) const;
+  void WriteVersions(const std::string& key, const StructuredDataVersions& versions);
+  void AddReference(const std::string& key);
+  void ReleaseReference(const std::string& key);
+  void CompactIfWorthwhile();
+  void DoCompact();
+
+  const boost::filesystem::path kLogPath_;
+  const DiskUsage kMaxDiskUsage_;
+  mutable std::mutex mutex_;
+  mutable std::fstream log_;
+  std::uint64_t log_size_, live_bytes_;
+  DiskUsage current_disk_usage_;
+  Index chunks_, versions_;
+};
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_DETAIL_LOG_ENGINE_H_
@@ -0,0 +1,116 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_DETAIL_MEMORY_BACKEND_H_
+#define MAIDSAFE_NFS_DETAIL_MEMORY_BACKEND_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4702)
+#endif
+#include "boost/thread/future.hpp"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include "maidsafe/common/data_types/immutable_data.h"
+#include "maidsafe/common/data_types/structured_data_versions.h"
+#include "maidsafe/nfs/container_version.h"
+#include "maidsafe/nfs/detail/container_id.h"
+#include "maidsafe/nfs/detail/network.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+/* Holds chunks and SDVs in process memory only.  Intended for tests and
+   benchmarks of the layers above Network::Interface, so that they are not
+   measuring filesystem or routing behaviour. Requests complete inline unless
+   an executor is given, and each can be delayed by a fixed latency. */
+class MemoryBackend : public Network::Interface {
+ public:
+  typedef std::function<void(std::function<void()>)> Executor;
+
+  MemoryBackend();
+  explicit MemoryBackend(Executor executor,
+                         std::chrono::steady_clock::duration latency =
+                             std::chrono::steady_clock::duration::zero());
+  virtual ~MemoryBackend();
+
+ private:
+  MemoryBackend(const MemoryBackend&) = delete;
+  MemoryBackend(MemoryBackend&&) = delete;
+
+  MemoryBackend& operator=(const MemoryBackend&) = delete;
+  MemoryBackend& operator=(MemoryBackend&&) = delete;
+
+  virtual boost::future<void> DoCreateSDV(
+      const ContainerId& container_id,
+      const ContainerVersion& initial_version,
+      std::uint32_t max_versions,
+      std::uint32_t max_branches) override final;
+  virtual boost::future<void> DoPutSDVVersion(
+      const ContainerId& container_id,
+      const ContainerVersion& old_version,
+      const ContainerVersion& new_version) override final;
+  virtual boost::future<std::vector<ContainerVersion>> DoGetBranches(
+      const ContainerId& container_id) override final;
+  virtual boost::future<std::vector<ContainerVersion>> DoGetBranchVersions(
+      const ContainerId& container_id, const ContainerVersion& tip) override final;
+
+  virtual boost::future<void> DoPutChunk(const ImmutableData& data) override final;
+  virtual boost::future<ImmutableData> DoGetChunk(const ImmutableData::Name& name) override final;
+
+  template<typename Value>
+  struct Shard {
+    Shard() : mutex(), values() {}
+    std::mutex mutex;
+    std::unordered_map<std::string, Value> values;
+  };
+
+  template<typename Value>
+  using ShardedMap = std::array<Shard<Value>, 16>;
+
+  template<typename Value>
+  static Shard<Value>& GetShard(ShardedMap<Value>& map, const std::string& key);
+
+  template<typename Result>
+  boost::future<Result> Complete(std::function<Result()> operation);
+
+ private:
+  const Executor executor_;
+  const std::chrono::steady_clock::duration latency_;
+  ShardedMap<ImmutableData> chunks_;
+  ShardedMap<std::unique_ptr<StructuredDataVersions>> sdvs_;
+};
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_DETAIL_MEMORY_BACKEND_H_
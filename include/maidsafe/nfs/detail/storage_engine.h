@@ -0,0 +1,116 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_DETAIL_STORAGE_ENGINE_H_
+#define MAIDSAFE_NFS_DETAIL_STORAGE_ENGINE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4702)
+#endif
+#include "boost/thread/future.hpp"
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include "maidsafe/common/types.h"
+#include "maidsafe/common/data_types/immutable_data.h"
+#include "maidsafe/nfs/container_version.h"
+#include "maidsafe/nfs/client/durability.h"
+#include "maidsafe/nfs/detail/container_id.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+/* The primitives DiskBackend needs from local storage.  Chunks are reference
+   counted: a put of an existing chunk or an increment adds a reference, and a
+   delete or a decrement releases one, the chunk going once none remain.
+   Engines report what else they offer through Capabilities(), so that tests
+   and benchmarks can skip what an engine doesn't do. */
+class StorageEngine {
+ public:
+  enum Capability : std::uint32_t {
+    kNone = 0,
+    kPersistent = 1 << 0,           // Contents survive the engine being reopened.
+    kDeferredCollection = 1 << 1,   // Released chunks are removed after a grace period.
+    kEviction = 1 << 2,             // Can run as a bounded cache.
+    kScrubbing = 1 << 3,            // Can verify stored chunks against their names.
+    kArchiving = 1 << 4,            // Can export to and import from an archive file.
+    kSingleFile = 1 << 5            // Holds everything in one file.
+  };
+
+  StorageEngine() {}
+  virtual ~StorageEngine() = 0;
+
+  virtual std::uint32_t Capabilities() const = 0;
+
+  virtual boost::future<void> PutChunk(const ImmutableData& data) = 0;
+  virtual boost::future<ImmutableData> GetChunk(const ImmutableData::Name& name) = 0;
+  virtual boost::future<void> DeleteChunk(const ImmutableData::Name& name) = 0;
+  virtual void IncrementReferenceCount(const std::vector<ImmutableData::Name>& names) = 0;
+  virtual void DecrementReferenceCount(const std::vector<ImmutableData::Name>& names) = 0;
+
+  virtual boost::future<void> CreateVersions(
+      const ContainerId& container_id,
+      const ContainerVersion& initial_version,
+      std::uint32_t max_versions,
+      std::uint32_t max_branches) = 0;
+  virtual boost::future<void> PutVersion(
+      const ContainerId& container_id,
+      const ContainerVersion& old_version,
+      const ContainerVersion& new_version) = 0;
+  virtual boost::future<std::vector<ContainerVersion>> GetVersions(
+      const ContainerId& container_id) = 0;
+  virtual boost::future<std::vector<ContainerVersion>> GetBranch(
+      const ContainerId& container_id, const ContainerVersion& tip) = 0;
+  virtual boost::future<void> DeleteBranchUntilFork(
+      const ContainerId& container_id, const ContainerVersion& tip) = 0;
+
+  virtual DiskUsage GetCurrentDiskUsage() const = 0;
+
+ private:
+  StorageEngine(const StorageEngine&) = delete;
+  StorageEngine(StorageEngine&&) = delete;
+
+  StorageEngine& operator=(const StorageEngine&) = delete;
+  StorageEngine& operator=(StorageEngine&&) = delete;
+};
+
+enum class StorageEngineType : int {
+  kFilesystem = 0,  // FakeStore's file-per-chunk layout.
+  kLog = 1          // A single append-only log file with an in-memory index.
+};
+
+// 'durability' and 'commit_window' are as for FakeStore, and only used by the filesystem engine.
+std::unique_ptr<StorageEngine> MakeStorageEngine(
+    StorageEngineType type, const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+    Durability durability = Durability::kNone,
+    const std::chrono::steady_clock::duration& commit_window = std::chrono::milliseconds(2));
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_DETAIL_STORAGE_ENGINE_H_
@@ -0,0 +1,65 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_LOG_H_
+#define MAIDSAFE_NFS_LOG_H_
+
+#include "maidsafe/common/log.h"
+
+// NFS_LOG(level) is used like LOG(level), but the streamed arguments are only evaluated if 'level'
+// is compiled in.  Levels below MAIDSAFE_NFS_LOG_LEVEL are stripped at compile time, leaving a
+// constant branch the optimiser removes.  By default everything is stripped when logging is
+// disabled, and kVerbose is stripped from release builds.  Define MAIDSAFE_NFS_LOG_LEVEL as one of
+// the NFS_LOG_LEVEL_ values below to override this.
+//
+// The common level macros expand to the call site's file, line and function as well as the level,
+// so can't be compared directly.  Instead the level's name is pasted onto NFS_LOG_LEVEL_ to give
+// its numeric value, and onto NFS_LOG_NAME_ to hand LOG the name itself unexpanded.
+#define NFS_LOG_LEVEL_kVerbose (-1)
+#define NFS_LOG_LEVEL_kInfo 0
+#define NFS_LOG_LEVEL_kSuccess 1
+#define NFS_LOG_LEVEL_kWarning 2
+#define NFS_LOG_LEVEL_kError 3
+#define NFS_LOG_LEVEL_kAlways 4
+
+#define NFS_LOG_NAME_kVerbose kVerbose
+#define NFS_LOG_NAME_kInfo kInfo
+#define NFS_LOG_NAME_kSuccess kSuccess
+#define NFS_LOG_NAME_kWarning kWarning
+#define NFS_LOG_NAME_kError kError
+#define NFS_LOG_NAME_kAlways kAlways
+
+#ifndef MAIDSAFE_NFS_LOG_LEVEL
+#  if !defined(USE_LOGGING)
+#    define MAIDSAFE_NFS_LOG_LEVEL (NFS_LOG_LEVEL_kAlways + 1)
+#  elif defined(NDEBUG)
+#    define MAIDSAFE_NFS_LOG_LEVEL NFS_LOG_LEVEL_kInfo
+#  else
+#    define MAIDSAFE_NFS_LOG_LEVEL NFS_LOG_LEVEL_kVerbose
+#  endif
+#endif
+
+#define NFS_LOG_ENABLED(level) (NFS_LOG_LEVEL_##level >= (MAIDSAFE_NFS_LOG_LEVEL))
+
+// 'level' is only ever pasted, since passing it on to another macro would expand it first.  The
+// empty 'if' branch keeps a following 'else' bound to the caller's own 'if'.
+#define NFS_LOG(level)                                                         \
+  if (!(NFS_LOG_LEVEL_##level >= (MAIDSAFE_NFS_LOG_LEVEL))) {} else /* NOLINT */ \
+    LOG(NFS_LOG_NAME_##level)
+
+#endif  // MAIDSAFE_NFS_LOG_H_
@@ -0,0 +1,146 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_MESSAGE_POOL_H_
+#define MAIDSAFE_NFS_MESSAGE_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "boost/thread/tss.hpp"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace detail {
+
+// The number of blocks every BlockPool has had to take from the heap, for measuring the pools.
+// Only updated when a block isn't available for reuse, so costs nothing while pooling works.
+inline std::atomic<uint64_t>& PoolHeapAllocations() {
+  static std::atomic<uint64_t> count(0);
+  return count;
+}
+
+// Per-thread free lists of blocks of one size.  Freed blocks are kept (up to a limit per thread)
+// for reuse rather than returned to the heap, so steady message traffic stops hitting the allocator
+// without threads contending on the pool.  A block freed by a thread other than the one which
+// allocated it joins the freeing thread's list.
+template <size_t kBlockSize>
+class BlockPool {
+ public:
+  // Deliberately never destroyed, so blocks can still be freed during static destruction.
+  static BlockPool& Instance() {
+    static BlockPool* const pool(new BlockPool);
+    return *pool;
+  }
+
+  void* Allocate() {
+    FreeList* const free_list(free_lists_.get());
+    if (free_list && !free_list->blocks.empty()) {
+      void* const block(free_list->blocks.back());
+      free_list->blocks.pop_back();
+      return block;
+    }
+    PoolHeapAllocations().fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(kBlockSize);
+  }
+
+  void Deallocate(void* block) {
+    FreeList* free_list(free_lists_.get());
+    if (!free_list) {
+      free_list = new FreeList;
+      free_lists_.reset(free_list);
+    }
+    if (free_list->blocks.size() < kMaxFreeBlocks) {
+      free_list->blocks.push_back(block);
+      return;
+    }
+    ::operator delete(block);
+  }
+
+ private:
+  static const size_t kMaxFreeBlocks = 256;
+
+  // Destroyed when its thread exits, returning the thread's cached blocks to the heap.
+  struct FreeList {
+    FreeList() : blocks() { blocks.reserve(kMaxFreeBlocks); }
+    ~FreeList() {
+      for (void* block : blocks)
+        ::operator delete(block);
+    }
+    std::vector<void*> blocks;
+  };
+
+  BlockPool() : free_lists_() {}
+  BlockPool(const BlockPool&);
+  BlockPool(BlockPool&&);
+  BlockPool& operator=(BlockPool);
+
+  boost::thread_specific_ptr<FreeList> free_lists_;
+};
+
+// Allocator drawing single objects from the BlockPool for their size.  Used with
+// std::allocate_shared, this pools the combined control block and object in one go.
+template <typename T>
+class PoolAllocator {
+ public:
+  typedef T value_type;
+  template <typename U>
+  struct rebind {
+    typedef PoolAllocator<U> other;
+  };
+
+  PoolAllocator() {}
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& /*other*/) {}  // NOLINT (implicit by design)
+
+  T* allocate(size_t count) {
+    if (count != 1)
+      return static_cast<T*>(::operator new(count * sizeof(T)));
+    return static_cast<T*>(BlockPool<sizeof(T)>::Instance().Allocate());
+  }
+
+  void deallocate(T* pointer, size_t count) {
+    if (count != 1)
+      return ::operator delete(pointer);
+    BlockPool<sizeof(T)>::Instance().Deallocate(pointer);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>& /*lhs*/, const PoolAllocator<U>& /*rhs*/) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>& /*lhs*/, const PoolAllocator<U>& /*rhs*/) {
+  return false;
+}
+
+}  // namespace detail
+
+}  // namespace nfs
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_MESSAGE_POOL_H_
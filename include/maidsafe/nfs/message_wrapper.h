@@ -22,13 +22,18 @@
 #include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include "boost/exception/error_info.hpp"
+#include "boost/utility/string_ref.hpp"
 
 #include "maidsafe/common/utils.h"
 #include "maidsafe/common/tagged_value.h"
 
+#include "maidsafe/nfs/log.h"
+#include "maidsafe/nfs/message_pool.h"
+#include "maidsafe/nfs/serialised_rope.h"
 #include "maidsafe/nfs/types.h"
 
 namespace maidsafe {
@@ -50,6 +55,7 @@ typedef std::tuple<MessageAction, detail::SourceTaggedValue, detail::Destination
 template <MessageAction action, typename SourcePersonaType, typename RoutingSenderType,
           typename DestinationPersonaType, typename RoutingReceiverType, typename ContentsType>
 struct MessageWrapper {
+  typedef std::integral_constant<MessageAction, action> Action;
   typedef SourcePersonaType SourcePersona;
   typedef RoutingSenderType Sender;
   typedef DestinationPersonaType DestinationPersona;
@@ -62,6 +68,7 @@ struct MessageWrapper {
 
   // For use with new messages (a new message id is automatically applied).
   explicit MessageWrapper(const ContentsType& contents_in);
+  explicit MessageWrapper(ContentsType&& contents_in);
 
   // For use with new messages.
   MessageWrapper(MessageId message_id, ContentsType contents_in);
@@ -109,11 +116,11 @@ bool operator==(
 //   LOG(kVerbose) << "comparing two messages : lhs message id -- " << lhs.id.data
 //                 << " rhs message id -- " << rhs.id.data;
   if (lhs.id != rhs.id) {
-    LOG(kInfo) << "message id mismatch";
+    NFS_LOG(kInfo) << "message id mismatch";
     return false;
   }
   if ((!lhs.contents && rhs.contents) || (lhs.contents && !rhs.contents)) {
-    LOG(kInfo) << "one of the message having empty content";
+    NFS_LOG(kInfo) << "one of the message having empty content";
     return false;
   }
   if (lhs.contents)
@@ -122,6 +129,34 @@ bool operator==(
 }
 TypeErasedMessageWrapper ParseMessageWrapper(const std::string& serialised_message_wrapper);
 
+// Header fields of a serialised MessageWrapper, decoded in place.  'contents' is a slice of the
+// serialised buffer, which must outlive the view.  This allows a message to be routed (or dropped)
+// without copying or parsing its contents.
+struct MessageWrapperView {
+  MessageWrapperView(MessageAction action_in, Persona source_persona_in,
+                     Persona destination_persona_in, MessageId message_id_in,
+                     boost::string_ref contents_in);
+
+  // Copies the contents out of the serialised buffer.
+  TypeErasedMessageWrapper ToTypeErased() const;
+
+  MessageAction action;
+  Persona source_persona, destination_persona;
+  MessageId message_id;
+  boost::string_ref contents;
+};
+
+// Throws CommonErrors::parsing_error in the same cases as ParseMessageWrapper.
+MessageWrapperView ParseMessageWrapperView(const std::string& serialised_message_wrapper);
+
+// Appends 'contents' to 'rope' as the length-delimited field 'field_number'.  Contents types
+// carrying bulk payloads overload this (found by argument-dependent lookup) so that the payload is
+// referenced by the rope rather than serialised into an intermediate string.
+template <typename Contents>
+void AppendSerialised(SerialisedRope& rope, int field_number, const Contents& contents) {
+  rope.AppendBytesField(field_number, contents.Serialise());
+}
+
 // ==================== Implementation =============================================================
 namespace detail {
 
@@ -129,6 +164,20 @@ MessageId GetNewMessageId();
 
 std::string SerialiseMessageWrapper(const TypeErasedMessageWrapper& message_tuple);
 
+// Returns a rope holding all MessageWrapper fields except the contents, which the caller appends
+// as field 'kSerialisedContentsField'.
+SerialisedRope MessageWrapperHeader(MessageAction action, Persona source_persona,
+                                    Persona destination_persona, MessageId message_id);
+
+extern const int kSerialisedContentsField;
+
+// Message contents are allocated from a pool, since every inbound and outbound message needs one.
+template <typename ContentsType, typename... Args>
+std::shared_ptr<ContentsType> MakeContents(Args&&... args) {
+  return std::allocate_shared<ContentsType>(PoolAllocator<ContentsType>(),
+                                            std::forward<Args>(args)...);
+}
+
 }  // namespace detail
 
 template <MessageAction action, typename SourcePersonaType, typename RoutingSenderType,
@@ -154,14 +203,23 @@ template <MessageAction action, typename SourcePersonaType, typename RoutingSend
           typename DestinationPersonaType, typename RoutingReceiverType, typename ContentsType>
 MessageWrapper<action, SourcePersonaType, RoutingSenderType, DestinationPersonaType,
                RoutingReceiverType, ContentsType>::MessageWrapper(const ContentsType& contents_in)
-    : id(detail::GetNewMessageId()), contents(std::make_shared<ContentsType>(contents_in)) {}
+    : id(detail::GetNewMessageId()),
+      contents(detail::MakeContents<ContentsType>(contents_in)) {}
+
+template <MessageAction action, typename SourcePersonaType, typename RoutingSenderType,
+          typename DestinationPersonaType, typename RoutingReceiverType, typename ContentsType>
+MessageWrapper<action, SourcePersonaType, RoutingSenderType, DestinationPersonaType,
+               RoutingReceiverType, ContentsType>::MessageWrapper(ContentsType&& contents_in)
+    : id(detail::GetNewMessageId()),
+      contents(detail::MakeContents<ContentsType>(std::move(contents_in))) {}
 
 template <MessageAction action, typename SourcePersonaType, typename RoutingSenderType,
           typename DestinationPersonaType, typename RoutingReceiverType, typename ContentsType>
 MessageWrapper<action, SourcePersonaType, RoutingSenderType, DestinationPersonaType,
                RoutingReceiverType, ContentsType>::MessageWrapper(MessageId message_id,
                                                                   ContentsType contents_in)
-    : id(std::move(message_id)), contents(std::make_shared<ContentsType>(contents_in)) {}
+    : id(std::move(message_id)),
+      contents(detail::MakeContents<ContentsType>(std::move(contents_in))) {}
 
 template <MessageAction action, typename SourcePersonaType, typename RoutingSenderType,
           typename DestinationPersonaType, typename RoutingReceiverType, typename ContentsType>
@@ -169,7 +227,7 @@ MessageWrapper<action, SourcePersonaType, RoutingSenderType, DestinationPersonaT
                RoutingReceiverType,
                ContentsType>::MessageWrapper(const TypeErasedMessageWrapper& parsed_message_wrapper)
     : id(std::get<3>(parsed_message_wrapper)),
-      contents(std::make_shared<ContentsType>(std::get<4>(parsed_message_wrapper))) {}
+      contents(detail::MakeContents<ContentsType>(std::get<4>(parsed_message_wrapper))) {}
 
 template <MessageAction action, typename SourcePersonaType, typename RoutingSenderType,
           typename DestinationPersonaType, typename RoutingReceiverType, typename ContentsType>
@@ -198,8 +256,10 @@ template <MessageAction action, typename SourcePersonaType, typename RoutingSend
           typename DestinationPersonaType, typename RoutingReceiverType, typename ContentsType>
 std::string MessageWrapper<action, SourcePersonaType, RoutingSenderType, DestinationPersonaType,
                            RoutingReceiverType, ContentsType>::Serialise() const {
-  return detail::SerialiseMessageWrapper(std::make_tuple(
-      action, kSourceTaggedValue, kDestinationTaggedValue, id, contents->Serialise()));
+  auto rope(detail::MessageWrapperHeader(action, kSourceTaggedValue.data,
+                                         kDestinationTaggedValue.data, id));
+  AppendSerialised(rope, detail::kSerialisedContentsField, *contents);
+  return rope.Flatten();
 }
 
 template <MessageAction action, typename SourcePersonaType, typename RoutingSenderType,
@@ -0,0 +1,121 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_PUBLIC_KEY_CACHE_H_
+#define MAIDSAFE_NFS_PUBLIC_KEY_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "boost/filesystem/path.hpp"
+#include "boost/optional/optional.hpp"
+
+#include "maidsafe/common/node_id.h"
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/routing/api_config.h"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace detail {
+
+// Caches nodes' public keys, as given to routing's RequestPublicKeyFunctor.  A key which was found
+// is kept for 'ttl' and a failed lookup is remembered for 'negative_ttl'.  Lookups for a node whose
+// key is already being fetched wait for that fetch rather than starting another.
+//
+// The cached keys can be saved to a file and loaded again on restart.  Loaded keys are given out
+// straight away, but are fetched again in the background the first time each is asked for, so a
+// key which has since changed is only used once.
+class PublicKeyCache {
+ public:
+  // Must call the given functor exactly once, with the key or with none if it couldn't be fetched.
+  typedef std::function<void(const NodeId&, routing::GivePublicKeyFunctor)> FetchFunctor;
+
+  struct Statistics {
+    uint64_t lookups, network_fetches;
+  };
+
+  explicit PublicKeyCache(FetchFunctor fetch,
+                          std::chrono::steady_clock::duration ttl = std::chrono::minutes(10),
+                          std::chrono::steady_clock::duration negative_ttl =
+                              std::chrono::seconds(10));
+
+  // 'give_key' is called on this thread if the key is cached, otherwise on the one completing the
+  // fetch.
+  void GetKey(const NodeId& node_id, routing::GivePublicKeyFunctor give_key);
+  Statistics statistics() const;
+
+  // Writes the unexpired keys to 'path', signed by 'private_key', or removes 'path' if there are
+  // none.  Returns false on failure.
+  bool Save(const boost::filesystem::path& path, const asymm::PrivateKey& private_key);
+  // Adds the unexpired keys saved at 'path' if they are signed by 'public_key', keeping any key
+  // already held.  Returns the number of keys added.
+  size_t Load(const boost::filesystem::path& path, const asymm::PublicKey& public_key);
+
+ private:
+  struct Entry {
+    Entry() : key(), expiry(), fetching(false), loaded(false), waiters() {}
+    boost::optional<asymm::PublicKey> key;
+    std::chrono::steady_clock::time_point expiry;
+    bool fetching, loaded;
+    std::vector<routing::GivePublicKeyFunctor> waiters;
+  };
+
+  struct NodeIdHash {
+    size_t operator()(const NodeId& node_id) const;
+  };
+
+  struct Shard {
+    Shard() : mutex(), entries() {}
+    std::mutex mutex;
+    std::unordered_map<NodeId, Entry, NodeIdHash> entries;
+  };
+
+  PublicKeyCache(const PublicKeyCache&);
+  PublicKeyCache(PublicKeyCache&&);
+  PublicKeyCache& operator=(PublicKeyCache);
+
+  Shard& GetShard(const NodeId& node_id);
+  void Fetch(const NodeId& node_id);
+  void OnFetched(const NodeId& node_id, boost::optional<asymm::PublicKey> key);
+  // Drops expired entries once a shard grows past 'kPruneThreshold', so nodes which have left the
+  // network don't accumulate.
+  void Prune(Shard& shard, std::chrono::steady_clock::time_point now);
+
+  static const size_t kPruneThreshold = 256;
+
+  const FetchFunctor fetch_;
+  const std::chrono::steady_clock::duration kTtl_, kNegativeTtl_;
+  std::array<Shard, 16> shards_;
+  std::atomic<uint64_t> lookups_, network_fetches_;
+};
+
+}  // namespace detail
+
+}  // namespace nfs
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_PUBLIC_KEY_CACHE_H_
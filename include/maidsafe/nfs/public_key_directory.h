@@ -0,0 +1,129 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_PUBLIC_KEY_DIRECTORY_H_
+#define MAIDSAFE_NFS_PUBLIC_KEY_DIRECTORY_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "maidsafe/passport/types.h"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace detail {
+
+// Immutable index of a fixed set of public fobs (e.g. a zero-state network's PublicPmids) by name.
+// Built once, then shared by pointer between lookups, which may be made concurrently.  Where
+// several fobs have the same name, the first is found.
+template <typename PublicFob>
+class PublicKeyDirectory {
+ public:
+  explicit PublicKeyDirectory(std::vector<PublicFob> public_fobs);
+
+  // Returns null if there is no fob named 'name'.
+  const PublicFob* Find(const std::string& name) const;
+  size_t size() const { return public_fobs_.size(); }
+  bool empty() const { return public_fobs_.empty(); }
+
+ private:
+  // Open addressing with linear probing, kept at most half full.
+  struct Slot {
+    Slot() : hash(0), index(kEmpty) {}
+    uint64_t hash;
+    uint32_t index;
+  };
+
+  PublicKeyDirectory(const PublicKeyDirectory&);
+  PublicKeyDirectory(PublicKeyDirectory&&);
+  PublicKeyDirectory& operator=(PublicKeyDirectory);
+
+  static uint64_t Hash(const std::string& name);
+
+  static const uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+
+  const std::vector<PublicFob> public_fobs_;
+  std::vector<std::string> names_;
+  std::vector<Slot> slots_;
+  size_t mask_;
+};
+
+typedef PublicKeyDirectory<passport::PublicPmid> PublicPmidDirectory;
+
+// ==================== Implementation =============================================================
+template <typename PublicFob>
+const uint32_t PublicKeyDirectory<PublicFob>::kEmpty;
+
+template <typename PublicFob>
+PublicKeyDirectory<PublicFob>::PublicKeyDirectory(std::vector<PublicFob> public_fobs)
+    : public_fobs_(std::move(public_fobs)), names_(), slots_(), mask_(0) {
+  size_t slot_count(2);
+  while (slot_count < 2 * public_fobs_.size())
+    slot_count *= 2;
+  slots_.resize(slot_count);
+  mask_ = slot_count - 1;
+  names_.reserve(public_fobs_.size());
+  for (const auto& public_fob : public_fobs_) {
+    names_.push_back(public_fob.name().value.string());
+    const uint64_t hash(Hash(names_.back()));
+    size_t position(hash & mask_);
+    while (slots_[position].index != kEmpty &&
+           (slots_[position].hash != hash || names_[slots_[position].index] != names_.back())) {
+      position = (position + 1) & mask_;
+    }
+    if (slots_[position].index == kEmpty) {
+      slots_[position].hash = hash;
+      slots_[position].index = static_cast<uint32_t>(names_.size() - 1);
+    }
+  }
+}
+
+template <typename PublicFob>
+const PublicFob* PublicKeyDirectory<PublicFob>::Find(const std::string& name) const {
+  const uint64_t hash(Hash(name));
+  for (size_t position(hash & mask_); slots_[position].index != kEmpty;
+       position = (position + 1) & mask_) {
+    if (slots_[position].hash == hash && names_[slots_[position].index] == name)
+      return &public_fobs_[slots_[position].index];
+  }
+  return nullptr;
+}
+
+template <typename PublicFob>
+uint64_t PublicKeyDirectory<PublicFob>::Hash(const std::string& name) {
+  // Fob names are hashes, so their leading bytes are already uniformly distributed.
+  uint64_t hash(0);
+  std::memcpy(&hash, name.data(), std::min(sizeof(hash), name.size()));
+  return hash;
+}
+
+}  // namespace detail
+
+}  // namespace nfs
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_PUBLIC_KEY_DIRECTORY_H_
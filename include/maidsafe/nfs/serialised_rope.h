@@ -0,0 +1,74 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#ifndef MAIDSAFE_NFS_SERIALISED_ROPE_H_
+#define MAIDSAFE_NFS_SERIALISED_ROPE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace maidsafe {
+
+namespace nfs {
+
+// Scatter-gather form of a protobuf-encoded message.  Small fragments (field headers, short
+// fields) are owned by the rope, while bulk payloads are only referenced, so a message can be
+// assembled without first serialising its contents into intermediate strings.  'AppendTo' then
+// copies every byte exactly once into a buffer sized up front.
+//
+// Referenced payloads must outlive the rope.
+class SerialisedRope {
+ public:
+  SerialisedRope();
+  SerialisedRope(SerialisedRope&& other);
+
+  void AppendVarintField(int field_number, uint64_t value);
+  // Negative values are sign-extended, as protobuf does for int32 fields.
+  void AppendInt32Field(int field_number, int32_t value);
+  void AppendBytesField(int field_number, std::string value);
+  // As above, but 'value' is referenced rather than copied.
+  void AppendBytesFieldReference(int field_number, const std::string& value);
+  // Appends 'rope' as an embedded message field, taking over its fragments.
+  void AppendEmbeddedField(int field_number, SerialisedRope rope);
+
+  size_t size() const { return size_; }
+  void AppendTo(std::string& output) const;
+  std::string Flatten() const;
+
+ private:
+  SerialisedRope(const SerialisedRope&);
+  SerialisedRope& operator=(SerialisedRope);
+
+  void AppendLengthDelimitedHeader(int field_number, size_t length);
+  void AppendFragment(std::string fragment);
+  void AppendReference(const std::string& payload);
+
+  // Held by pointer so that pieces referring to them stay valid when fragments change owner.
+  std::vector<std::unique_ptr<std::string>> owned_;
+  std::vector<std::pair<const char*, size_t>> pieces_;
+  size_t size_;
+};
+
+}  // namespace nfs
+
+}  // namespace maidsafe
+
+#endif  // MAIDSAFE_NFS_SERIALISED_ROPE_H_
@@ -19,9 +19,15 @@
 #ifndef MAIDSAFE_NFS_SERVICE_H_
 #define MAIDSAFE_NFS_SERVICE_H_
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "boost/mpl/for_each.hpp"
+#include "boost/mpl/identity.hpp"
 #include "boost/variant/static_visitor.hpp"
 #include "boost/variant/variant.hpp"
 
@@ -35,13 +41,6 @@
 
 namespace maidsafe {
 
-namespace vault {
-
-template <typename T>
-inline bool GetVariant(const maidsafe::nfs::TypeErasedMessageWrapper& message, T& variant);
-
-}  // namespace vault
-
 namespace nfs {
 
 namespace detail {
@@ -79,6 +78,94 @@ class PersonaDemuxer : public boost::static_visitor<
   const Receiver& receiver_;
 };
 
+// Maps a message's (action, source persona, destination persona) directly to a function which
+// constructs that message type from the type-erased wrapper and passes it to the persona service.
+// One table is built per service and sender/receiver combination, from those types listed in the
+// service's PublicMessages and VaultMessages variants whose routing sender and receiver match the
+// table's.  Where two of those share a key, the one listed first wins, as with GetVariant.
+template <typename PersonaService, typename Sender, typename Receiver>
+class DispatchTable {
+ public:
+  typedef typename PersonaService::HandleMessageReturnType ReturnType;
+  typedef ReturnType (*Handler)(PersonaService&, const TypeErasedMessageWrapper&, const Sender&,
+                                const Receiver&);
+
+  static const DispatchTable& Instance() {
+    static const DispatchTable table;
+    return table;
+  }
+
+  // Returns nullptr if no message type of the service matches.
+  Handler Find(MessageAction action, Persona source_persona,
+               Persona destination_persona) const {
+    const auto key(Key(action, source_persona, destination_persona));
+    const auto found(std::lower_bound(std::begin(entries_), std::end(entries_), key,
+                                      [](const Entry& entry, uint64_t value) {
+                                        return entry.first < value;
+                                      }));
+    return (found != std::end(entries_) && found->first == key) ? found->second : nullptr;
+  }
+
+ private:
+  typedef std::pair<uint64_t, Handler> Entry;
+  typedef std::vector<Entry> Entries;
+
+  struct Adder {
+    explicit Adder(Entries& entries_in) : entries(entries_in) {}
+    template <typename Message>
+    typename std::enable_if<std::is_same<Sender, typename Message::Sender>::value &&
+                            std::is_same<Receiver, typename Message::Receiver>::value>::type
+    operator()(boost::mpl::identity<Message>) const {
+      entries.emplace_back(Key(Message::Action::value, Message::SourcePersona::value,
+                               Message::DestinationPersona::value),
+                           &DispatchTable::Handle<Message>);
+    }
+    // A type this table's sender or receiver can't be passed with is left out, so that it can't
+    // shadow a type sharing its key.
+    template <typename Message>
+    typename std::enable_if<!std::is_same<Sender, typename Message::Sender>::value ||
+                            !std::is_same<Receiver, typename Message::Receiver>::value>::type
+    operator()(boost::mpl::identity<Message>) const {}
+    Entries& entries;
+  };
+
+  DispatchTable() : entries_() {
+    Add<typename PersonaService::PublicMessages>();
+    Add<typename PersonaService::VaultMessages>();
+    std::stable_sort(std::begin(entries_), std::end(entries_),
+                     [](const Entry& lhs, const Entry& rhs) { return lhs.first < rhs.first; });
+    entries_.erase(std::unique(std::begin(entries_), std::end(entries_),
+                               [](const Entry& lhs, const Entry& rhs) {
+                                 return lhs.first == rhs.first;
+                               }),
+                   std::end(entries_));
+  }
+
+  template <typename Variant>
+  typename std::enable_if<!std::is_void<Variant>::value>::type Add() {
+    boost::mpl::for_each<typename Variant::types, boost::mpl::make_identity<>>(Adder(entries_));
+  }
+
+  template <typename Variant>
+  typename std::enable_if<std::is_void<Variant>::value>::type Add() {}
+
+  static uint64_t Key(MessageAction action, Persona source_persona, Persona destination_persona) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(action)) << 32) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(source_persona)) << 16) |
+           static_cast<uint16_t>(destination_persona);
+  }
+
+  template <typename Message>
+  static ReturnType Handle(PersonaService& persona_service, const TypeErasedMessageWrapper& message,
+                           const Sender& sender, const Receiver& receiver) {
+    const PersonaDemuxer<PersonaService, Sender, Receiver> demuxer(persona_service, sender,
+                                                                   receiver);
+    return demuxer(Message(message));
+  }
+
+  Entries entries_;
+};
+
 }  // namespace detail
 
 template <typename PersonaService>
@@ -97,12 +184,16 @@ class Service {
   ReturnType HandleMessage(
       const nfs::TypeErasedMessageWrapper& message, const Sender& sender,
       const Receiver& receiver) {
-    const detail::PersonaDemuxer<PersonaService, Sender, Receiver> demuxer(*impl_, sender,
-                                                                           receiver);
-    static std::is_void<PublicMessages> public_messages_void_state;
-    static std::is_void<VaultMessages> vault_messages_void_state;
+    const auto handler(detail::DispatchTable<PersonaService, Sender, Receiver>::Instance().Find(
+        std::get<0>(message), std::get<1>(message).data, std::get<2>(message).data));
+    if (!handler) {
+      LOG(kError) << "Invalid request. No " << std::get<0>(message) << " from "
+                  << std::get<1>(message).data << " to " << std::get<2>(message).data
+                  << " is handled here.";
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_argument));
+    }
     try {
-      return HandleMessage(message, demuxer, public_messages_void_state, vault_messages_void_state);
+      return handler(*impl_, message, sender, receiver);
     }
     catch (const maidsafe_error& error) {
       LOG(kError) << "Invalid request. " << boost::diagnostic_information(error);
@@ -141,68 +232,6 @@ class Service {
   }
 
  private:
-  typedef std::true_type IsVoid;
-  typedef std::false_type IsNotVoid;
-
-  template <typename Demuxer>
-  ReturnType HandlePublicMessage(const nfs::TypeErasedMessageWrapper& message,
-                                 const Demuxer& demuxer) {
-//     LOG(kVerbose) << "nfs HandlePublicMessage";
-    PublicMessages public_variant_message;
-    if (!nfs::GetVariant(message, public_variant_message)) {
-//       LOG(kError) << "Not a valid public message";
-      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_argument));
-    }
-    return boost::apply_visitor(demuxer, public_variant_message);
-  }
-  template <typename Demuxer>
-  ReturnType HandleVaultMessage(const nfs::TypeErasedMessageWrapper& message,
-                                const Demuxer& demuxer) {
-//     LOG(kVerbose) << "nfs HandleVaultMessage";
-    VaultMessages vault_variant_message;
-    if (!vault::GetVariant(message, vault_variant_message)) {
-      LOG(kError) << "Not a valid vault message" << vault_variant_message;
-      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_argument));
-    } else {
-      LOG(kVerbose) << "processing: " << vault_variant_message;
-    }
-    return boost::apply_visitor(demuxer, vault_variant_message);
-  }
-
-  // Public messages only are non-void.
-  template <typename Demuxer>
-  ReturnType HandleMessage(const nfs::TypeErasedMessageWrapper& message, const Demuxer& demuxer,
-                           IsNotVoid, IsVoid) {
-    return HandlePublicMessage(message, demuxer);
-  }
-
-  // Vault messages only are non-void.
-  template <typename Demuxer>
-  ReturnType HandleMessage(const nfs::TypeErasedMessageWrapper& message, const Demuxer& demuxer,
-                           IsVoid, IsNotVoid) {
-    return HandleVaultMessage(message, demuxer);
-  }
-
-  // Both types of message are non-void.
-  template <typename Demuxer>
-  ReturnType HandleMessage(const nfs::TypeErasedMessageWrapper& message, const Demuxer& demuxer,
-                           IsNotVoid, IsNotVoid) {
-    try {
-      return HandlePublicMessage(message, demuxer);
-    }
-    catch (const maidsafe_error& error) {
-      if (error.code() != make_error_code((CommonErrors::invalid_argument)))
-        throw;
-    }
-    try {
-      return HandleVaultMessage(message, demuxer);
-    }
-    catch (const maidsafe_error& error) {
-     if (error.code() != make_error_code((CommonErrors::invalid_argument)))
-       throw;
-    }
-  }
-
   std::unique_ptr<PersonaService> impl_;
 };
 
@@ -69,6 +69,8 @@ DEFINE_OSTREAMABLE_ENUM_VALUES(MessageAction, int32_t,
     (GetMessageResponse)
     (SendAlert)
     (DeleteAlert)
+    (PutManyRequest)
+    (PutManyResponse)
     (NoOperation))  // NoOperation is added to avoid re-definition of types error in
                     // vault::message_types.
 // Defines:
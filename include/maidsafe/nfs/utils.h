@@ -19,6 +19,8 @@
 #ifndef MAIDSAFE_NFS_UTILS_H_
 #define MAIDSAFE_NFS_UTILS_H_
 
+#include <array>
+#include <cassert>
 #include <functional>
 #include <map>
 #include <memory>
@@ -33,6 +35,8 @@
 #include "maidsafe/routing/parameters.h"
 #include "maidsafe/routing/api_config.h"
 
+#include "maidsafe/nfs/log.h"
+#include "maidsafe/nfs/public_key_directory.h"
 #include "maidsafe/nfs/public_pmid_helper.h"
 #include "maidsafe/nfs/public_mpid_helper.h"
 
@@ -41,6 +45,25 @@ namespace maidsafe {
 namespace nfs {
 
 namespace detail {
+
+template <typename T>
+void DoGetPublicKey(T& persona, const NodeId& node_id,
+                    routing::GivePublicKeyFunctor give_key,
+                    const PublicPmidDirectory& public_pmids_from_file,
+                    detail::PublicPmidHelper& public_pmid_helper) {
+  const passport::PublicPmid* public_pmid(public_pmids_from_file.Find(node_id.string()));
+  if (public_pmid) {
+    NFS_LOG(kVerbose) << "got public_pmid of " << DebugId(node_id) << " from local";
+    give_key(public_pmid->public_key());
+    return;
+  }
+  auto future_key(persona.Get(passport::PublicPmid::Name(Identity(node_id.string())),
+                              std::chrono::seconds(10)));
+  public_pmid_helper.AddEntry(std::move(future_key), give_key);
+}
+
+// As above, but searches 'public_pmids_from_file' linearly.  Prefer building a
+// PublicPmidDirectory once where the list is searched repeatedly.
 template <typename T>
 void DoGetPublicKey(T& persona, const NodeId& node_id,
                     routing::GivePublicKeyFunctor give_key,
@@ -54,7 +77,7 @@ void DoGetPublicKey(T& persona, const NodeId& node_id,
         std::begin(public_pmids_from_file), std::end(public_pmids_from_file),
         [&name](const passport::PublicPmid & pmid) { return pmid.name() == name; }));
     if (itr != public_pmids_from_file.end()) {
-      LOG(kVerbose) << "got public_pmid of " << HexSubstr(name.value) << " from local";
+      NFS_LOG(kVerbose) << "got public_pmid of " << HexSubstr(name.value) << " from local";
       give_key((*itr).public_key());
       return;
     }
@@ -80,7 +103,7 @@ bool CheckMutuallyExclusive(const A& a, const B& b) {
 
 template <typename MessageContents>
 bool IsSuccess(const MessageContents& response) {
-  LOG(kVerbose) << "IsSuccess return_code " << response.return_code.value.what();
+  NFS_LOG(kVerbose) << "IsSuccess return_code " << response.return_code.value.what();
   return response.return_code.value.code().value() == static_cast<int>(CommonErrors::success);
 }
 
@@ -99,6 +122,10 @@ std::pair<typename std::vector<MessageContents>::const_iterator, bool>
     GetSuccessOrMostFrequentResponse(const std::vector<MessageContents>& responses,
                                      int successes_required);
 
+// Tallies responses as they arrive, giving the same outcome as GetSuccessOrMostFrequentResponse
+// without keeping them all.  The callback is invoked with the nth success as soon as it arrives,
+// or with the most frequent failure once more than half the group has replied or success can no
+// longer be reached.
 template <typename MessageContents>
 class OpData {
  public:
@@ -110,10 +137,21 @@ class OpData {
   OpData(OpData&&);
   OpData& operator=(OpData);
 
+  // A decision is reached by the time more than half of the group has replied, so there are never
+  // more distinct failures than this to count.
+  static const size_t kMaxFailureKinds = 16;
+  typedef std::pair<std::error_code, int> FailureCount;
+
+  int CountFailure(const std::error_code& error_code);
+
   mutable std::mutex mutex_;
   int successes_required_;
   std::function<void(MessageContents)> callback_;
-  std::vector<MessageContents> responses_;
+  int successes_, responses_;
+  std::array<FailureCount, kMaxFailureKinds> failure_counts_;
+  size_t failure_kinds_;
+  int most_frequent_failure_count_;
+  std::unique_ptr<MessageContents> most_frequent_failure_;
   bool callback_executed_;
 };
 
@@ -122,23 +160,23 @@ template <typename MessageContents>
 std::pair<typename std::vector<MessageContents>::const_iterator, bool>
 GetSuccessOrMostFrequentResponse(const std::vector<MessageContents>& responses,
                                  int successes_required) {
-  LOG(kVerbose) << "GetSuccessOrMostFrequentResponse responses.size() : "
-                << responses.size() << " successes_required : " << successes_required;
+  NFS_LOG(kVerbose) << "GetSuccessOrMostFrequentResponse responses.size() : "
+                    << responses.size() << " successes_required : " << successes_required;
   auto most_frequent_itr(std::end(responses));
   int successes(0), most_frequent(0);
   typedef std::map<std::error_code, int> Count;
   Count count;
   for (auto itr(std::begin(responses)); itr != std::end(responses); ++itr) {
     int this_reply_count(++count[ErrorCode(*itr)]);
-    LOG(kVerbose) << "GetSuccessOrMostFrequentResponse this_reply_count : " << this_reply_count;
+    NFS_LOG(kVerbose) << "GetSuccessOrMostFrequentResponse this_reply_count : " << this_reply_count;
     if (IsSuccess(*itr)) {
-      LOG(kVerbose) << "GetSuccessOrMostFrequentResponse successes : " << successes;
+      NFS_LOG(kVerbose) << "GetSuccessOrMostFrequentResponse successes : " << successes;
       if (++successes >= successes_required) {
-        LOG(kVerbose) << "GetSuccessOrMostFrequentResponse return succeeded";
+        NFS_LOG(kVerbose) << "GetSuccessOrMostFrequentResponse return succeeded";
         return std::make_pair(itr, true);
       }
     } else {
-      LOG(kVerbose) << "GetSuccessOrMostFrequentResponse failed";
+      NFS_LOG(kVerbose) << "GetSuccessOrMostFrequentResponse failed";
       if (this_reply_count > most_frequent) {
         most_frequent = this_reply_count;
         most_frequent_itr = itr;
@@ -154,41 +192,73 @@ OpData<MessageContents>::OpData(int successes_required,
     : mutex_(),
       successes_required_(successes_required),
       callback_(callback),
-      responses_(),
+      successes_(0),
+      responses_(0),
+      failure_counts_(),
+      failure_kinds_(0),
+      most_frequent_failure_count_(0),
+      most_frequent_failure_(),
       callback_executed_(!callback) {
   if (!callback || successes_required <= 0) {
     LOG(kError) << "invalid parameters for OpData constructor";
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_argument));
   }
+  assert(routing::Parameters::group_size / 2U + 1U <= kMaxFailureKinds);
+}
+
+template <typename MessageContents>
+int OpData<MessageContents>::CountFailure(const std::error_code& error_code) {
+  for (size_t i(0); i != failure_kinds_; ++i) {
+    if (failure_counts_[i].first == error_code)
+      return ++failure_counts_[i].second;
+  }
+  if (failure_kinds_ == kMaxFailureKinds)
+    return 1;
+  failure_counts_[failure_kinds_++] = std::make_pair(error_code, 1);
+  return 1;
 }
 
 template <typename MessageContents>
 void OpData<MessageContents>::HandleResponseContents(MessageContents&& response_contents) {
-  LOG(kVerbose) << "OpData<MessageContents>::HandleResponseContents";
   std::function<void(MessageContents)> callback;
   std::unique_ptr<MessageContents> result_ptr;
   {
     std::lock_guard<std::mutex> lock(mutex_);
     if (callback_executed_) {
-      LOG(kInfo) << "OpData<MessageContents>::HandleResponseContents already called back";
+      NFS_LOG(kInfo) << "OpData<MessageContents>::HandleResponseContents already called back";
       return;
     }
-    responses_.push_back(std::move(response_contents));
-    auto result(GetSuccessOrMostFrequentResponse(responses_, successes_required_));
-    // TODO(Fraser#5#): 2013-08-18 - Confirm expected count
-    if (result.second || responses_.size() > (routing::Parameters::group_size / 2U)) {
-      // Operation has succeeded or failed overall
-      callback = callback_;
-      callback_executed_ = true;
-      result_ptr = std::unique_ptr<MessageContents>(new MessageContents(*result.first));
+    ++responses_;
+    if (IsSuccess(response_contents)) {
+      if (++successes_ >= successes_required_) {
+        result_ptr.reset(new MessageContents(std::move(response_contents)));
+      }
     } else {
-      LOG(kWarning) << "OpData<MessageContents>::HandleResponseContents"
-                    << " incorrect result or not enough result";
+      const int this_reply_count(CountFailure(ErrorCode(response_contents)));
+      if (this_reply_count > most_frequent_failure_count_) {
+        most_frequent_failure_count_ = this_reply_count;
+        most_frequent_failure_.reset(new MessageContents(std::move(response_contents)));
+      }
+    }
+
+    // TODO(Fraser#5#): 2013-08-18 - Confirm expected count
+    const int group_size(static_cast<int>(routing::Parameters::group_size));
+    if (!result_ptr && most_frequent_failure_ &&
+        (responses_ > group_size / 2 ||
+         successes_ + (group_size - responses_) < successes_required_)) {
+      result_ptr = std::move(most_frequent_failure_);
+    }
+    if (!result_ptr) {
+      NFS_LOG(kVerbose) << "OpData<MessageContents>::HandleResponseContents"
+                        << " incorrect result or not enough result";
       return;
     }
+    // Operation has succeeded or failed overall
+    callback = std::move(callback_);
+    callback_executed_ = true;
   }
-  LOG(kInfo) << "OpData<MessageContents>::HandleResponseContents call back";
-  callback(*result_ptr);
+  NFS_LOG(kInfo) << "OpData<MessageContents>::HandleResponseContents call back";
+  callback(std::move(*result_ptr));
 }
 
 }  // namespace nfs
@@ -21,6 +21,7 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "maidsafe/common/config.h"
@@ -32,6 +33,7 @@
 
 #include "maidsafe/passport/types.h"
 
+#include "maidsafe/nfs/serialised_rope.h"
 #include "maidsafe/nfs/vault/maid_account_creation.h"
 #include "maidsafe/nfs/vault/maid_account_removal.h"
 #include "maidsafe/nfs/vault/mpid_account_creation.h"
@@ -231,7 +233,7 @@ void swap(VersionTreeCreation& lhs, VersionTreeCreation& rhs) MAIDSAFE_NOEXCEPT;
 struct DataNameAndContent {
   template <typename Data>
   explicit DataNameAndContent(const Data& data)
-      : name(data.name()), content(data.Serialise().data) {}
+      : name(data.name()), content(std::move(data.Serialise().data)) {}
 
   DataNameAndContent(DataTagValue type_in, const Identity& name_in, NonEmptyString content_in);
 
@@ -249,6 +251,31 @@ struct DataNameAndContent {
 
 bool operator==(const DataNameAndContent& lhs, const DataNameAndContent& rhs);
 void swap(DataNameAndContent& lhs, DataNameAndContent& rhs) MAIDSAFE_NOEXCEPT;
+// Appends 'contents' to 'rope' with the content referenced rather than copied.
+void AppendSerialised(nfs::SerialisedRope& rope, int field_number,
+                      const DataNameAndContent& contents);
+
+// ========================== DataNamesAndContents =================================================
+
+struct DataNamesAndContents {
+  explicit DataNamesAndContents(std::vector<DataNameAndContent> data_names_and_contents_in);
+
+  DataNamesAndContents();
+  DataNamesAndContents(const DataNamesAndContents& other);
+  DataNamesAndContents(DataNamesAndContents&& other);
+  DataNamesAndContents& operator=(DataNamesAndContents other);
+
+  explicit DataNamesAndContents(const std::string& serialised_copy);
+  std::string Serialise() const;
+
+  std::vector<DataNameAndContent> data_names_and_contents;
+};
+
+bool operator==(const DataNamesAndContents& lhs, const DataNamesAndContents& rhs);
+void swap(DataNamesAndContents& lhs, DataNamesAndContents& rhs) MAIDSAFE_NOEXCEPT;
+// Appends 'contents' to 'rope' with every item's content referenced rather than copied.
+void AppendSerialised(nfs::SerialisedRope& rope, int field_number,
+                      const DataNamesAndContents& contents);
 
 // ========================== Content ==============================================================
 
@@ -0,0 +1,98 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/client/bloom_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "maidsafe/common/error.h"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace {
+
+// Checked here rather than in the constructor body, as the rate is used by the initialiser list.
+uint64_t BitCount(uint64_t capacity, double false_positive_rate) {
+  if (!(false_positive_rate > 0.0 && false_positive_rate < 1.0))
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_argument));
+  return std::max<uint64_t>(
+      64, static_cast<uint64_t>(std::ceil(-static_cast<double>(capacity) *
+                                          std::log(false_positive_rate) /
+                                          (std::log(2.0) * std::log(2.0)))));
+}
+
+}  // unnamed namespace
+
+BloomFilter::BloomFilter(uint64_t capacity, double false_positive_rate)
+    : kCapacity_(std::max<uint64_t>(capacity, 1)),
+      kBitCount_(BitCount(kCapacity_, false_positive_rate)),
+      kHashCount_(std::max<uint32_t>(
+          1, static_cast<uint32_t>(std::round(static_cast<double>(kBitCount_) / kCapacity_ *
+                                              std::log(2.0))))),
+      bits_(new std::atomic<uint64_t>[(kBitCount_ + 63) / 64]),
+      size_(0) {
+  for (uint64_t i(0); i != (kBitCount_ + 63) / 64; ++i)
+    bits_[i] = 0;
+}
+
+bool BloomFilter::Add(const std::string& key) {
+  const auto hashes(Hash(key));
+  bool added(false);
+  for (uint32_t i(0); i != kHashCount_; ++i) {
+    const uint64_t bit((hashes.first + i * hashes.second) % kBitCount_);
+    const uint64_t mask(uint64_t(1) << (bit % 64));
+    if ((bits_[bit / 64].fetch_or(mask, std::memory_order_relaxed) & mask) == 0)
+      added = true;
+  }
+  if (added)
+    ++size_;
+  return added;
+}
+
+bool BloomFilter::MightContain(const std::string& key) const {
+  const auto hashes(Hash(key));
+  for (uint32_t i(0); i != kHashCount_; ++i) {
+    const uint64_t bit((hashes.first + i * hashes.second) % kBitCount_);
+    if ((bits_[bit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (bit % 64))) == 0)
+      return false;
+  }
+  return true;
+}
+
+double BloomFilter::ExpectedFalsePositiveRate() const {
+  return std::pow(1.0 - std::exp(-static_cast<double>(kHashCount_) * size_ / kBitCount_),
+                  kHashCount_);
+}
+
+// An FNV-1a hash and a multiply-xorshift hash, combined as h1 + i * h2 (Kirsch & Mitzenmacher).
+std::pair<uint64_t, uint64_t> BloomFilter::Hash(const std::string& key) const {
+  uint64_t first(14695981039346656037ULL), second(1099511628211ULL ^ key.size());
+  for (const char c : key) {
+    first = (first ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    second = (second + static_cast<unsigned char>(c)) * 0xff51afd7ed558ccdULL;
+    second ^= second >> 33;
+  }
+  return std::make_pair(first, second | 1);
+}
+
+}  // namespace nfs
+
+}  // namespace maidsafe
@@ -18,6 +18,8 @@
 
 #include "maidsafe/nfs/client/client_utils.h"
 
+#include "maidsafe/nfs/log.h"
+
 namespace maidsafe {
 
 namespace nfs_client {
@@ -25,17 +27,17 @@ namespace nfs_client {
 void HandleGetVersionsOrBranchResult(
     const StructuredDataNameAndContentOrReturnCode& result,
     std::shared_ptr<boost::promise<std::vector<StructuredDataVersions::VersionName>>> promise) {
-  LOG(kVerbose) << "nfs_client::HandleGetVersionsOrBranchResult";
+  NFS_LOG(kVerbose) << "nfs_client::HandleGetVersionsOrBranchResult";
   try {
     if (result.structured_data) {
       promise->set_value(result.structured_data->versions);
     } else if (result.data_name_and_return_code) {
-      LOG(kInfo) << "nfs_client::HandleGetVersionsOrBranchResult"
-                 << " error during get version or branch";
+      NFS_LOG(kInfo) << "nfs_client::HandleGetVersionsOrBranchResult"
+                     << " error during get version or branch";
       BOOST_THROW_EXCEPTION(result.data_name_and_return_code->return_code.value);
     } else {
-      LOG(kInfo) << "nfs_client::HandleGetVersionsOrBranchResult"
-                 << " uninitialised during get version or branch";
+      NFS_LOG(kInfo) << "nfs_client::HandleGetVersionsOrBranchResult"
+                     << " uninitialised during get version or branch";
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
     }
   }
@@ -48,10 +50,10 @@ void HandleGetVersionsOrBranchResult(
 
 void HandleCreateAccountResult(const ReturnCode& result,
                                std::shared_ptr<boost::promise<void>> promise) {
-  LOG(kVerbose) << "nfs_client::HandleCreateAccountResult";
+  NFS_LOG(kVerbose) << "nfs_client::HandleCreateAccountResult";
   try {
     if (nfs::IsSuccess(result)) {
-      LOG(kInfo) << "Create Account succeeded";
+      NFS_LOG(kInfo) << "Create Account succeeded";
       promise->set_value();
     } else {
       LOG(kWarning) << "nfs_client::HandleCreateAccountResult error during create account";
@@ -80,6 +82,21 @@ void HandlePutResponseResult(const ReturnCode& result,
   }
 }
 
+boost::optional<asymm::PublicKey> PublicPmidKey(const DataNameAndContentOrReturnCode& result) {
+  if (!result.content || result.name.type != passport::PublicPmid::Tag::kValue)
+    return boost::optional<asymm::PublicKey>();
+  try {
+    return passport::PublicPmid(
+               passport::PublicPmid::Name(result.name.raw_name),
+               passport::PublicPmid::serialised_type(NonEmptyString(result.content->data)))
+        .public_key();
+  }
+  catch (const std::exception& e) {
+    LOG(kError) << "Failed to parse PublicPmid: " << boost::diagnostic_information(e);
+    return boost::optional<asymm::PublicKey>();
+  }
+}
+
 void HandleSendMessageResponseResult(const ReturnCode& result,
                                      std::shared_ptr<boost::promise<void>> promise) {
   try {
@@ -114,11 +131,11 @@ void HandleGetMessageResponseResult(const MpidMessageOrReturnCode& result,
 
 void HandlePmidHealthResult(const AvailableSizeAndReturnCode& result,
                             std::shared_ptr<boost::promise<uint64_t>> promise) {
-  LOG(kVerbose) << "nfs_client::HandlePmidHealthResult";
+  NFS_LOG(kVerbose) << "nfs_client::HandlePmidHealthResult";
   try {
     if (nfs::IsSuccess(result)) {
-      LOG(kInfo) << "Get PmidHealth succeeded, returned available_size : "
-                 << result.available_size.available_size;
+      NFS_LOG(kInfo) << "Get PmidHealth succeeded, returned available_size : "
+                     << result.available_size.available_size;
       promise->set_value(result.available_size.available_size);
     } else {
       LOG(kWarning) << "nfs_client::HandlePmidHealthResult error during getPmidHealth";
@@ -133,10 +150,10 @@ void HandlePmidHealthResult(const AvailableSizeAndReturnCode& result,
 
 void HandleCreateVersionTreeResult(const ReturnCode& result,
                                    std::shared_ptr<boost::promise<void>> promise) {
-  LOG(kVerbose) << "nfs_client::HandleCreateVersionTreeResult";
+  NFS_LOG(kVerbose) << "nfs_client::HandleCreateVersionTreeResult";
   try {
     if (nfs::IsSuccess(result)) {
-      LOG(kInfo) << "Create Version Tree succeeded";
+      NFS_LOG(kInfo) << "Create Version Tree succeeded";
       promise->set_value();
     } else {
       LOG(kWarning) << "nfs_client::HandleCreateVersionTreeResult error during version creation";
@@ -152,10 +169,10 @@ void HandleCreateVersionTreeResult(const ReturnCode& result,
 void HandlePutVersionResult(
     const TipOfTreeAndReturnCode& result,
     std::shared_ptr<boost::promise<void>> promise) {
-  LOG(kVerbose) << "nfs_client::HandlePutVersionResult";
+  NFS_LOG(kVerbose) << "nfs_client::HandlePutVersionResult";
   try {
     if (nfs::IsSuccess(result.return_code)) {
-      LOG(kInfo) << "Put Version succeeded";
+      NFS_LOG(kInfo) << "Put Version succeeded";
       promise->set_value();
     } else {
       LOG(kWarning) << "nfs_client::HandlePutVersionResult error during put version";
@@ -170,10 +187,10 @@ void HandlePutVersionResult(
 
 void HandleRegisterPmidResult(const ReturnCode& result,
                               std::shared_ptr<boost::promise<void>> promise) {
-  LOG(kVerbose) << "nfs_client::HandleRegisterPmidResult";
+  NFS_LOG(kVerbose) << "nfs_client::HandleRegisterPmidResult";
   try {
     if (nfs::IsSuccess(result)) {
-      LOG(kInfo) << "Pmid Registration succeeded";
+      NFS_LOG(kInfo) << "Pmid Registration succeeded";
       promise->set_value();
     } else {
       LOG(kWarning) << "nfs_client::HandleRegisterPmidResult error during pmid registration";
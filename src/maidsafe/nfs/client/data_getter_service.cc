@@ -18,6 +18,8 @@
 
 #include "maidsafe/nfs/client/data_getter_service.h"
 
+#include "maidsafe/nfs/log.h"
+
 namespace maidsafe {
 
 namespace nfs_client {
@@ -34,9 +36,9 @@ DataGetterService::DataGetterService(
 void DataGetterService::HandleMessage(const GetResponse& message,
                                       const GetResponse::Sender& /*sender*/,
                                       const GetResponse::Receiver& receiver) {
-  LOG(kVerbose) << "DataGetterService::HandleMessage GetResponse with message id "
-                << message.id.data << " with DataNameAndContentOrReturnCode "
-                << HexSubstr(message.contents->Serialise());
+  NFS_LOG(kVerbose) << "DataGetterService::HandleMessage GetResponse with message id "
+                    << message.id.data << " with DataNameAndContentOrReturnCode "
+                    << HexSubstr(message.contents->Serialise());
   assert(receiver.data == routing_.kNodeId());
   static_cast<void>(receiver);
   static_cast<void>(routing_);
@@ -54,9 +56,9 @@ void DataGetterService::HandleMessage(const GetResponse& message,
 void DataGetterService::HandleMessage(const GetCachedResponse& message,
                                       const GetCachedResponse::Sender& /*sender*/,
                                       const GetCachedResponse::Receiver& receiver) {
-  LOG(kVerbose) << "DataGetterService::GetCachedResponse GetResponse "
-                << HexSubstr(message.Serialise()) << " with content "
-                << HexSubstr(message.contents->Serialise());
+  NFS_LOG(kVerbose) << "DataGetterService::GetCachedResponse GetResponse "
+                    << HexSubstr(message.Serialise()) << " with content "
+                    << HexSubstr(message.contents->Serialise());
   assert(receiver.data == routing_.kNodeId());
   static_cast<void>(receiver);
   static_cast<void>(routing_);
@@ -18,15 +18,42 @@
 
 #include "maidsafe/nfs/client/fake_store.h"
 
+#ifdef MAIDSAFE_WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef MAIDSAFE_LINUX
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "boost/filesystem/convenience.hpp"
 
+#include "maidsafe/common/crypto.h"
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/make_unique.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/nfs/log.h"
+
 namespace fs = boost::filesystem;
 
 namespace maidsafe {
@@ -35,6 +62,225 @@ namespace nfs {
 
 namespace {
 
+// Journal lines are "<name> <delta>".  Garbage collection writes "<name> -<count> <from>", where
+// 'from' is the chunk's reference count, for each entry of a batch before applying it, then
+// kAppliedMarker once the batch is on disk.
+const char kJournalName[] = "refcount.journal";
+const char kAppliedMarker[] = "applied";
+const char kUsageLedgerName[] = "usage.ledger";
+// Stored files are written here then renamed into place.  Its name is too long for WalkStore to
+// take it for one of the store's own directories.
+const char kTempDirectoryName[] = "tmp";
+
+// Key filters are sized at four times the number of entries they start with, and rebuilt once half
+// full, which keeps the false positive rate close to the target.
+const uint64_t kMinKeyFilterCapacity(1 << 16);
+const double kKeyFilterFalsePositiveRate(0.01);
+
+// Archive layout: magic, records, index, entry table, footer.  A record is kind (1 byte), flags (1
+// byte), name length (2), name, reference count (4), content length (8), content.  An index entry
+// is name length (2), name, record offset (8), and entries are sorted by name.  The entry table
+// holds the offset (8) of each index entry, so the index can be binary searched.  The footer is
+// index offset (8), record count (8), magic.  All integers are little-endian.
+const char kArchiveMagic[] = "MSFSARC1";
+const char kIndexMagic[] = "MSFSIDX1";
+const std::streamoff kMagicSize(8);
+const std::streamoff kFooterSize(16 + kMagicSize);
+const char kChunkRecord('C');
+const char kVersionsRecord('V');
+const char kCompressedFlag(1);
+const size_t kArchiveBufferSize(4 * 1024 * 1024);
+const size_t kArchiveBatchSize(256);
+
+struct ArchiveRecord {
+  ArchiveRecord() : kind(kChunkRecord), flags(0), name(), reference_count(0), content() {}
+  char kind, flags;
+  std::string name;
+  uint32_t reference_count;
+  std::string content;
+};
+
+template <typename Integer>
+void WriteInteger(std::ostream& stream, Integer value) {
+  char bytes[sizeof(Integer)];
+  for (size_t i(0); i != sizeof(Integer); ++i)
+    bytes[i] = static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff);
+  stream.write(bytes, sizeof(Integer));
+}
+
+template <typename Integer>
+Integer ReadInteger(std::istream& stream) {
+  unsigned char bytes[sizeof(Integer)];
+  if (!stream.read(reinterpret_cast<char*>(bytes), sizeof(Integer)))
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  uint64_t value(0);
+  for (size_t i(0); i != sizeof(Integer); ++i)
+    value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  return static_cast<Integer>(value);
+}
+
+std::string ReadString(std::istream& stream, uint64_t size) {
+  std::string result(static_cast<size_t>(size), 0);
+  if (size != 0 && !stream.read(&result[0], static_cast<std::streamsize>(size)))
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  return result;
+}
+
+void WriteRecord(std::ostream& stream, const ArchiveRecord& record) {
+  stream.put(record.kind);
+  stream.put(record.flags);
+  WriteInteger(stream, static_cast<uint16_t>(record.name.size()));
+  stream.write(record.name.data(), record.name.size());
+  WriteInteger(stream, record.reference_count);
+  WriteInteger(stream, static_cast<uint64_t>(record.content.size()));
+  stream.write(record.content.data(), record.content.size());
+}
+
+ArchiveRecord ReadRecord(std::istream& stream) {
+  ArchiveRecord record;
+  record.kind = ReadInteger<char>(stream);
+  record.flags = ReadInteger<char>(stream);
+  record.name = ReadString(stream, ReadInteger<uint16_t>(stream));
+  record.reference_count = ReadInteger<uint32_t>(stream);
+  record.content = ReadString(stream, ReadInteger<uint64_t>(stream));
+  return record;
+}
+
+// Compresses or uncompresses the batch's contents in parallel, on at most Concurrency() threads
+// (including the calling one) which each take the next untransformed record.
+void TransformContents(std::vector<ArchiveRecord>& batch, bool compress) {
+  std::atomic<size_t> next(0);
+  auto transform([&] {
+    for (size_t i(next++); i < batch.size(); i = next++) {
+      auto& record(batch[i]);
+      if (record.content.empty() || (!compress && !(record.flags & kCompressedFlag)))
+        continue;
+      if (compress) {
+        record.content = crypto::Compress(crypto::UncompressedText(record.content), 6).string();
+        record.flags |= kCompressedFlag;
+      } else {
+        record.content = crypto::Uncompress(crypto::CompressedText(record.content)).string();
+        record.flags &= ~kCompressedFlag;
+      }
+    }
+  });
+  const size_t worker_count(std::min(batch.size(), std::max<size_t>(1, Concurrency())));
+  std::vector<std::future<void>> workers;
+  for (size_t i(1); i < worker_count; ++i)
+    workers.push_back(std::async(std::launch::async, transform));
+  transform();
+  for (auto& worker : workers)
+    worker.get();
+}
+
+// Returns the offset of the index, after checking the archive's header and footer.
+std::streamoff CheckArchive(std::istream& archive, uint64_t& record_count) {
+  std::string magic(ReadString(archive, kMagicSize));
+  archive.seekg(-kFooterSize, std::ios::end);
+  const auto index_offset(static_cast<std::streamoff>(ReadInteger<uint64_t>(archive)));
+  record_count = ReadInteger<uint64_t>(archive);
+  if (magic != kArchiveMagic || ReadString(archive, kMagicSize) != kIndexMagic) {
+    LOG(kError) << "Not a FakeStore archive.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+  return index_offset;
+}
+
+// Returns whether the chunk at 'path' matches 'name', and the number of bytes read.  A read failure
+// means the chunk was changed or removed since it was listed, so counts as a match.
+std::pair<bool, uint64_t> CheckChunk(const fs::path& path, const ImmutableData::Name& name) {
+  std::string content;
+  if (!ReadFile(path, &content) || content.empty())
+    return std::make_pair(true, static_cast<uint64_t>(0));
+  bool valid(false);
+  try {
+    valid = ImmutableData(name, ImmutableData::serialised_type(NonEmptyString(content))).name() ==
+            name;
+  }
+  catch (const std::exception&) {}
+  return std::make_pair(valid, static_cast<uint64_t>(content.size()));
+}
+
+// A fixed set of threads which, together with the caller, run each of a succession of batches.  The
+// threads are started once, so short tasks aren't dominated by thread start-up.
+class BatchWorkers {
+ public:
+  explicit BatchWorkers(size_t thread_count)
+      : mutex_(), work_condition_(), done_condition_(), function_(nullptr), count_(0), next_(0),
+        generation_(0), busy_(0), stop_(false), threads_() {
+    for (size_t i(0); i != thread_count; ++i)
+      threads_.emplace_back([this] { Loop(); });
+  }
+
+  ~BatchWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    work_condition_.notify_all();
+    for (auto& thread : threads_)
+      thread.join();
+  }
+
+  // Calls 'function' (which mustn't throw) with each index in [0, count), returning once all calls
+  // have finished.
+  void Run(size_t count, const std::function<void(size_t)>& function) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      function_ = &function;
+      count_ = count;
+      next_ = 0;
+      busy_ = threads_.size();
+      ++generation_;
+    }
+    work_condition_.notify_all();
+    Work(count, function);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_condition_.wait(lock, [this] { return busy_ == 0; });
+  }
+
+ private:
+  BatchWorkers(const BatchWorkers&);
+  BatchWorkers(BatchWorkers&&);
+  BatchWorkers& operator=(BatchWorkers);
+
+  void Loop() {
+    uint64_t generation(0);
+    for (;;) {
+      const std::function<void(size_t)>* function(nullptr);
+      size_t count(0);
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_condition_.wait(lock, [&] { return stop_ || generation_ != generation; });
+        if (stop_)
+          return;
+        generation = generation_;
+        function = function_;
+        count = count_;
+      }
+      Work(count, *function);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_ == 0)
+        done_condition_.notify_one();
+    }
+  }
+
+  void Work(size_t count, const std::function<void(size_t)>& function) {
+    for (size_t i(next_++); i < count; i = next_++)
+      function(i);
+  }
+
+  std::mutex mutex_;
+  std::condition_variable work_condition_, done_condition_;
+  const std::function<void(size_t)>* function_;
+  size_t count_;
+  std::atomic<size_t> next_;
+  uint64_t generation_;
+  size_t busy_;
+  bool stop_;
+  std::vector<std::thread> threads_;
+};
+
 struct UsedSpace {
   UsedSpace() {}
   UsedSpace(UsedSpace&& other)
@@ -66,6 +312,13 @@ DiskUsage InitialiseDiskRoot(const fs::path& disk_root) {
       BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
     }
   }
+  // Anything left here was being written when the store was last shut down uncleanly.
+  fs::remove_all(disk_root / kTempDirectoryName, error_code);
+  if (!fs::create_directories(disk_root / kTempDirectoryName, error_code)) {
+    LOG(kError) << "Can't create " << disk_root / kTempDirectoryName << ": "
+                << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
+  }
   // TODO(Fraser#5#): 2014-01-30 - BEFORE_RELEASE re-enable this functionality using a different
   //                               (much faster) method.
 /*
@@ -103,50 +356,349 @@ DiskUsage InitialiseDiskRoot(const fs::path& disk_root) {
   return disk_usage;
 }
 
+#ifdef MAIDSAFE_WIN32
+bool FlushPath(const fs::path& path, bool /*is_directory*/) {
+  HANDLE handle(CreateFileW(path.wstring().c_str(), GENERIC_WRITE,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr));
+  if (handle == INVALID_HANDLE_VALUE)
+    return false;
+  bool result(FlushFileBuffers(handle) != 0);
+  CloseHandle(handle);
+  return result;
+}
+#else
+bool FlushPath(const fs::path& path, bool is_directory) {
+  int fd(open(path.c_str(), is_directory ? O_RDONLY : O_WRONLY));
+  if (fd == -1)
+    return false;
+#if defined MAIDSAFE_APPLE
+  bool result(fsync(fd) == 0);
+#else
+  bool result(is_directory ? (fsync(fd) == 0) : (fdatasync(fd) == 0));
+#endif
+  close(fd);
+  return result;
+}
+#endif
+
+bool SyncFile(const fs::path& path) { return FlushPath(path, false); }
+
+// Replaces the contents of 'path' atomically: a reader sees either the old or the new contents.
+void ReplaceFile(const fs::path& path, const std::string& content) {
+  const fs::path temp_path(path.string() + ".tmp");
+  boost::system::error_code error_code;
+  if (!WriteFile(temp_path, content) || !SyncFile(temp_path)) {
+    LOG(kError) << "Failed to write " << temp_path;
+    fs::remove(temp_path, error_code);
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  fs::rename(temp_path, path, error_code);
+  if (error_code) {
+    LOG(kError) << "Failed to rename " << temp_path << " to " << path << ": "
+                << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+}
+
+#if defined(MAIDSAFE_LINUX) && defined(FICLONE)
+bool Reflink(const fs::path& source, const fs::path& destination) {
+  const int source_fd(open(source.c_str(), O_RDONLY));
+  if (source_fd < 0)
+    return false;
+  bool cloned(false);
+  const int destination_fd(open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644));
+  if (destination_fd >= 0) {
+    cloned = (ioctl(destination_fd, FICLONE, source_fd) == 0);
+    close(destination_fd);
+    if (!cloned)
+      unlink(destination.c_str());
+  }
+  close(source_fd);
+  return cloned;
+}
+#else
+bool Reflink(const fs::path& /*source*/, const fs::path& /*destination*/) { return false; }
+#endif
+
 }  // unnamed namespace
 
-FakeStore::FakeStore(const fs::path& disk_path, DiskUsage max_disk_usage)
+FakeStore::FakeStore(const fs::path& disk_path, DiskUsage max_disk_usage, Durability durability,
+                     const std::chrono::steady_clock::duration& commit_window)
     : asio_service_(Concurrency() / 2),  // TODO(Fraser#5#): 2013-09-06 - determine best value.
       kDiskPath_(disk_path),
+      kReadOnly_(false),
       max_disk_usage_(std::move(max_disk_usage)),
       current_disk_usage_(InitialiseDiskRoot(kDiskPath_)),
       kDepth_(5),
-      get_identity_visitor_() {
+      get_identity_visitor_(),
+      eviction_enabled_(false),
+      eviction_running_(false),
+      low_watermark_(1.0),
+      high_watermark_(1.0),
+      eviction_overshoot_(0),
+      access_info_(),
+      access_clock_(0),
+      kDurability_(durability),
+      kCommitWindow_(commit_window),
+      pending_commits_(),
+      commit_mutex_(),
+      commit_condition_(),
+      stop_committing_(false),
+      commit_thread_(),
+      stop_scrubbing_(false),
+      scrub_mutex_(),
+      scrub_condition_(),
+      scrub_thread_(),
+      pending_decrements_(),
+      gc_grace_period_(std::chrono::seconds(1)),
+      gc_mutex_(),
+      gc_condition_(),
+      stop_gc_(false),
+      gc_thread_(),
+      filter_mutex_(),
+      key_filter_(),
+      next_key_filter_(),
+      filter_lookups_(0),
+      filter_misses_(0),
+      filter_false_positives_(0),
+      index_(),
+      index_ready_(),
+      type_usage_(),
+      ledger_usage_() {
+  LoadUsageLedger();
   if (current_disk_usage_ > max_disk_usage_)
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::cannot_exceed_limit));
+  ReplayJournal();
+  gc_thread_ = std::thread([this] { GarbageCollectionLoop(); });
+  {
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    ScheduleKeyFilterRebuild(kMinKeyFilterCapacity);
+  }
+  auto index_built(std::make_shared<boost::promise<void>>());
+  index_ready_ = index_built->get_future().share();
+  asio_service_.service().post([this, index_built] {
+    try {
+      BuildIndex();
+      index_built->set_value();
+    }
+    catch (const std::exception& e) {
+      LOG(kError) << "Failed to build store index: " << e.what();
+      index_built->set_exception(boost::current_exception());
+    }
+  });
+  if (kDurability_ == Durability::kGroupCommit)
+    commit_thread_ = std::thread([this] { CommitLoop(); });
+}
+
+FakeStore::FakeStore(const fs::path& disk_path, ReadOnly)
+    : asio_service_(1),
+      kDiskPath_(disk_path),
+      kReadOnly_(true),
+      max_disk_usage_(0),
+      current_disk_usage_(0),
+      kDepth_(5),
+      get_identity_visitor_(),
+      eviction_enabled_(false),
+      eviction_running_(false),
+      low_watermark_(1.0),
+      high_watermark_(1.0),
+      eviction_overshoot_(0),
+      access_info_(),
+      access_clock_(0),
+      kDurability_(Durability::kNone),
+      kCommitWindow_(),
+      pending_commits_(),
+      commit_mutex_(),
+      commit_condition_(),
+      stop_committing_(false),
+      commit_thread_(),
+      stop_scrubbing_(false),
+      scrub_mutex_(),
+      scrub_condition_(),
+      scrub_thread_(),
+      pending_decrements_(),
+      gc_grace_period_(std::chrono::seconds(1)),
+      gc_mutex_(),
+      gc_condition_(),
+      stop_gc_(false),
+      gc_thread_(),
+      filter_mutex_(),
+      key_filter_(),
+      next_key_filter_(),
+      filter_lookups_(0),
+      filter_misses_(0),
+      filter_false_positives_(0),
+      index_(),
+      index_ready_(),
+      type_usage_(),
+      ledger_usage_() {
+  boost::system::error_code error_code;
+  if (!fs::is_directory(kDiskPath_, error_code)) {
+    LOG(kError) << "No store at " << kDiskPath_;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::uninitialised));
+  }
+  // Decrements still pending in the journal are honoured, but the journal is left as it is.
+  ReplayJournal();
+}
+
+FakeStore::~FakeStore() {
+  StopScrubbing();
+  {
+    std::lock_guard<std::mutex> lock(gc_mutex_);
+    stop_gc_ = true;
+  }
+  gc_condition_.notify_one();
+  if (gc_thread_.joinable())
+    gc_thread_.join();
+  asio_service_.Stop();
+  if (!kReadOnly_)
+    SaveUsageLedger(kDiskPath_);
+  {
+    std::lock_guard<std::mutex> lock(commit_mutex_);
+    stop_committing_ = true;
+  }
+  commit_condition_.notify_one();
+  if (commit_thread_.joinable())
+    commit_thread_.join();
 }
 
-FakeStore::~FakeStore() { asio_service_.Stop(); }
+void FakeStore::Commit(std::vector<fs::path> paths,
+                       std::shared_ptr<boost::promise<void>> promise) {
+  if (kDurability_ == Durability::kNone) {
+    if (promise)
+      promise->set_value();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(commit_mutex_);
+    pending_commits_.emplace_back(std::move(paths), std::move(promise));
+  }
+  commit_condition_.notify_one();
+}
+
+void FakeStore::CommitLoop() {
+  for (;;) {
+    std::vector<PendingCommit> batch;
+    {
+      std::unique_lock<std::mutex> lock(commit_mutex_);
+      commit_condition_.wait(lock, [this] {
+        return stop_committing_ || !pending_commits_.empty();
+      });
+      if (pending_commits_.empty())
+        return;
+      // Let the group fill up for the duration of the commit window before flushing it.
+      if (!stop_committing_ && kCommitWindow_ > std::chrono::steady_clock::duration::zero())
+        commit_condition_.wait_for(lock, kCommitWindow_, [this] { return stop_committing_; });
+      batch.swap(pending_commits_);
+    }
+
+    std::vector<fs::path> paths;
+    for (const auto& pending : batch)
+      paths.insert(std::end(paths), std::begin(pending.paths), std::end(pending.paths));
+    try {
+      FlushToDisk(paths);
+      for (auto& pending : batch) {
+        if (pending.promise)
+          pending.promise->set_value();
+      }
+    }
+    catch (const std::exception& e) {
+      LOG(kError) << "Group commit failed: " << boost::diagnostic_information(e);
+      for (auto& pending : batch) {
+        if (pending.promise)
+          pending.promise->set_exception(boost::current_exception());
+      }
+    }
+  }
+}
+
+void FakeStore::FlushToDisk(const std::vector<fs::path>& paths) const {
+  std::set<fs::path> files, directories;
+  for (const auto& path : paths) {
+    if (path.empty())
+      continue;
+    boost::system::error_code error_code;
+    if (fs::is_regular_file(path, error_code))
+      files.insert(path);
+    directories.insert(path.parent_path());
+  }
+  // However many writers in the batch touched them, each file and directory is flushed once.
+  for (const auto& file : files) {
+    if (!FlushPath(file, false)) {
+      LOG(kError) << "Failed to flush " << file;
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+    }
+  }
+#ifndef MAIDSAFE_WIN32
+  for (const auto& directory : directories) {
+    if (!FlushPath(directory, true)) {
+      LOG(kError) << "Failed to flush " << directory;
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+    }
+  }
+#endif
+}
 
 NonEmptyString FakeStore::DoGet(const KeyType& key) const {
+  if (!MayContain(GetFilePath(key).filename().string()))
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
   std::lock_guard<std::mutex> lock(mutex_);
   fs::path file_path(KeyToFilePath(key, false));
-  uint32_t reference_count(GetReferenceCount(file_path));
+  uint32_t reference_count(0);
+  try {
+    reference_count = GetReferenceCount(file_path);
+  }
+  catch (const std::exception&) {
+    RecordFalsePositive();
+    throw;
+  }
+  if (reference_count == 0)
+    RecordFalsePositive();
+  if (reference_count != 0 &&
+      boost::apply_visitor(GetTagValueVisitor(), key) == DataTagValue::kImmutableDataValue) {
+    // Chunks whose references have all been released are gone, even if not yet collected.
+    if (PendingDecrements(file_path) >= reference_count)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+    RecordAccess(file_path);
+  }
   file_path.replace_extension("." + std::to_string(reference_count));
   return ReadFile(file_path);
 }
 
-void FakeStore::DoPut(const KeyType& key, const NonEmptyString& value) {
+fs::path FakeStore::DoPut(const KeyType& key, const NonEmptyString& value) {
   std::lock_guard<std::mutex> lock(mutex_);
   if (!fs::exists(kDiskPath_))
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
 
   fs::path file_path(KeyToFilePath(key, true));
+  const fs::path base_path(file_path);
   uint32_t value_size(static_cast<uint32_t>(value.string().size()));
   uintmax_t file_size(0);
   uint32_t reference_count(GetReferenceCount(file_path));
   DataTagValue data_tag_value(boost::apply_visitor(GetTagValueVisitor(), key));
 
   if (reference_count == 0) {
+    auto stale(pending_decrements_.find(base_path));
+    if (stale != std::end(pending_decrements_)) {
+      AppendToJournal(stale->second.file_name + " -" + std::to_string(stale->second.count) +
+                      "\n");
+      pending_decrements_.erase(stale);
+    }
     file_path.replace_extension(".1");
     Write(file_path, value, value_size);
     current_disk_usage_.data += value_size;
+  } else if (data_tag_value == DataTagValue::kImmutableDataValue &&
+             CancelPendingDecrement(base_path)) {
+    // A re-put within the grace period just revokes the earlier decrement.
+    AppendToJournal(GetFilePath(key).filename().string() + " -1\n");
+    file_path = kDiskPath_ / kJournalName;
   } else if (data_tag_value == DataTagValue::kImmutableDataValue) {
-    fs::path old_path(file_path), new_path(file_path);
+    fs::path old_path(file_path);
     old_path.replace_extension("." + std::to_string(reference_count));
     ++reference_count;
-    new_path.replace_extension("." + std::to_string(reference_count));
-    file_size = Rename(old_path, new_path);
+    file_path.replace_extension("." + std::to_string(reference_count));
+    file_size = Rename(old_path, file_path);
     assert(file_size == value_size);
   } else {
     assert(reference_count == 1);
@@ -156,9 +708,15 @@ void FakeStore::DoPut(const KeyType& key, const NonEmptyString& value) {
     Write(file_path, value, value_size);
     current_disk_usage_.data += value_size;
   }
+
+  if (data_tag_value == DataTagValue::kImmutableDataValue)
+    RecordAccess(base_path);
+  ScheduleEviction();
+  AddToKeyFilter(GetFilePath(key).filename().string());
+  return file_path;
 }
 
-void FakeStore::DoDelete(const KeyType& key) {
+fs::path FakeStore::DoDelete(const KeyType& key) {
   std::lock_guard<std::mutex> lock(mutex_);
   fs::path file_path(KeyToFilePath(key, false));
   uintmax_t file_size(0);
@@ -167,10 +725,11 @@ void FakeStore::DoDelete(const KeyType& key) {
   if (reference_count == 0) {
     LOG(kWarning) << HexSubstr(boost::apply_visitor(GetTagValueAndIdentityVisitor(), key).second)
                   << " already deleted.";
-    return;
+    return fs::path();
   }
 
   if (reference_count == 1) {
+    access_info_.erase(file_path);
     file_path.replace_extension(".1");
     file_size = Remove(file_path);
     current_disk_usage_.data -= file_size;
@@ -181,13 +740,15 @@ void FakeStore::DoDelete(const KeyType& key) {
     new_path.replace_extension("." + std::to_string(reference_count));
     file_size = Rename(file_path, new_path);
     assert(file_size != 0);
+    return new_path;
   }
+  return file_path;
 }
 
 void FakeStore::IncrementReferenceCount(const std::vector<ImmutableData::Name>& data_names) {
   asio_service_.service().post([this, data_names] {
     try {
-      DoIncrement(data_names);
+      Commit(DoIncrement(data_names), nullptr);
     }
     catch (const std::exception& e) {
       LOG(kWarning) << "IncrementReferenceCount failed: " << boost::diagnostic_information(e);
@@ -196,23 +757,29 @@ void FakeStore::IncrementReferenceCount(const std::vector<ImmutableData::Name>&
 }
 
 void FakeStore::DecrementReferenceCount(const std::vector<ImmutableData::Name>& data_names) {
-  asio_service_.service().post([this, data_names] {
-    try {
-      DoDecrement(data_names);
-    }
-    catch (const std::exception& e) {
-      LOG(kWarning) << "DecrementReferenceCount failed: " << boost::diagnostic_information(e);
-    }
-  });
+  try {
+    Commit(DoDecrement(data_names), nullptr);
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "DecrementReferenceCount failed: " << boost::diagnostic_information(e);
+  }
 }
 
-void FakeStore::DoIncrement(const std::vector<ImmutableData::Name>& data_names) {
+std::vector<fs::path> FakeStore::DoIncrement(
+    const std::vector<ImmutableData::Name>& data_names) {
+  std::vector<fs::path> changed_paths;
   std::lock_guard<std::mutex> lock(mutex_);
   if (!fs::exists(kDiskPath_))
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
 
+  std::string journal_entries;
   for (const auto& data_name : data_names) {
     fs::path file_path(KeyToFilePath(data_name, false));
+    // An outstanding decrement can simply be cancelled rather than touching the chunk.
+    if (CancelPendingDecrement(file_path)) {
+      journal_entries += GetFilePath(data_name).filename().string() + " -1\n";
+      continue;
+    }
     uint32_t reference_count(GetReferenceCount(file_path));
     assert(reference_count != 0);
 
@@ -223,12 +790,247 @@ void FakeStore::DoIncrement(const std::vector<ImmutableData::Name>& data_names)
     auto file_size(Rename(old_path, new_path));
     assert(file_size != 0);
     static_cast<void>(file_size);
+    changed_paths.push_back(new_path);
+  }
+  if (!journal_entries.empty()) {
+    AppendToJournal(journal_entries);
+    changed_paths.push_back(kDiskPath_ / kJournalName);
+  }
+  return changed_paths;
+}
+
+std::vector<fs::path> FakeStore::DoDecrement(const std::vector<ImmutableData::Name>& data_names) {
+  const auto now(std::chrono::steady_clock::now());
+  std::string journal_entries;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& data_name : data_names) {
+    auto& pending(pending_decrements_[KeyToFilePath(data_name, false)]);
+    pending.file_name = GetFilePath(data_name).filename().string();
+    ++pending.count;
+    pending.recorded = now;
+    journal_entries += pending.file_name + " 1\n";
+  }
+  AppendToJournal(journal_entries);
+  return std::vector<fs::path>(1, kDiskPath_ / kJournalName);
+}
+
+void FakeStore::SetGarbageCollectionGracePeriod(
+    const std::chrono::steady_clock::duration& grace_period) {
+  {
+    std::lock_guard<std::mutex> lock(gc_mutex_);
+    gc_grace_period_ = grace_period;
   }
+  gc_condition_.notify_one();
 }
 
-void FakeStore::DoDecrement(const std::vector<ImmutableData::Name>& data_names) {
-  for (const auto& data_name : data_names)
-    DoDelete(data_name);
+uint32_t FakeStore::PendingDecrements(const fs::path& base_path) const {
+  auto found(pending_decrements_.find(base_path));
+  return found == std::end(pending_decrements_) ? 0 : found->second.count;
+}
+
+bool FakeStore::CancelPendingDecrement(const fs::path& base_path) {
+  auto found(pending_decrements_.find(base_path));
+  if (found == std::end(pending_decrements_))
+    return false;
+  if (--found->second.count == 0)
+    pending_decrements_.erase(found);
+  return true;
+}
+
+void FakeStore::AppendToJournal(const std::string& entries) {
+  std::ofstream journal((kDiskPath_ / kJournalName).string(),
+                        std::ios::out | std::ios::app | std::ios::binary);
+  journal << entries;
+  if (!journal) {
+    LOG(kError) << "Failed to append to reference count journal.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+}
+
+void FakeStore::CompactJournal() {
+  std::string journal_entries;
+  for (const auto& pending : pending_decrements_)
+    journal_entries += pending.second.file_name + " " + std::to_string(pending.second.count) + "\n";
+  boost::system::error_code error_code;
+  if (journal_entries.empty())
+    fs::remove(kDiskPath_ / kJournalName, error_code);
+  else
+    ReplaceFile(kDiskPath_ / kJournalName, journal_entries);
+}
+
+void FakeStore::ReplayJournal() {
+  std::ifstream journal((kDiskPath_ / kJournalName).string(), std::ios::in | std::ios::binary);
+  if (!journal)
+    return;
+  struct Intent {
+    std::string file_name;
+    int64_t count;
+    uint32_t reference_count;
+  };
+  std::map<std::string, int64_t> totals;
+  std::vector<Intent> unapplied;
+  std::string line;
+  while (std::getline(journal, line)) {
+    // A final line without a newline is a torn append which was never acknowledged.
+    if (journal.eof())
+      break;
+    if (line == kAppliedMarker) {
+      unapplied.clear();
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string file_name;
+    int64_t delta(0);
+    uint32_t reference_count(0);
+    if (!(fields >> file_name >> delta))
+      continue;
+    totals[file_name] += delta;
+    if (fields >> reference_count)
+      unapplied.push_back(Intent{file_name, -delta, reference_count});
+  }
+  journal.close();
+
+  // The last garbage collection batch was interrupted.  Entries whose chunk still has the reference
+  // count recorded before the batch were not applied, so remain pending.
+  for (const auto& intent : unapplied) {
+    try {
+      const fs::path base_path(
+          KeyToFilePath(detail::GetDataNameVariant(fs::path(intent.file_name)), false));
+      if (GetReferenceCount(base_path) == intent.reference_count)
+        totals[intent.file_name] += intent.count;
+    }
+    catch (const std::exception&) {}
+  }
+
+  const auto now(std::chrono::steady_clock::now());
+  for (const auto& total : totals) {
+    if (total.second <= 0)
+      continue;
+    try {
+      auto& pending(pending_decrements_[KeyToFilePath(
+          detail::GetDataNameVariant(fs::path(total.first)), false)]);
+      pending.file_name = total.first;
+      pending.count = static_cast<uint32_t>(total.second);
+      pending.recorded = now;
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Skipping journal entry " << total.first << ": "
+                    << boost::diagnostic_information(e);
+    }
+  }
+  if (!kReadOnly_)
+    CompactJournal();
+  NFS_LOG(kInfo) << "Replayed " << pending_decrements_.size() << " pending decrements.";
+}
+
+void FakeStore::GarbageCollectionLoop() {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(gc_mutex_);
+      gc_condition_.wait_for(
+          lock, std::max<std::chrono::steady_clock::duration>(gc_grace_period_ / 2,
+                                                              std::chrono::milliseconds(10)),
+          [this] { return stop_gc_; });
+      if (stop_gc_)
+        return;
+    }
+    try {
+      CollectGarbage();
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Garbage collection failed: " << boost::diagnostic_information(e);
+    }
+  }
+}
+
+void FakeStore::CollectGarbage() {
+  std::chrono::steady_clock::time_point cutoff;
+  {
+    std::lock_guard<std::mutex> lock(gc_mutex_);
+    cutoff = std::chrono::steady_clock::now() - gc_grace_period_;
+  }
+
+  std::vector<fs::path> due;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& pending : pending_decrements_) {
+      if (pending.second.recorded <= cutoff)
+        due.push_back(pending.first);
+    }
+  }
+  if (due.empty())
+    return;
+
+  // 'due' is in path order, so each batch works through neighbouring directories.  The store lock
+  // is only held for one batch at a time.
+  const size_t kBatchSize(256);
+  std::vector<fs::path> changed_paths;
+  for (size_t begin(0); begin < due.size(); begin += kBatchSize) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t end(std::min(due.size(), begin + kBatchSize));
+    std::vector<std::pair<fs::path, uint32_t>> batch;
+    std::string intents;
+    for (size_t i(begin); i != end; ++i) {
+      auto found(pending_decrements_.find(due[i]));
+      // Skip entries cancelled by a re-put, or refreshed by a later decrement.
+      if (found == std::end(pending_decrements_) || found->second.recorded > cutoff)
+        continue;
+      uint32_t reference_count(0);
+      try {
+        reference_count = GetReferenceCount(due[i]);
+      }
+      catch (const std::exception&) {}
+      if (reference_count == 0) {
+        pending_decrements_.erase(found);
+        continue;
+      }
+      batch.push_back(std::make_pair(due[i], reference_count));
+      intents += found->second.file_name + " -" + std::to_string(found->second.count) + " " +
+                 std::to_string(reference_count) + "\n";
+    }
+    if (batch.empty())
+      continue;
+
+    // The intents must be on disk before any chunk changes, so that replay after a crash can tell
+    // which of them were applied.
+    AppendToJournal(intents);
+    if (!SyncFile(kDiskPath_ / kJournalName))
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+    try {
+      for (const auto& entry : batch) {
+        auto found(pending_decrements_.find(entry.first));
+        const uint32_t decrements(found->second.count);
+        fs::path current_path(entry.first);
+        current_path.replace_extension("." + std::to_string(entry.second));
+        if (entry.second <= decrements) {
+          current_disk_usage_.data -= Remove(current_path);
+          access_info_.erase(entry.first);
+          changed_paths.push_back(current_path);
+        } else {
+          fs::path new_path(entry.first);
+          new_path.replace_extension("." + std::to_string(entry.second - decrements));
+          Rename(current_path, new_path);
+          changed_paths.push_back(new_path);
+        }
+        pending_decrements_.erase(found);
+      }
+      AppendToJournal(std::string(kAppliedMarker) + "\n");
+    }
+    catch (const std::exception&) {
+      // Leave the journal matching what is still outstanding, since a later batch's marker would
+      // otherwise also cover this batch's unapplied intents.
+      CompactJournal();
+      throw;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CompactJournal();
+    changed_paths.push_back(kDiskPath_ / kJournalName);
+  }
+  NFS_LOG(kVerbose) << "Garbage collection applied " << due.size() << " pending decrements.";
+  Commit(std::move(changed_paths), nullptr);
 }
 
 void FakeStore::SetMaxDiskUsage(DiskUsage max_disk_usage) {
@@ -242,11 +1044,638 @@ void FakeStore::SetMaxDiskUsage(DiskUsage max_disk_usage) {
 
 DiskUsage FakeStore::GetMaxDiskUsage() const { return max_disk_usage_; }
 
+void FakeStore::EnableEviction(double low_watermark, double high_watermark) {
+  if (low_watermark < 0.0 || low_watermark > high_watermark || high_watermark > 1.0) {
+    LOG(kError) << "Invalid eviction watermarks " << low_watermark << " / " << high_watermark;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_argument));
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  eviction_enabled_ = true;
+  low_watermark_ = low_watermark;
+  high_watermark_ = high_watermark;
+  ScheduleEviction();
+}
+
+uint64_t FakeStore::GetEvictionOvershoot() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return eviction_overshoot_;
+}
+
+void FakeStore::RecordAccess(const fs::path& base_path) const {
+  if (!eviction_enabled_)
+    return;
+  auto& access_info(access_info_[base_path]);
+  ++access_info.hits;
+  access_info.last_access = ++access_clock_;
+}
+
+void FakeStore::ScheduleEviction() {
+  if (!eviction_enabled_ || eviction_running_ ||
+      current_disk_usage_.data < high_watermark_ * max_disk_usage_.data) {
+    return;
+  }
+  eviction_running_ = true;
+  asio_service_.service().post([this] {
+    try {
+      Evict();
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Eviction failed: " << boost::diagnostic_information(e);
+      std::lock_guard<std::mutex> lock(mutex_);
+      eviction_running_ = false;
+    }
+  });
+}
+
+void FakeStore::Evict() {
+  std::vector<std::pair<fs::path, AccessInfo>> candidates;
+  uint64_t target_usage(0);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    candidates.assign(std::begin(access_info_), std::end(access_info_));
+    target_usage = static_cast<uint64_t>(low_watermark_ * max_disk_usage_.data);
+    // Age the counts so that chunks which were popular long ago don't stay pinned forever.
+    for (auto& entry : access_info_)
+      entry.second.hits = (entry.second.hits + 1) / 2;
+  }
+  std::sort(std::begin(candidates), std::end(candidates),
+            [](const std::pair<fs::path, AccessInfo>& lhs,
+               const std::pair<fs::path, AccessInfo>& rhs) {
+              return std::tie(lhs.second.hits, lhs.second.last_access) <
+                     std::tie(rhs.second.hits, rhs.second.last_access);
+            });
+
+  // The lock is retaken per chunk so that puts and gets can proceed while eviction runs.
+  std::vector<fs::path> removed_paths;
+  for (const auto& candidate : candidates) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_disk_usage_.data <= target_usage)
+      break;
+    uint32_t reference_count(0);
+    try {
+      reference_count = GetReferenceCount(candidate.first);
+    }
+    catch (const std::exception&) {}
+    // Chunks referenced more than once are shared with other owners, so are left alone.
+    if (reference_count != 1) {
+      if (reference_count == 0)
+        access_info_.erase(candidate.first);
+      continue;
+    }
+    fs::path file_path(candidate.first);
+    file_path.replace_extension(".1");
+    current_disk_usage_.data -= Remove(file_path);
+    access_info_.erase(candidate.first);
+    removed_paths.push_back(file_path);
+  }
+  NFS_LOG(kVerbose) << "Evicted " << removed_paths.size() << " chunks.";
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    eviction_running_ = false;
+    // Writes admitted during the pass may have pushed usage back over the high watermark.  If this
+    // pass found nothing to evict, the next write reschedules instead, so as not to spin.
+    if (!removed_paths.empty())
+      ScheduleEviction();
+  }
+  Commit(std::move(removed_paths), nullptr);
+}
+
 DiskUsage FakeStore::GetCurrentDiskUsage() const {
   std::lock_guard<std::mutex> lock(mutex_);
   return current_disk_usage_;
 }
 
+boost::future<uint64_t> FakeStore::Scrub(
+    uint64_t bytes_per_second, std::function<void(const ImmutableData::Name&)> on_corruption) {
+  StopScrubbing();
+  stop_scrubbing_ = false;
+  const auto promise(std::make_shared<boost::promise<uint64_t>>());
+  scrub_thread_ = std::thread([this, bytes_per_second, on_corruption, promise] {
+    try {
+      promise->set_value(DoScrub(bytes_per_second, on_corruption));
+    }
+    catch (const std::exception& e) {
+      LOG(kError) << "Scrub failed: " << boost::diagnostic_information(e);
+      promise->set_exception(boost::current_exception());
+    }
+  });
+  return promise->get_future();
+}
+
+void FakeStore::StopScrubbing() {
+  {
+    std::lock_guard<std::mutex> lock(scrub_mutex_);
+    stop_scrubbing_ = true;
+  }
+  scrub_condition_.notify_all();
+  if (scrub_thread_.joinable())
+    scrub_thread_.join();
+}
+
+uint64_t FakeStore::DoScrub(
+    uint64_t bytes_per_second,
+    const std::function<void(const ImmutableData::Name&)>& on_corruption) {
+  // The checkpoint holds the last file checked and the number of corrupt chunks found so far.  One
+  // which can't be parsed (e.g. left empty by a crash) is ignored, restarting the pass.
+  const fs::path checkpoint_path(kDiskPath_ / "scrub.checkpoint");
+  std::string resume_after;
+  uint64_t corrupt_count(0);
+  std::string checkpoint;
+  if (ReadFile(checkpoint_path, &checkpoint)) {
+    std::istringstream checkpoint_stream(checkpoint);
+    if (checkpoint_stream >> resume_after >> corrupt_count) {
+      NFS_LOG(kInfo) << "Resuming scrub after " << resume_after;
+    } else {
+      LOG(kWarning) << "Ignoring unreadable scrub checkpoint.";
+      resume_after.clear();
+      corrupt_count = 0;
+    }
+  }
+  // Written at most once a second, as each write is flushed, or straight away when a corrupt chunk
+  // has been found.
+  std::string last_checked;
+  auto next_checkpoint(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+  auto save_checkpoint([&] {
+    try {
+      ReplaceFile(checkpoint_path, last_checked + ' ' + std::to_string(corrupt_count));
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Failed to save scrub checkpoint: " << boost::diagnostic_information(e);
+    }
+    next_checkpoint = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+  });
+
+  struct Candidate {
+    fs::path path;
+    std::string file_name;
+    ImmutableData::Name name;
+  };
+  std::vector<Candidate> batch;
+  const size_t batch_size(std::max<size_t>(1, Concurrency()));
+  const auto start_time(std::chrono::steady_clock::now());
+  uint64_t bytes_read(0);
+
+  // Hashes the batch in parallel on the pass's workers, without the store lock.  A chunk being
+  // written meanwhile can look corrupt, so mismatches are checked again by Quarantine.
+  BatchWorkers workers(batch_size - 1);
+  std::vector<std::pair<bool, uint64_t>> results;
+  const std::function<void(size_t)> check_chunk([&](size_t index) {
+    results[index] = CheckChunk(batch[index].path, batch[index].name);
+  });
+  auto process_batch([&]() {
+    results.assign(batch.size(), std::make_pair(true, static_cast<uint64_t>(0)));
+    workers.Run(batch.size(), check_chunk);
+    const uint64_t previous_corrupt_count(corrupt_count);
+    for (size_t i(0); i != batch.size(); ++i) {
+      const auto& result(results[i]);
+      bytes_read += result.second;
+      if (!result.first && Quarantine(batch[i].path, batch[i].file_name, batch[i].name)) {
+        ++corrupt_count;
+        LOG(kError) << "Quarantined corrupt chunk " << HexSubstr(batch[i].name.value);
+        if (on_corruption)
+          on_corruption(batch[i].name);
+      }
+    }
+    last_checked = batch.back().file_name;
+    batch.clear();
+    if (corrupt_count != previous_corrupt_count ||
+        std::chrono::steady_clock::now() >= next_checkpoint) {
+      save_checkpoint();
+    }
+
+    if (bytes_per_second != 0) {
+      const auto budgeted_time(start_time + std::chrono::microseconds(
+                                                bytes_read * 1000000 / bytes_per_second));
+      std::unique_lock<std::mutex> lock(scrub_mutex_);
+      scrub_condition_.wait_until(lock, budgeted_time, [this] { return stop_scrubbing_.load(); });
+    }
+  });
+
+  bool completed(true);
+  WalkStore(resume_after, [&](const fs::path& path, const std::string& file_name) -> bool {
+    if (stop_scrubbing_) {
+      completed = false;
+      return false;
+    }
+    try {
+      auto key(detail::GetDataNameVariant(fs::path(file_name)));
+      if (boost::apply_visitor(GetTagValueVisitor(), key) == DataTagValue::kImmutableDataValue &&
+          path.extension() != ".ver") {
+        batch.push_back(Candidate{path, file_name, boost::get<ImmutableData::Name>(key)});
+      }
+    }
+    catch (const std::exception&) {
+      LOG(kWarning) << "Skipping unrecognised file " << path;
+    }
+    if (batch.size() >= batch_size)
+      process_batch();
+    return true;
+  });
+  if (completed && !batch.empty())
+    process_batch();
+
+  boost::system::error_code error_code;
+  if (!completed && !last_checked.empty()) {
+    save_checkpoint();
+  } else if (completed) {
+    fs::remove(checkpoint_path, error_code);
+    NFS_LOG(kInfo) << "Scrub complete; " << corrupt_count << " corrupt chunks found.";
+  }
+  return corrupt_count;
+}
+
+bool FakeStore::Quarantine(const fs::path& path, const std::string& file_name,
+                           const ImmutableData::Name& name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Writes happen under the lock, so this sees the chunk as last written.
+  if (CheckChunk(path, name).first)
+    return false;
+  boost::system::error_code error_code;
+  const uintmax_t file_size(fs::file_size(path, error_code));
+  if (error_code)
+    return false;
+  const fs::path quarantine_dir(kDiskPath_ / "quarantine");
+  fs::create_directories(quarantine_dir, error_code);
+  fs::path quarantined(quarantine_dir / (file_name + path.extension().string()));
+  fs::rename(path, quarantined, error_code);
+  if (error_code) {
+    LOG(kError) << "Failed to quarantine " << path << ": " << error_code.message();
+    return false;
+  }
+  current_disk_usage_.data -= file_size;
+  fs::path base_path(path);
+  access_info_.erase(base_path.replace_extension());
+  EraseFromIndex(path);
+  return true;
+}
+
+std::unique_ptr<FakeStore> FakeStore::Clone(const fs::path& destination) const {
+  Snapshot(destination);
+  return maidsafe::make_unique<FakeStore>(destination, GetMaxDiskUsage(), kDurability_,
+                                          kCommitWindow_);
+}
+
+FakeStore::SnapshotMethod FakeStore::Snapshot(const fs::path& destination) const {
+  boost::system::error_code error_code;
+  if (fs::exists(destination, error_code) && !fs::is_empty(destination, error_code)) {
+    LOG(kError) << "Snapshot destination " << destination << " isn't empty.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+  fs::create_directories(destination, error_code);
+  if (error_code) {
+    LOG(kError) << "Can't create " << destination << ": " << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+
+  {
+    // Files in the root (the journal and scrub checkpoint) are small and updated in place, so are
+    // copied, along with a ledger of the usage at the same point.  The store opened over the
+    // snapshot takes its disk usage from the ledger until its own index is built.
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (fs::directory_iterator itr(kDiskPath_), end; itr != end; ++itr) {
+      if (fs::is_regular_file(itr->status()))
+        fs::copy_file(itr->path(), destination / itr->path().filename());
+    }
+    SaveUsageLedger(destination);
+  }
+
+  // Stored files are only ever replaced or removed, never modified in place, so they can be
+  // linked without the lock, and hard links are as independent as reflinks or copies.  A file
+  // removed while the walk is under way is skipped.
+  SnapshotMethod method(SnapshotMethod::kReflink);
+  WalkStore("", [&](const fs::path& path, const std::string&) -> bool {
+    fs::path relative_path(path.filename());
+    for (fs::path parent(path.parent_path()); parent != kDiskPath_; parent = parent.parent_path())
+      relative_path = parent.filename() / relative_path;
+    const fs::path target(destination / relative_path);
+    fs::create_directories(target.parent_path());
+    boost::system::error_code link_error;
+    if (method == SnapshotMethod::kReflink && !Reflink(path, target)) {
+      if (!fs::exists(path, link_error))
+        return true;
+      method = SnapshotMethod::kHardLink;
+    }
+    if (method == SnapshotMethod::kHardLink) {
+      fs::create_hard_link(path, target, link_error);
+      if (link_error) {
+        if (!fs::exists(path, link_error))
+          return true;
+        method = SnapshotMethod::kCopy;
+      }
+    }
+    if (method == SnapshotMethod::kCopy) {
+      fs::copy_file(path, target, link_error);
+      boost::system::error_code exists_error;
+      if (link_error && fs::exists(path, exists_error)) {
+        LOG(kError) << "Failed to copy " << path << " to " << target << ": "
+                    << link_error.message();
+        BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+      }
+    }
+    return true;
+  });
+  NFS_LOG(kInfo) << "Snapshot of " << kDiskPath_ << " taken at " << destination << " using "
+                 << (method == SnapshotMethod::kReflink ? "reflinks" :
+                     method == SnapshotMethod::kHardLink ? "hard links" : "copies");
+  return method;
+}
+
+void FakeStore::Export(const fs::path& archive_path, bool compress) const {
+  std::vector<char> buffer(kArchiveBufferSize);
+  std::ofstream archive;
+  archive.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+  archive.open(archive_path.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+  archive.write(kArchiveMagic, kMagicSize);
+
+  std::vector<std::pair<std::string, uint64_t>> index;
+  std::vector<ArchiveRecord> batch;
+  auto write_batch([&] {
+    if (compress)
+      TransformContents(batch, true);
+    for (const auto& record : batch) {
+      index.emplace_back(record.name, static_cast<uint64_t>(archive.tellp()));
+      WriteRecord(archive, record);
+    }
+    batch.clear();
+  });
+
+  WalkStore("", [&](const fs::path& path, const std::string& file_name) -> bool {
+    ArchiveRecord record;
+    record.name = file_name;
+    const std::string extension(path.extension().string());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (extension == ".ver") {
+      record.kind = kVersionsRecord;
+    } else {
+      try {
+        record.reference_count = std::stoul(extension.substr(1));
+      }
+      catch (const std::exception&) {
+        return true;
+      }
+      fs::path base_path(path);
+      const uint32_t pending(PendingDecrements(base_path.replace_extension()));
+      if (pending >= record.reference_count)
+        return true;
+      record.reference_count -= pending;
+    }
+    // A failed read means the entry was changed or removed since it was listed.
+    if (ReadFile(path, &record.content)) {
+      batch.push_back(std::move(record));
+      if (batch.size() >= kArchiveBatchSize)
+        write_batch();
+    }
+    return true;
+  });
+  write_batch();
+
+  std::sort(std::begin(index), std::end(index));
+  const auto index_offset(static_cast<uint64_t>(archive.tellp()));
+  std::vector<uint64_t> entry_offsets;
+  entry_offsets.reserve(index.size());
+  for (const auto& entry : index) {
+    entry_offsets.push_back(static_cast<uint64_t>(archive.tellp()));
+    WriteInteger(archive, static_cast<uint16_t>(entry.first.size()));
+    archive.write(entry.first.data(), entry.first.size());
+    WriteInteger(archive, entry.second);
+  }
+  for (const auto& entry_offset : entry_offsets)
+    WriteInteger(archive, entry_offset);
+  WriteInteger(archive, index_offset);
+  WriteInteger(archive, static_cast<uint64_t>(index.size()));
+  archive.write(kIndexMagic, kMagicSize);
+  archive.close();
+  if (!archive) {
+    LOG(kError) << "Failed writing archive " << archive_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+}
+
+void FakeStore::Export(const fs::path& disk_path, const fs::path& archive_path, bool compress) {
+  const FakeStore store(disk_path, ReadOnly());
+  store.Export(archive_path, compress);
+}
+
+void FakeStore::Import(const fs::path& archive_path) {
+  std::vector<char> buffer(kArchiveBufferSize);
+  std::ifstream archive;
+  archive.rdbuf()->pubsetbuf(&buffer[0], buffer.size());
+  archive.open(archive_path.string(), std::ios::in | std::ios::binary);
+  uint64_t record_count(0);
+  const std::streamoff index_offset(CheckArchive(archive, record_count));
+  archive.seekg(kMagicSize, std::ios::beg);
+
+  std::vector<fs::path> changed_paths;
+  std::vector<ArchiveRecord> batch;
+  auto apply_batch([&] {
+    TransformContents(batch, false);
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& record : batch) {
+      fs::path file_path(
+          KeyToFilePath(detail::GetDataNameVariant(fs::path(record.name)), true));
+      const NonEmptyString content(record.content);
+      const uintmax_t size(record.content.size());
+      AddToKeyFilter(record.name);
+      if (record.kind == kVersionsRecord) {
+        file_path.replace_extension(".ver");
+        boost::system::error_code error_code;
+        if (fs::exists(file_path, error_code)) {
+          LOG(kWarning) << "Not importing versions over existing " << file_path;
+          continue;
+        }
+        Write(file_path, content, size);
+        current_disk_usage_.data += size;
+      } else {
+        const uint32_t existing_count(GetReferenceCount(file_path));
+        if (existing_count == 0) {
+          file_path.replace_extension("." + std::to_string(record.reference_count));
+          Write(file_path, content, size);
+          current_disk_usage_.data += size;
+        } else {
+          fs::path old_path(file_path);
+          old_path.replace_extension("." + std::to_string(existing_count));
+          file_path.replace_extension(
+              "." + std::to_string(existing_count + record.reference_count));
+          Rename(old_path, file_path);
+        }
+      }
+      changed_paths.push_back(file_path);
+    }
+    ScheduleEviction();
+    batch.clear();
+  });
+
+  while (archive.tellg() < index_offset) {
+    batch.push_back(ReadRecord(archive));
+    if (batch.size() >= kArchiveBatchSize)
+      apply_batch();
+  }
+  apply_batch();
+
+  const auto promise(std::make_shared<boost::promise<void>>());
+  auto committed(promise->get_future());
+  Commit(std::move(changed_paths), promise);
+  committed.get();
+  NFS_LOG(kInfo) << "Imported " << record_count << " records from " << archive_path;
+}
+
+NonEmptyString FakeStore::GetFromArchive(const fs::path& archive_path,
+                                         const DataNameVariant& data_name) {
+  std::ifstream archive(archive_path.string(), std::ios::in | std::ios::binary);
+  uint64_t record_count(0);
+  const std::streamoff index_offset(CheckArchive(archive, record_count));
+  archive.seekg(0, std::ios::end);
+  const std::streamoff table_offset(archive.tellg() - kFooterSize -
+                                    static_cast<std::streamoff>(record_count * 8));
+  if (table_offset < index_offset) {
+    LOG(kError) << "Corrupt index in " << archive_path;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  }
+
+  const std::string wanted(detail::GetFileName(data_name).string());
+  uint64_t low(0), high(record_count);
+  while (low < high) {
+    const uint64_t middle(low + (high - low) / 2);
+    archive.seekg(table_offset + static_cast<std::streamoff>(middle * 8), std::ios::beg);
+    archive.seekg(static_cast<std::streamoff>(ReadInteger<uint64_t>(archive)), std::ios::beg);
+    const std::string name(ReadString(archive, ReadInteger<uint16_t>(archive)));
+    if (name < wanted) {
+      low = middle + 1;
+    } else if (wanted < name) {
+      high = middle;
+    } else {
+      archive.seekg(static_cast<std::streamoff>(ReadInteger<uint64_t>(archive)), std::ios::beg);
+      std::vector<ArchiveRecord> record(1, ReadRecord(archive));
+      TransformContents(record, false);
+      return NonEmptyString(record.front().content);
+    }
+  }
+  BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+}
+
+FakeStore::KeyFilterStats FakeStore::GetKeyFilterStats() const {
+  KeyFilterStats stats;
+  {
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    if (key_filter_) {
+      stats.capacity = key_filter_->capacity();
+      stats.entries = key_filter_->size();
+      stats.expected_false_positive_rate = key_filter_->ExpectedFalsePositiveRate();
+    }
+  }
+  stats.lookups = filter_lookups_;
+  stats.definite_misses = filter_misses_;
+  stats.false_positives = filter_false_positives_;
+  const uint64_t absent(stats.definite_misses + stats.false_positives);
+  stats.observed_false_positive_rate =
+      absent == 0 ? 0.0 : static_cast<double>(stats.false_positives) / absent;
+  return stats;
+}
+
+bool FakeStore::MayContain(const std::string& file_name) const {
+  std::shared_ptr<BloomFilter> key_filter;
+  {
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    key_filter = key_filter_;
+  }
+  // Until the filter has been built, every key has to be looked up on disk.
+  if (!key_filter)
+    return true;
+  ++filter_lookups_;
+  if (key_filter->MightContain(file_name))
+    return true;
+  ++filter_misses_;
+  return false;
+}
+
+void FakeStore::RecordFalsePositive() const {
+  std::lock_guard<std::mutex> lock(filter_mutex_);
+  if (key_filter_)
+    ++filter_false_positives_;
+}
+
+void FakeStore::AddToKeyFilter(const std::string& file_name) {
+  std::lock_guard<std::mutex> lock(filter_mutex_);
+  if (next_key_filter_)
+    next_key_filter_->Add(file_name);
+  if (key_filter_) {
+    key_filter_->Add(file_name);
+    if (key_filter_->size() * 2 > key_filter_->capacity() && !next_key_filter_)
+      ScheduleKeyFilterRebuild(4 * key_filter_->size());
+  }
+}
+
+void FakeStore::ScheduleKeyFilterRebuild(uint64_t capacity) {
+  next_key_filter_ = std::make_shared<BloomFilter>(std::max(capacity, kMinKeyFilterCapacity),
+                                                   kKeyFilterFalsePositiveRate);
+  asio_service_.service().post([this] {
+    try {
+      RebuildKeyFilter();
+    }
+    catch (const std::exception& e) {
+      LOG(kWarning) << "Rebuilding key filter failed: " << boost::diagnostic_information(e);
+      std::lock_guard<std::mutex> lock(filter_mutex_);
+      next_key_filter_.reset();
+    }
+  });
+}
+
+void FakeStore::RebuildKeyFilter() {
+  std::shared_ptr<BloomFilter> next_key_filter;
+  {
+    std::lock_guard<std::mutex> lock(filter_mutex_);
+    next_key_filter = next_key_filter_;
+  }
+  // Puts made during the walk are added to both filters by AddToKeyFilter, so nothing is missed.
+  WalkStore("", [&next_key_filter](const fs::path&, const std::string& file_name) -> bool {
+    next_key_filter->Add(file_name);
+    return true;
+  });
+
+  std::lock_guard<std::mutex> lock(filter_mutex_);
+  key_filter_ = next_key_filter_;
+  next_key_filter_.reset();
+  NFS_LOG(kInfo) << "Key filter rebuilt with " << key_filter_->size() << " entries.";
+  if (key_filter_->size() * 2 > key_filter_->capacity())
+    ScheduleKeyFilterRebuild(4 * key_filter_->size());
+}
+
+void FakeStore::WalkStore(
+    const std::string& resume_after,
+    const std::function<bool(const fs::path&, const std::string&)>& visit) const {
+  std::function<bool(const fs::path&, const std::string&)> walk;
+  walk = [&](const fs::path& directory, const std::string& prefix) -> bool {
+    std::vector<fs::path> entries;
+    boost::system::error_code error_code;
+    for (fs::directory_iterator itr(directory, error_code), end; !error_code && itr != end;
+         itr.increment(error_code)) {
+      entries.push_back(itr->path());
+    }
+    std::sort(std::begin(entries), std::end(entries));
+    for (const auto& entry : entries) {
+      if (fs::is_directory(entry, error_code)) {
+        // Only the single-character directories from KeyToFilePath hold stored data.
+        const std::string directory_name(entry.filename().string());
+        if (directory_name.size() != 1 || prefix.size() >= kDepth_)
+          continue;
+        const std::string child_prefix(prefix + directory_name);
+        if (child_prefix < resume_after.substr(0, child_prefix.size()))
+          continue;
+        if (!walk(entry, child_prefix))
+          return false;
+      } else if (!prefix.empty()) {
+        const std::string file_name(prefix + entry.stem().string());
+        if (!resume_after.empty() && file_name <= resume_after)
+          continue;
+        if (!visit(entry, file_name))
+          return false;
+      }
+    }
+    return true;
+  };
+  walk(kDiskPath_, "");
+}
+
 fs::path FakeStore::GetFilePath(const KeyType& key) const {
   return kDiskPath_ / detail::GetFileName(key);
 }
@@ -299,13 +1728,32 @@ uint32_t FakeStore::GetReferenceCount(const fs::path& path) const {
 void FakeStore::Write(const boost::filesystem::path& path, const NonEmptyString& value,
                           const uintmax_t& size) {
   if (!HasDiskSpace(size)) {
-    LOG(kError) << "Out of space.";
-    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::cannot_exceed_limit));
+    if (!eviction_enabled_) {
+      LOG(kError) << "Out of space.";
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::cannot_exceed_limit));
+    }
+    // In cache mode the write is admitted and eviction is left to reclaim the overshoot.
+    const uint64_t over_limit(current_disk_usage_.data + size - max_disk_usage_.data);
+    eviction_overshoot_ += std::min<uint64_t>(over_limit, size);
+    NFS_LOG(kInfo) << "Admitting write " << over_limit << " bytes over the limit.";
   }
-  if (!WriteFile(path, value.string())) {
+  // An existing file is replaced rather than modified, so a snapshot sharing it, or being taken
+  // concurrently, sees either the old contents or the new ones whole.
+  const fs::path temp_path(kDiskPath_ / kTempDirectoryName / fs::unique_path());
+  boost::system::error_code error_code;
+  if (!WriteFile(temp_path, value.string())) {
     LOG(kError) << "Write failed.";
+    fs::remove(temp_path, error_code);
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  fs::rename(temp_path, path, error_code);
+  if (error_code) {
+    LOG(kError) << "Failed to rename " << temp_path << " to " << path << ": "
+                << error_code.message();
+    fs::remove(temp_path, error_code);
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
   }
+  UpdateIndex(path, size);
 }
 
 uintmax_t FakeStore::Remove(const fs::path& path) {
@@ -319,6 +1767,7 @@ uintmax_t FakeStore::Remove(const fs::path& path) {
     LOG(kError) << "Error removing file " << path << ": " << error_code.message();
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
   }
+  EraseFromIndex(path);
   return file_size;
 }
 
@@ -334,10 +1783,204 @@ uintmax_t FakeStore::Rename(const fs::path& old_path, const fs::path& new_path)
     LOG(kError) << "Error renaming file " << old_path << ": " << error_code.message();
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
   }
+  UpdateIndex(new_path, file_size);
   return file_size;
 }
 
+std::string FakeStore::IndexName(const fs::path& path) const {
+  std::string name(path.stem().string());
+  for (fs::path parent(path.parent_path()); !parent.empty() && parent != kDiskPath_;
+       parent = parent.parent_path()) {
+    name = parent.filename().string() + name;
+  }
+  return path.extension() == ".ver" ? name + ".ver" : name;
+}
+
+void FakeStore::UpdateIndex(const fs::path& path, uintmax_t size) {
+  const std::string name(IndexName(path));
+  const bool versions(path.extension() == ".ver");
+  auto found(index_.find(name));
+  if (found == std::end(index_)) {
+    IndexEntry entry;
+    try {
+      entry.tag = boost::apply_visitor(
+          GetTagValueVisitor(),
+          detail::GetDataNameVariant(fs::path(versions ? name.substr(0, name.size() - 4) : name)));
+    }
+    catch (const std::exception&) {
+      LOG(kWarning) << "Not indexing unrecognised file " << path;
+      return;
+    }
+    found = index_.insert(std::make_pair(name, entry)).first;
+  } else {
+    Account(found->second, false);
+  }
+  found->second.size = size;
+  found->second.reference_count = 1;
+  if (!versions) {
+    try {
+      found->second.reference_count = std::stoul(path.extension().string().substr(1));
+    }
+    catch (const std::exception&) {}
+  }
+  Account(found->second, true);
+}
+
+void FakeStore::EraseFromIndex(const fs::path& path) {
+  const auto found(index_.find(IndexName(path)));
+  if (found == std::end(index_))
+    return;
+  Account(found->second, false);
+  index_.erase(found);
+}
+
+void FakeStore::BuildIndex() {
+  WalkStore("", [this](const fs::path& path, const std::string&) -> bool {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Entries already indexed were written since the walk started, so are more current.
+    boost::system::error_code error_code;
+    const uintmax_t size(fs::file_size(path, error_code));
+    if (!error_code && index_.find(IndexName(path)) == std::end(index_))
+      UpdateIndex(path, size);
+    return true;
+  });
+  std::lock_guard<std::mutex> lock(mutex_);
+  NFS_LOG(kInfo) << "Indexed " << index_.size() << " stored entries.";
+  // The index now covers every stored file, so replaces the usage taken from the ledger (or zero,
+  // if the store wasn't shut down cleanly).
+  DiskUsage indexed_usage(0);
+  for (const auto& counters : type_usage_)
+    indexed_usage.data += counters.bytes;
+  if (indexed_usage != current_disk_usage_) {
+    NFS_LOG(kInfo) << "Disk usage corrected from " << current_disk_usage_.data << " to "
+                   << indexed_usage.data << " bytes.";
+    current_disk_usage_ = indexed_usage;
+  }
+}
+
+std::vector<FakeStore::StoredEntry> FakeStore::Enumerate(
+    EnumerationCursor& cursor, size_t max_entries, const std::vector<DataTagValue>& types) const {
+  index_ready_.get();
+  std::vector<StoredEntry> entries;
+  if (cursor.done)
+    return entries;
+
+  // The scan is bounded per call, so a selective type filter can't hold the lock for long.
+  size_t remaining_scan(std::max<size_t>(1024, 4 * max_entries));
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto itr(index_.upper_bound(cursor.position));
+  for (; itr != std::end(index_) && entries.size() < max_entries && remaining_scan != 0;
+       ++itr, --remaining_scan) {
+    cursor.position = itr->first;
+    if (!types.empty() &&
+        std::find(std::begin(types), std::end(types), itr->second.tag) == std::end(types)) {
+      continue;
+    }
+    const bool versions(itr->first.size() > 4 &&
+                        itr->first.compare(itr->first.size() - 4, 4, ".ver") == 0);
+    const auto name(detail::GetDataNameVariant(
+        fs::path(versions ? itr->first.substr(0, itr->first.size() - 4) : itr->first)));
+    uint32_t reference_count(itr->second.reference_count);
+    if (!versions && !pending_decrements_.empty()) {
+      const uint32_t pending(PendingDecrements(KeyToFilePath(name, false)));
+      if (pending >= reference_count)
+        continue;
+      reference_count -= pending;
+    }
+    entries.push_back(StoredEntry(name, itr->second.size, reference_count, versions));
+  }
+  cursor.done = (itr == std::end(index_));
+  return entries;
+}
+
+void FakeStore::Account(const IndexEntry& entry, bool add) {
+  const size_t slot(static_cast<size_t>(entry.tag));
+  if (slot < type_usage_.size()) {
+    auto& counters(type_usage_[slot]);
+    if (add) {
+      counters.bytes += entry.size;
+      ++counters.objects;
+      counters.references += entry.reference_count;
+    } else {
+      counters.bytes -= entry.size;
+      --counters.objects;
+      counters.references -= entry.reference_count;
+    }
+  }
+}
+
+FakeStore::UsageStats FakeStore::GetUsageStats() const {
+  UsageStats stats;
+  stats.exact = index_ready_.has_value();
+  if (!stats.exact && ledger_usage_)
+    return *ledger_usage_;
+  for (size_t slot(0); slot != type_usage_.size(); ++slot) {
+    Usage usage;
+    usage.objects = type_usage_[slot].objects;
+    if (usage.objects == 0)
+      continue;
+    usage.bytes = type_usage_[slot].bytes;
+    usage.references = type_usage_[slot].references;
+    stats.by_type[static_cast<DataTagValue>(slot)] = usage;
+  }
+  return stats;
+}
+
+void FakeStore::LoadUsageLedger() {
+  // The ledger is only valid for the shutdown or snapshot which wrote it, so it's consumed here.
+  const fs::path ledger_path(kDiskPath_ / kUsageLedgerName);
+  std::ifstream ledger(ledger_path.string());
+  if (!ledger)
+    return;
+  auto stats(maidsafe::make_unique<UsageStats>());
+  bool has_types(false);
+  std::string line;
+  while (std::getline(ledger, line)) {
+    std::istringstream fields(line);
+    std::string kind;
+    fields >> kind;
+    if (kind == "disk") {
+      uint64_t bytes(0);
+      if (fields >> bytes)
+        current_disk_usage_.data = bytes;
+    } else if (kind == "type") {
+      int tag(0);
+      Usage usage;
+      if (fields >> tag >> usage.bytes >> usage.objects >> usage.references) {
+        stats->by_type[static_cast<DataTagValue>(tag)] = usage;
+        has_types = true;
+      }
+    }
+  }
+  ledger.close();
+  boost::system::error_code error_code;
+  fs::remove(ledger_path, error_code);
+  if (has_types)
+    ledger_usage_ = std::move(stats);
+}
+
+void FakeStore::SaveUsageLedger(const fs::path& directory) const {
+  try {
+    std::ofstream ledger((directory / kUsageLedgerName).string(),
+                         std::ios::out | std::ios::trunc);
+    ledger << "disk " << current_disk_usage_.data << '\n';
+    // Figures from a partial index walk would undercount, so the loaded ledger is kept instead.
+    const UsageStats stats(GetUsageStats());
+    if (!stats.exact && !ledger_usage_)
+      return;
+    for (const auto& type : stats.by_type) {
+      ledger << "type " << static_cast<int>(type.first) << ' ' << type.second.bytes << ' '
+             << type.second.objects << ' ' << type.second.references << '\n';
+    }
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "Failed to save usage ledger: " << boost::diagnostic_information(e);
+  }
+}
+
 std::unique_ptr<StructuredDataVersions> FakeStore::ReadVersions(const KeyType& key) const {
+  if (!MayContain(GetFilePath(key).filename().string()))
+    return std::unique_ptr<StructuredDataVersions>();
   fs::path file_path(KeyToFilePath(key, false));
   file_path.replace_extension(".ver");
   boost::system::error_code ec;
@@ -347,7 +1990,7 @@ std::unique_ptr<StructuredDataVersions> FakeStore::ReadVersions(const KeyType& k
       std::move(std::unique_ptr<StructuredDataVersions>());
 }
 
-void FakeStore::WriteVersions(
+fs::path FakeStore::WriteVersions(
     const KeyType& key, const StructuredDataVersions& versions, const bool creation) {
   if (!fs::exists(kDiskPath_))
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
@@ -367,6 +2010,9 @@ void FakeStore::WriteVersions(
   uint32_t value_size(static_cast<uint32_t>(serialised_versions.string().size()));
   Write(file_path, serialised_versions, value_size);
   current_disk_usage_.data += value_size;
+  ScheduleEviction();
+  AddToKeyFilter(GetFilePath(key).filename().string());
+  return file_path;
 }
 
 }  // namespace nfs
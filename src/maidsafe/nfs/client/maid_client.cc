@@ -23,6 +23,7 @@
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/make_unique.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/vault/maid_account_creation.h"
 #include "maidsafe/nfs/vault/maid_account_removal.h"
 #include "maidsafe/nfs/vault/pmid_registration.h"
@@ -38,52 +39,81 @@ namespace {
 // This allows a client to lookup *only* in a provided public pmid list, when it is
 // validating a peer while connecting.
 void GivePublicPmidKey(const NodeId& node_id, routing::GivePublicKeyFunctor give_key,
-                       const std::vector<passport::PublicPmid>& public_pmids) {
+                       const nfs::detail::PublicPmidDirectory& public_pmids) {
   assert(!public_pmids.empty());
-  passport::PublicPmid::Name name(Identity(node_id.string()));
-  LOG(kVerbose) << "fetch from local list containing "
-                << public_pmids.size() << " pmids";
-  auto itr(std::find_if(
-      std::begin(public_pmids), std::end(public_pmids),
-      [&name](const passport::PublicPmid & pmid) { return pmid.name() == name; }));
-  if (itr == public_pmids.end()) {
-    LOG(kError) << "can't Get PublicPmid " << HexSubstr(name.value)
-                << " from local list";
+  NFS_LOG(kVerbose) << "fetch from local list containing "
+                    << public_pmids.size() << " pmids";
+  const passport::PublicPmid* public_pmid(public_pmids.Find(node_id.string()));
+  if (!public_pmid) {
+    LOG(kError) << "can't Get PublicPmid " << DebugId(node_id) << " from local list";
     assert(false);
   } else {
-    LOG(kVerbose) << "Got PublicPmid from local list " << HexSubstr(name.value);
-    give_key((*itr).public_key());
+    NFS_LOG(kVerbose) << "Got PublicPmid from local list " << DebugId(node_id);
+    give_key(public_pmid->public_key());
   }
 }
 
 void UpdateRequestPublicKeyFunctor(routing::RequestPublicKeyFunctor& request_public_key,
-                                   const std::vector<passport::PublicPmid>& public_pmids) {
-  LOG(kInfo) << " Zero state UpdateRequestPublicKeyFunctor";
-  request_public_key = [=](const NodeId& node_id, const routing::GivePublicKeyFunctor& give_key) {
-                         GivePublicPmidKey(node_id, give_key, public_pmids);
+                                   std::vector<passport::PublicPmid> public_pmids) {
+  NFS_LOG(kInfo) << " Zero state UpdateRequestPublicKeyFunctor";
+  // Indexed once here, and shared by every copy routing makes of the functor.
+  std::shared_ptr<const nfs::detail::PublicPmidDirectory> directory(
+      std::make_shared<nfs::detail::PublicPmidDirectory>(std::move(public_pmids)));
+  request_public_key = [directory](const NodeId& node_id,
+                                   const routing::GivePublicKeyFunctor& give_key) {
+                         GivePublicPmidKey(node_id, give_key, *directory);
                        };
 }
 
 }  // anonymous namespace
 
+const size_t MaidClient::kMaxPutManyBatchBytes(4 * 1024 * 1024);
+const int MaidClient::kDefaultReadyHealth;
 
-std::shared_ptr<MaidClient> MaidClient::MakeShared(const passport::Maid& maid) {
-  std::shared_ptr<MaidClient> maid_node_ptr{ new MaidClient{ maid } };
+std::shared_ptr<MaidClient> MaidClient::MakeShared(
+    const passport::Maid& maid, const boost::filesystem::path& public_key_cache_path) {
+  std::shared_ptr<MaidClient> maid_node_ptr{
+      new MaidClient{ maid, kDefaultReadyHealth, public_key_cache_path } };
   maid_node_ptr->Init();
   return maid_node_ptr;
 }
 
 std::shared_ptr<MaidClient> MaidClient::MakeShared(
-    const passport::MaidAndSigner& maid_and_signer) {
-  std::shared_ptr<MaidClient> maid_node_ptr{ new MaidClient{ maid_and_signer.first } };
+    const passport::MaidAndSigner& maid_and_signer,
+    const boost::filesystem::path& public_key_cache_path) {
+  std::shared_ptr<MaidClient> maid_node_ptr{
+      new MaidClient{ maid_and_signer.first, kDefaultReadyHealth, public_key_cache_path } };
   maid_node_ptr->Init(maid_and_signer);
   return maid_node_ptr;
 }
 
+std::shared_ptr<MaidClient> MaidClient::MakeSharedAsync(
+    const passport::Maid& maid, int ready_health,
+    const boost::filesystem::path& public_key_cache_path) {
+  std::shared_ptr<MaidClient> maid_node_ptr{
+      new MaidClient{ maid, ready_health, public_key_cache_path } };
+  maid_node_ptr->InitAsync();
+  return maid_node_ptr;
+}
+
+std::shared_ptr<MaidClient> MaidClient::MakeSharedAsync(
+    const passport::MaidAndSigner& maid_and_signer, boost::future<void>& account_created,
+    int ready_health, const boost::filesystem::path& public_key_cache_path) {
+  std::shared_ptr<MaidClient> maid_node_ptr{
+      new MaidClient{ maid_and_signer.first, ready_health, public_key_cache_path } };
+  maid_node_ptr->InitAsync();
+  // Queued until the client is ready, ahead of any request the caller goes on to make.
+  account_created = maid_node_ptr->CreateAccount(nfs_vault::MaidAccountCreation{
+      passport::PublicMaid{ maid_and_signer.first },
+      passport::PublicAnmaid{ maid_and_signer.second } });
+  return maid_node_ptr;
+}
+
 std::shared_ptr<MaidClient> MaidClient::MakeSharedZeroState(
     const passport::MaidAndSigner& maid_and_signer,
     const std::vector<passport::PublicPmid>& public_pmids) {
-  std::shared_ptr<MaidClient> maid_node_ptr{ new MaidClient{ maid_and_signer.first } };
+  std::shared_ptr<MaidClient> maid_node_ptr{
+      new MaidClient{ maid_and_signer.first, kDefaultReadyHealth, boost::filesystem::path() } };
   maid_node_ptr->InitZeroState(maid_and_signer, public_pmids);
   return maid_node_ptr;
 }
@@ -107,11 +137,11 @@ void MaidClient::InitZeroState(const passport::MaidAndSigner& maid_and_signer,
 
 void MaidClient::CreateAccount(const passport::PublicMaid& public_maid,
                                 const passport::PublicAnmaid& public_anmaid) {
-  LOG(kInfo) << "Calling CreateAccount for maid ID:" << DebugId(public_maid.name());
+  NFS_LOG(kInfo) << "Calling CreateAccount for maid ID:" << DebugId(public_maid.name());
   nfs_vault::MaidAccountCreation account_creation{ public_maid, public_anmaid };
   auto create_account_future = CreateAccount(account_creation);
   create_account_future.get();
-  LOG(kInfo) << " CreateAccount for maid ID:" << DebugId(public_maid.name()) << " succeeded.";
+  NFS_LOG(kInfo) << " CreateAccount for maid ID:" << DebugId(public_maid.name()) << " succeeded.";
 }
 
 void MaidClient::Init() {
@@ -120,35 +150,57 @@ void MaidClient::Init() {
   cleanup_on_error.Release();
 }
 
-MaidClient::MaidClient(const passport::Maid& maid)
+void MaidClient::InitAsync() {
+  on_scope_exit cleanup_on_error([&] { Stop(); });
+  JoinRouting(std::vector<passport::PublicPmid>());
+  cleanup_on_error.Release();
+}
+
+MaidClient::MaidClient(const passport::Maid& maid, int ready_health,
+                       const boost::filesystem::path& public_key_cache_path)
     : kMaid_(maid),
+      kReadyHealth_(ready_health),
+      kPublicKeyCachePath_(public_key_cache_path),
       asio_service_(2),
       rpc_timers_(asio_service_),
       network_health_mutex_(),
       network_health_condition_variable_(),
       network_health_(-1),
+      ready_queue_(),
       network_health_change_signal_(),
+      // Not held by 'ready_queue_': the client can't become ready until these are answered.
+      public_key_cache_([this](const NodeId& node_id, routing::GivePublicKeyFunctor give_key) {
+        data_getter_.Get(passport::PublicPmid::Name{ Identity{ node_id.string() } },
+                         [give_key](const DataNameAndContentOrReturnCode& result) {
+                           give_key(PublicPmidKey(result));
+                         },
+                         std::chrono::seconds(10));
+      }),
       routing_(maidsafe::make_unique<routing::Routing>(kMaid_)),
       data_getter_(asio_service_, *routing_),
-      public_pmid_helper_(),
       dispatcher_(*routing_),
       service_([&]()->std::unique_ptr<MaidNodeService> {
         std::unique_ptr<MaidNodeService> service(
             new MaidNodeService(routing::SingleId(routing_->kNodeId()), rpc_timers_));
         return std::move(service);
       }()) {
+  if (!kPublicKeyCachePath_.empty())
+    public_key_cache_.Load(kPublicKeyCachePath_, kMaid_.public_key());
 }
 
 void MaidClient::Stop() {
-  LOG(kVerbose) << "MaidClient::Stop()";
+  NFS_LOG(kVerbose) << "MaidClient::Stop()";
+  ready_queue_.Clear();
+  if (!kPublicKeyCachePath_.empty())
+    public_key_cache_.Save(kPublicKeyCachePath_, kMaid_.private_key());
   dispatcher_.Stop();
-  LOG(kVerbose) << "MaidClient::Stop() : dispatcher_";
+  NFS_LOG(kVerbose) << "MaidClient::Stop() : dispatcher_";
   routing_.reset();
-  LOG(kVerbose) << "MaidClient::Stop() : routing_";
+  NFS_LOG(kVerbose) << "MaidClient::Stop() : routing_";
   rpc_timers_.CancellAll();
-  LOG(kVerbose) << "MaidClient::Stop() : rpc_timers_";
+  NFS_LOG(kVerbose) << "MaidClient::Stop() : rpc_timers_";
   asio_service_.Stop();
-  LOG(kVerbose) << "MaidClient::Stop() : asio_service_";
+  NFS_LOG(kVerbose) << "MaidClient::Stop() : asio_service_";
 }
 
 MaidClient::OnNetworkHealthChange& MaidClient::network_health_change_signal() {
@@ -156,14 +208,7 @@ MaidClient::OnNetworkHealthChange& MaidClient::network_health_change_signal() {
 }
 
 void MaidClient::InitRouting(std::vector<passport::PublicPmid> public_pmids) {
-  routing::Functors functors(InitialiseRoutingCallbacks());
-  if (!public_pmids.empty()) {
-    UpdateRequestPublicKeyFunctor(functors.request_public_key, public_pmids);
-    LOG(kInfo) << "Modified RequestPublicKeyFunctor for Zero state client";
-  }
-  LOG(kInfo) << "after  InitialiseRoutingCallbacks";
-  routing_->Join(functors);
-  LOG(kInfo) << "after  routing_.Join()";
+  JoinRouting(std::move(public_pmids));
   // FIXME BEFORE_RELEASE discuss: parallel attempts, max no. of endpoints to try,
   // prioritise live ports. To reduce the blocking duration in case of no network connectivity
   std::unique_lock<std::mutex> lock{ network_health_mutex_ };
@@ -171,6 +216,19 @@ void MaidClient::InitRouting(std::vector<passport::PublicPmid> public_pmids) {
     return (network_health_ == 100) || (network_health_ < -300000); });
   if (network_health_ < 0)
     BOOST_THROW_EXCEPTION(MakeError(RoutingErrors::not_connected));
+  lock.unlock();
+  ready_queue_.Release();
+}
+
+void MaidClient::JoinRouting(std::vector<passport::PublicPmid> public_pmids) {
+  routing::Functors functors(InitialiseRoutingCallbacks());
+  if (!public_pmids.empty()) {
+    UpdateRequestPublicKeyFunctor(functors.request_public_key, std::move(public_pmids));
+    NFS_LOG(kInfo) << "Modified RequestPublicKeyFunctor for Zero state client";
+  }
+  NFS_LOG(kInfo) << "after  InitialiseRoutingCallbacks";
+  routing_->Join(functors);
+  NFS_LOG(kInfo) << "after  routing_.Join()";
 }
 
 routing::Functors MaidClient::InitialiseRoutingCallbacks() {
@@ -190,9 +248,7 @@ routing::Functors MaidClient::InitialiseRoutingCallbacks() {
   functors.close_nodes_change = [](std::shared_ptr<routing::CloseNodesChange> /*close_change*/) {};
   functors.request_public_key = [this_ptr](const NodeId& node_id,
                                        const routing::GivePublicKeyFunctor& give_key) {
-    auto future_key(this_ptr->Get(passport::PublicPmid::Name{ Identity{ node_id.string() } },
-                                        std::chrono::seconds(10)));
-    this_ptr->public_pmid_helper_.AddEntry(std::move(future_key), give_key);
+    this_ptr->public_key_cache_.GetKey(node_id, give_key);
   };
 
   // TODO(Prakash) fix routing asserts for clients so client need not to provide callbacks for all
@@ -218,6 +274,8 @@ void MaidClient::OnNetworkStatusChange(int updated_network_health) {
     routing::UpdateNetworkHealth(updated_network_health, this_ptr->network_health_,
         this_ptr->network_health_mutex_, this_ptr->network_health_condition_variable_,
         NodeId(this_ptr->kMaid_.name()->string()));
+    if (updated_network_health >= this_ptr->kReadyHealth_)
+      this_ptr->ready_queue_.Release();
   });
 }
 
@@ -238,12 +296,53 @@ boost::future<void> MaidClient::CreateAccount(
                },
       // TODO(Fraser#5#): 2013-08-18 - Confirm expected count
       routing::Parameters::group_size - 1, task_id);
-  dispatcher_.SendCreateAccountRequest(task_id, account_creation);
+  ready_queue_.Run([=] { dispatcher_.SendCreateAccountRequest(task_id, account_creation); });
   return promise->get_future();
 }
 
+void MaidClient::SendPutManyBatch(std::vector<nfs_vault::DataNameAndContent> batch,
+                                  std::vector<std::shared_ptr<boost::promise<void>>> promises,
+                                  const std::chrono::steady_clock::duration& timeout) {
+  typedef MaidNodeService::PutManyResponse::Contents ResponseContents;
+  // The batch shares one timer task, but each item is decided by its own quorum so that a group
+  // member disagreeing about one item doesn't fail the rest.
+  std::vector<nfs_vault::DataName> names;
+  std::vector<std::shared_ptr<nfs::OpData<ReturnCode>>> op_datas;
+  names.reserve(batch.size());
+  op_datas.reserve(batch.size());
+  for (size_t index(0); index != batch.size(); ++index) {
+    names.push_back(batch[index].name);
+    auto promise(promises[index]);
+    op_datas.push_back(std::make_shared<nfs::OpData<ReturnCode>>(
+        routing::Parameters::group_size - 1,
+        [promise](const ReturnCode& result) { HandlePutResponseResult(result, promise); }));
+  }
+  auto task_id(rpc_timers_.put_many_timer.NewTaskId());
+  rpc_timers_.put_many_timer.AddTask(
+      timeout,
+      [names, op_datas](ResponseContents put_many_response) {
+        auto& results(put_many_response.data_names_and_return_codes);
+        // A response which doesn't match the batch item for item (e.g. the defaulted one given
+        // on timeout) counts as a failure for every item.
+        const bool matches_batch(results.size() == names.size());
+        for (size_t index(0); index != names.size(); ++index) {
+          if (matches_batch && results[index].name == names[index])
+            op_datas[index]->HandleResponseContents(std::move(results[index].return_code));
+          else
+            op_datas[index]->HandleResponseContents(ReturnCode());
+        }
+      },
+      routing::Parameters::group_size - 1, task_id);
+  if (NFS_LOG_ENABLED(kVerbose))
+    rpc_timers_.put_many_timer.PrintTaskIds();
+  auto contents(std::make_shared<nfs_vault::DataNamesAndContents>(std::move(batch)));
+  ready_queue_.Run([this, task_id, contents] {
+    dispatcher_.SendPutManyRequest(task_id, std::move(*contents));
+  });
+}
+
 void MaidClient::RemoveAccount(const nfs_vault::MaidAccountRemoval& account_removal) {
-  dispatcher_.SendRemoveAccountRequest(account_removal);
+  ready_queue_.Run([=] { dispatcher_.SendRemoveAccountRequest(account_removal); });
 }
 
 }  // namespace nfs_client
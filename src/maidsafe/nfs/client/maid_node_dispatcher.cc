@@ -23,19 +23,28 @@ namespace maidsafe {
 namespace nfs_client {
 
 MaidNodeDispatcher::MaidNodeDispatcher(routing::Routing& routing)
-    : running_(true),
-      running_mutex_(),
+    : send_gate_(),
       routing_(routing),
       kThisNodeAsSender_(routing_.kNodeId()),
       kMaidManagerReceiver_(routing_.kNodeId()) {}
 
 
 void MaidNodeDispatcher::Stop() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  running_ = false;
+  send_gate_.Stop();
   LOG(kWarning) << " MaidNodeDispatcher::Stop() !";
 }
 
+void MaidNodeDispatcher::SendPutManyRequest(routing::TaskId task_id,
+                                            nfs_vault::DataNamesAndContents batch) {
+  typedef nfs::PutManyRequestFromMaidNodeToMaidManager NfsMessage;
+  CheckSourcePersonaType<NfsMessage>();
+  typedef routing::Message<NfsMessage::Sender, NfsMessage::Receiver> RoutingMessage;
+  NFS_LOG(kVerbose) << "MaidNodeDispatcher::SendPutManyRequest for "
+                    << batch.data_names_and_contents.size() << " chunks";
+  NfsMessage nfs_message(nfs::MessageId(task_id), std::move(batch));
+  RoutingSend(RoutingMessage(nfs_message.Serialise(), kThisNodeAsSender_, kMaidManagerReceiver_));
+}
+
 void MaidNodeDispatcher::SendCreateAccountRequest(
     routing::TaskId task_id,
     const nfs_vault::MaidAccountCreation& maid_account_creation) {
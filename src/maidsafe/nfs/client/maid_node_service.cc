@@ -18,6 +18,7 @@
 
 #include "maidsafe/nfs/client/maid_node_service.h"
 #include "maidsafe/nfs/client/get_handler.h"
+#include "maidsafe/nfs/log.h"
 
 #include "maidsafe/common/error.h"
 
@@ -36,6 +37,7 @@ std::error_code NoSuchElement() {
 
 MaidNodeService::RpcTimers::RpcTimers(BoostAsioService& asio_service_)
     : put_timer(asio_service_),
+      put_many_timer(asio_service_),
       get_versions_timer(asio_service_),
       get_branch_timer(asio_service_),
       create_account_timer(asio_service_),
@@ -44,6 +46,7 @@ MaidNodeService::RpcTimers::RpcTimers(BoostAsioService& asio_service_)
 
 void MaidNodeService::RpcTimers::CancellAll() {
   put_timer.CancelAll();
+  put_many_timer.CancelAll();
   get_versions_timer.CancelAll();
   get_branch_timer.CancelAll();
   create_account_timer.CancelAll();
@@ -58,7 +61,7 @@ MaidNodeService::MaidNodeService(const routing::SingleId& receiver,
 void MaidNodeService::HandleMessage(const PutResponse& message,
                                     const PutResponse::Sender& /*sender*/,
                                     const PutResponse::Receiver& receiver) {
-  LOG(kVerbose) << "MaidNodeService::HandleMessage PutResponse " << message.id;
+  NFS_LOG(kVerbose) << "MaidNodeService::HandleMessage PutResponse " << message.id;
   assert(receiver == kReceiver_);
   static_cast<void>(receiver);
   try {
@@ -75,11 +78,28 @@ void MaidNodeService::HandleMessage(const PutResponse& message,
 void MaidNodeService::HandleMessage(const PutFailure& /*message*/,
                                     const PutFailure::Sender& /*sender*/,
                                     const PutFailure::Receiver& /*receiver*/) {
-  LOG(kInfo) << "Get response from PutFailure";
+  NFS_LOG(kInfo) << "Get response from PutFailure";
   // TODO(Fraser#5#): 2013-08-24 - Decide on how this is to be handled, and implement.
   assert(0);
 }
 
+void MaidNodeService::HandleMessage(const PutManyResponse& message,
+                                    const PutManyResponse::Sender& /*sender*/,
+                                    const PutManyResponse::Receiver& receiver) {
+  NFS_LOG(kVerbose) << "MaidNodeService::HandleMessage PutManyResponse " << message.id;
+  assert(receiver == kReceiver_);
+  static_cast<void>(receiver);
+  try {
+    rpc_timers_.put_many_timer.AddResponse(message.id.data, *message.contents);
+  }
+  catch (const maidsafe_error& error) {
+    if (error.code() != NoSuchElement())
+      throw;
+    else
+      LOG(kWarning) << "Timer does not expect:" << message.id.data;
+  }
+}
+
 void MaidNodeService::HandleMessage(const GetVersionsResponse& message,
                                     const GetVersionsResponse::Sender& /*sender*/,
                                     const GetVersionsResponse::Receiver& receiver) {
@@ -99,7 +119,7 @@ void MaidNodeService::HandleMessage(const GetVersionsResponse& message,
 void MaidNodeService::HandleMessage(const PutVersionResponse& message,
                                     const PutVersionResponse::Sender& /*sender*/,
                                     const PutVersionResponse::Receiver& /*receiver*/) {
-  LOG(kInfo) << "Get response for PutVersion";
+  NFS_LOG(kInfo) << "Get response for PutVersion";
   try {
     rpc_timers_.put_version_timer.AddResponse(message.id.data, *message.contents);
   }
@@ -130,7 +150,7 @@ void MaidNodeService::HandleMessage(const GetBranchResponse& message,
 void MaidNodeService::HandleMessage(const CreateAccountResponse& message,
                                     const CreateAccountResponse::Sender& /*sender*/,
                                     const CreateAccountResponse::Receiver& /*receiver*/) {
-  LOG(kInfo) << "Get response for CreateAccount";
+  NFS_LOG(kInfo) << "Get response for CreateAccount";
   try {
     rpc_timers_.create_account_timer.AddResponse(message.id.data, *message.contents);
   }
@@ -145,7 +165,7 @@ void MaidNodeService::HandleMessage(const CreateAccountResponse& message,
 void MaidNodeService::HandleMessage(const CreateVersionTreeResponse& message,
                                     const CreateVersionTreeResponse::Sender& /*sender*/,
                                     const CreateVersionTreeResponse::Receiver& /*receiver*/) {
-  LOG(kInfo) << "Get response for CreateVersionTree";
+  NFS_LOG(kInfo) << "Get response for CreateVersionTree";
   try {
     rpc_timers_.create_version_tree_timer.AddResponse(message.id.data, *message.contents);
   }
@@ -20,6 +20,7 @@
 
 #include <cstdint>
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/utils.h"
 #include "maidsafe/nfs/client/messages.pb.h"
 
@@ -179,6 +180,57 @@ void swap(DataNameAndReturnCode& lhs, DataNameAndReturnCode& rhs) MAIDSAFE_NOEXC
   swap(lhs.return_code, rhs.return_code);
 }
 
+//============================ DataNamesAndReturnCodes ============================================
+DataNamesAndReturnCodes::DataNamesAndReturnCodes() : data_names_and_return_codes() {}
+
+DataNamesAndReturnCodes::DataNamesAndReturnCodes(
+    std::vector<DataNameAndReturnCode> data_names_and_return_codes_in)
+    : data_names_and_return_codes(std::move(data_names_and_return_codes_in)) {}
+
+DataNamesAndReturnCodes::DataNamesAndReturnCodes(const DataNamesAndReturnCodes& other)
+    : data_names_and_return_codes(other.data_names_and_return_codes) {}
+
+DataNamesAndReturnCodes::DataNamesAndReturnCodes(DataNamesAndReturnCodes&& other)
+    : data_names_and_return_codes(std::move(other.data_names_and_return_codes)) {}
+
+DataNamesAndReturnCodes& DataNamesAndReturnCodes::operator=(DataNamesAndReturnCodes other) {
+  swap(*this, other);
+  return *this;
+}
+
+DataNamesAndReturnCodes::DataNamesAndReturnCodes(const std::string& serialised_copy)
+    : data_names_and_return_codes() {
+  protobuf::DataNamesAndReturnCodes proto_copy;
+  if (!proto_copy.ParseFromString(serialised_copy))
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  data_names_and_return_codes.reserve(proto_copy.data_names_and_return_codes_size());
+  for (int index(0); index < proto_copy.data_names_and_return_codes_size(); ++index) {
+    const auto& proto_item(proto_copy.data_names_and_return_codes(index));
+    data_names_and_return_codes.emplace_back(
+        nfs_vault::DataName(proto_item.serialised_name()),
+        ReturnCode(proto_item.serialised_return_code()));
+  }
+}
+
+std::string DataNamesAndReturnCodes::Serialise() const {
+  protobuf::DataNamesAndReturnCodes proto_copy;
+  for (const auto& item : data_names_and_return_codes) {
+    auto proto_item(proto_copy.add_data_names_and_return_codes());
+    proto_item->set_serialised_name(item.name.Serialise());
+    proto_item->set_serialised_return_code(item.return_code.Serialise());
+  }
+  return proto_copy.SerializeAsString();
+}
+
+bool operator==(const DataNamesAndReturnCodes& lhs, const DataNamesAndReturnCodes& rhs) {
+  return lhs.data_names_and_return_codes == rhs.data_names_and_return_codes;
+}
+
+void swap(DataNamesAndReturnCodes& lhs, DataNamesAndReturnCodes& rhs) MAIDSAFE_NOEXCEPT {
+  using std::swap;
+  swap(lhs.data_names_and_return_codes, rhs.data_names_and_return_codes);
+}
+
 //============================ DataNameAndSizeAndReturnCode =======================================
 DataNameAndSizeAndReturnCode::DataNameAndSizeAndReturnCode() : name(), size(), return_code() {}
 
@@ -755,7 +807,7 @@ namespace nfs {
 
 template <>
 bool IsSuccess<nfs_client::ReturnCode>(const nfs_client::ReturnCode& response) {
-  LOG(kVerbose) << "IsSuccess<nfs_client::ReturnCode> return_code " << response.value.what();
+  NFS_LOG(kVerbose) << "IsSuccess<nfs_client::ReturnCode> return_code " << response.value.what();
   return response.value.code().value() == static_cast<int>(CommonErrors::success);
 }
 
@@ -768,8 +820,8 @@ template <>
 bool IsSuccess<nfs_client::DataNameAndContentOrReturnCode>(
     const nfs_client::DataNameAndContentOrReturnCode& response) {
   if (response.content) {
-    LOG(kVerbose) << "IsSuccess<nfs_client::nfs_client::DataNameAndContentOrReturnCode> "
-                  << " data fetched, data_name_and_return_code not initialized";
+    NFS_LOG(kVerbose) << "IsSuccess<nfs_client::nfs_client::DataNameAndContentOrReturnCode> "
+                      << " data fetched, data_name_and_return_code not initialized";
   } else {
     if (response.return_code) {
       LOG(kWarning)
@@ -799,8 +851,9 @@ template <>
 bool IsSuccess<nfs_client::StructuredDataNameAndContentOrReturnCode>(
     const nfs_client::StructuredDataNameAndContentOrReturnCode& response) {
   if (response.structured_data) {
-    LOG(kVerbose) << "IsSuccess<nfs_client::nfs_client::StructuredDataNameAndContentOrReturnCode> "
-                  << " structured_data fetched, data_name_and_return_code not initialized";
+    NFS_LOG(kVerbose)
+        << "IsSuccess<nfs_client::nfs_client::StructuredDataNameAndContentOrReturnCode> "
+        << " structured_data fetched, data_name_and_return_code not initialized";
   } else {
     if (response.data_name_and_return_code)
       LOG(kWarning) << "IsSuccess<nfs_client::nfs_client::StructuredDataNameAndContentOrReturnCode>"
@@ -23,42 +23,60 @@
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/make_unique.h"
 
+#include "maidsafe/nfs/log.h"
+
 namespace maidsafe {
 
 namespace nfs_client {
 
-std::shared_ptr<MpidClient> MpidClient::MakeShared(const passport::Mpid& mpid) {
-  std::shared_ptr<MpidClient> mpid_node_ptr{ new MpidClient{ mpid } };
+std::shared_ptr<MpidClient> MpidClient::MakeShared(
+    const passport::Mpid& mpid, const boost::filesystem::path& public_key_cache_path) {
+  std::shared_ptr<MpidClient> mpid_node_ptr{ new MpidClient{ mpid, public_key_cache_path } };
   mpid_node_ptr->Init();
   return mpid_node_ptr;
 }
 
 std::shared_ptr<MpidClient> MpidClient::MakeShared(
-    const passport::MpidAndSigner& mpid_and_signer) {
-  std::shared_ptr<MpidClient> mpid_node_ptr{ new MpidClient{ mpid_and_signer.first } };
+    const passport::MpidAndSigner& mpid_and_signer,
+    const boost::filesystem::path& public_key_cache_path) {
+  std::shared_ptr<MpidClient> mpid_node_ptr{
+      new MpidClient{ mpid_and_signer.first, public_key_cache_path } };
   mpid_node_ptr->Init(mpid_and_signer);
   return mpid_node_ptr;
 }
 
-MpidClient::MpidClient(const passport::Mpid& mpid)
+MpidClient::MpidClient(const passport::Mpid& mpid,
+                       const boost::filesystem::path& public_key_cache_path)
     : kMpid_(mpid),
+      kPublicKeyCachePath_(public_key_cache_path),
       asio_service_(2),
       rpc_timers_(asio_service_),
       network_health_mutex_(),
       network_health_condition_variable_(),
       network_health_(-1),
       network_health_change_signal_(),
+      public_key_cache_([this](const NodeId& node_id, routing::GivePublicKeyFunctor give_key) {
+        get_handler_.Get(passport::PublicPmid::Name{ Identity{ node_id.string() } },
+                         [give_key](const DataNameAndContentOrReturnCode& result) {
+                           give_key(PublicPmidKey(result));
+                         },
+                         std::chrono::seconds(10));
+      }),
       routing_(maidsafe::make_unique<routing::Routing>(kMpid_)),
-      public_pmid_helper_(),
       dispatcher_(*routing_),
       get_handler_(rpc_timers_.get_timer, dispatcher_),
       service_([&]()->std::unique_ptr<MpidNodeService> {
         std::unique_ptr<MpidNodeService> service(
           new MpidNodeService(routing::SingleId(routing_->kNodeId()), rpc_timers_, get_handler_));
         return std::move(service);
-      }()) {}
+      }()) {
+  if (!kPublicKeyCachePath_.empty())
+    public_key_cache_.Load(kPublicKeyCachePath_, kMpid_.public_key());
+}
 
 void MpidClient::Stop() {
+  if (!kPublicKeyCachePath_.empty())
+    public_key_cache_.Save(kPublicKeyCachePath_, kMpid_.private_key());
   dispatcher_.Stop();
   routing_.reset();
   rpc_timers_.CancellAll();
@@ -87,7 +105,8 @@ boost::future<void> MpidClient::SendMessage(const nfs_vault::MpidMessage& mpid_m
         op_data->HandleResponseContents(std::move(send_message_response));
       },
       routing::Parameters::group_size - 1, task_id);
-  rpc_timers_.send_message_timer.PrintTaskIds();
+  if (NFS_LOG_ENABLED(kVerbose))
+    rpc_timers_.send_message_timer.PrintTaskIds();
   dispatcher_.SendMessageRequest(task_id, mpid_message);
   return promise->get_future();
 }
@@ -115,7 +134,8 @@ boost::future<typename nfs_vault::MpidMessage> MpidClient::GetMessage(
         op_data->HandleResponseContents(std::move(get_message_response));
       },
       routing::Parameters::group_size - 1, task_id);
-  rpc_timers_.get_message_timer.PrintTaskIds();
+  if (NFS_LOG_ENABLED(kVerbose))
+    rpc_timers_.get_message_timer.PrintTaskIds();
   dispatcher_.GetMessageRequest(task_id, mpid_message_alert);
   return promise->get_future();
 }
@@ -194,9 +214,7 @@ routing::Functors MpidClient::InitialiseRoutingCallbacks() {
   functors.close_nodes_change = [](std::shared_ptr<routing::CloseNodesChange> /*close_change*/) {};
   functors.request_public_key = [this_ptr](const NodeId& node_id,
                                        const routing::GivePublicKeyFunctor& give_key) {
-    auto future_key(this_ptr->Get(passport::PublicPmid::Name{ Identity{ node_id.string() } },
-                                        std::chrono::seconds(10)));
-    this_ptr->public_pmid_helper_.AddEntry(std::move(future_key), give_key);
+    this_ptr->public_key_cache_.GetKey(node_id, give_key);
   };
 
   functors.typed_message_and_caching.single_to_group.message_received =
@@ -23,16 +23,14 @@ namespace maidsafe {
 namespace nfs_client {
 
 MpidNodeDispatcher::MpidNodeDispatcher(routing::Routing& routing)
-    : running_(true),
-      running_mutex_(),
+    : send_gate_(),
       routing_(routing),
       kThisNodeAsSender_(routing_.kNodeId()),
       kMpidManagerReceiver_(routing_.kNodeId()) {}
 
 
 void MpidNodeDispatcher::Stop() {
-  std::lock_guard<std::mutex> lock(running_mutex_);
-  running_ = false;
+  send_gate_.Stop();
   LOG(kWarning) << " MpidNodeDispatcher::Stop() !";
 }
 
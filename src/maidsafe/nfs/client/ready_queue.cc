@@ -0,0 +1,70 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/client/ready_queue.h"
+
+#include "boost/exception/diagnostic_information.hpp"
+
+#include "maidsafe/common/log.h"
+
+namespace maidsafe {
+
+namespace nfs_client {
+
+ReadyQueue::ReadyQueue() : released_(false), mutex_(), releasing_(false), held_() {}
+
+void ReadyQueue::Release() {
+  std::vector<std::function<void()>> held;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (releasing_ || released_.load(std::memory_order_relaxed))
+      return;
+    releasing_ = true;
+  }
+  // Requests made while the held ones are running are appended to 'held_' and picked up by the
+  // next pass, so they can't overtake any made before them.
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (held_.empty()) {
+        released_.store(true, std::memory_order_release);
+        releasing_ = false;
+        return;
+      }
+      held.swap(held_);
+    }
+    for (auto& request : held) {
+      try {
+        request();
+      }
+      catch (const std::exception& e) {
+        LOG(kError) << "Held request failed: " << boost::diagnostic_information(e);
+      }
+    }
+    held.clear();
+  }
+}
+
+void ReadyQueue::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  held_.clear();
+}
+
+}  // namespace nfs_client
+
+}  // namespace maidsafe
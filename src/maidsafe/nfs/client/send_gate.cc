@@ -0,0 +1,57 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/client/send_gate.h"
+
+namespace maidsafe {
+
+namespace nfs_client {
+
+namespace {
+
+const uint64_t kStopped(1), kSender(2);
+
+}  // unnamed namespace
+
+SendGate::SendGate() : state_(0), mutex_(), condition_() {}
+
+bool SendGate::Enter() {
+  if ((state_.fetch_add(kSender) & kStopped) == 0)
+    return true;
+  Leave();
+  return false;
+}
+
+void SendGate::Leave() {
+  // Only the last sender out of a stopped gate needs to wake 'Stop'.  Taking the mutex before
+  // notifying ensures 'Stop' is either already waiting or has yet to check the state.
+  if (state_.fetch_sub(kSender) == (kStopped | kSender)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    condition_.notify_all();
+  }
+}
+
+void SendGate::Stop() {
+  state_.fetch_or(kStopped);
+  std::unique_lock<std::mutex> lock(mutex_);
+  condition_.wait(lock, [this] { return state_ == kStopped; });
+}
+
+}  // namespace nfs_client
+
+}  // namespace maidsafe
@@ -17,10 +17,35 @@
     use of the MaidSafe Software.                                                                 */
 #include "maidsafe/nfs/detail/disk_backend.h"
 
+#include <cassert>
+#include <utility>
+
 namespace maidsafe {
 namespace nfs {
 namespace detail {
 
+DiskBackend::DiskBackend(const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+                         StorageEngineType engine_type, Durability durability,
+                         const std::chrono::steady_clock::duration& commit_window)
+  : Network::Interface(),
+    backend_(MakeStorageEngine(engine_type, disk_path, max_disk_usage, durability,
+                               commit_window)) {
+}
+
+DiskBackend::DiskBackend(const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+                         Durability durability,
+                         const std::chrono::steady_clock::duration& commit_window)
+  : Network::Interface(),
+    backend_(MakeStorageEngine(StorageEngineType::kFilesystem, disk_path, max_disk_usage,
+                               durability, commit_window)) {
+}
+
+DiskBackend::DiskBackend(std::unique_ptr<StorageEngine> engine)
+  : Network::Interface(),
+    backend_(std::move(engine)) {
+  assert(backend_ != nullptr);
+}
+
 DiskBackend::~DiskBackend() {}
 
 boost::future<void> DiskBackend::DoCreateSDV(
@@ -28,32 +53,32 @@ boost::future<void> DiskBackend::DoCreateSDV(
     const ContainerVersion& initial_version,
     std::uint32_t max_versions,
     std::uint32_t max_branches) {
-  return backend_.CreateVersionTree(container_id.data, initial_version, max_versions, max_branches);
+  return backend_->CreateVersions(container_id, initial_version, max_versions, max_branches);
 }
 
 boost::future<void> DiskBackend::DoPutSDVVersion(
     const ContainerId& container_id,
     const ContainerVersion& old_version,
     const ContainerVersion& new_version) {
-  return backend_.PutVersion(container_id.data, old_version, new_version);
+  return backend_->PutVersion(container_id, old_version, new_version);
 }
 
 boost::future<std::vector<ContainerVersion>> DiskBackend::DoGetBranches(
     const ContainerId& container_id) {
-  return backend_.GetVersions(container_id.data);
+  return backend_->GetVersions(container_id);
 }
 
 boost::future<std::vector<ContainerVersion>> DiskBackend::DoGetBranchVersions(
     const ContainerId& container_id, const ContainerVersion& tip) {
-  return backend_.GetBranch(container_id.data, tip);
+  return backend_->GetBranch(container_id, tip);
 }
 
 boost::future<void> DiskBackend::DoPutChunk(const ImmutableData& data) {
-  return backend_.Put(data);
+  return backend_->PutChunk(data);
 }
 
 boost::future<ImmutableData> DiskBackend::DoGetChunk(const ImmutableData::Name& name) {
-  return backend_.Get(name);
+  return backend_->GetChunk(name);
 }
 
 }  // namespace detail
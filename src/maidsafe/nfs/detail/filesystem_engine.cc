@@ -0,0 +1,94 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/detail/filesystem_engine.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+FilesystemEngine::FilesystemEngine(const boost::filesystem::path& disk_path,
+                                   DiskUsage max_disk_usage, FakeStore::Durability durability,
+                                   const std::chrono::steady_clock::duration& commit_window)
+  : StorageEngine(),
+    store_(disk_path, max_disk_usage, durability, commit_window) {
+}
+
+FilesystemEngine::~FilesystemEngine() {}
+
+std::uint32_t FilesystemEngine::Capabilities() const {
+  return kPersistent | kDeferredCollection | kEviction | kScrubbing | kArchiving;
+}
+
+boost::future<void> FilesystemEngine::PutChunk(const ImmutableData& data) {
+  return store_.Put(data);
+}
+
+boost::future<ImmutableData> FilesystemEngine::GetChunk(const ImmutableData::Name& name) {
+  return store_.Get(name);
+}
+
+boost::future<void> FilesystemEngine::DeleteChunk(const ImmutableData::Name& name) {
+  return store_.Delete(name);
+}
+
+void FilesystemEngine::IncrementReferenceCount(const std::vector<ImmutableData::Name>& names) {
+  store_.IncrementReferenceCount(names);
+}
+
+void FilesystemEngine::DecrementReferenceCount(const std::vector<ImmutableData::Name>& names) {
+  store_.DecrementReferenceCount(names);
+}
+
+boost::future<void> FilesystemEngine::CreateVersions(
+    const ContainerId& container_id,
+    const ContainerVersion& initial_version,
+    std::uint32_t max_versions,
+    std::uint32_t max_branches) {
+  return store_.CreateVersionTree(container_id.data, initial_version, max_versions, max_branches);
+}
+
+boost::future<void> FilesystemEngine::PutVersion(
+    const ContainerId& container_id,
+    const ContainerVersion& old_version,
+    const ContainerVersion& new_version) {
+  return store_.PutVersion(container_id.data, old_version, new_version);
+}
+
+boost::future<std::vector<ContainerVersion>> FilesystemEngine::GetVersions(
+    const ContainerId& container_id) {
+  return store_.GetVersions(container_id.data);
+}
+
+boost::future<std::vector<ContainerVersion>> FilesystemEngine::GetBranch(
+    const ContainerId& container_id, const ContainerVersion& tip) {
+  return store_.GetBranch(container_id.data, tip);
+}
+
+boost::future<void> FilesystemEngine::DeleteBranchUntilFork(
+    const ContainerId& container_id, const ContainerVersion& tip) {
+  return store_.DeleteBranchUntilFork(container_id.data, tip);
+}
+
+DiskUsage FilesystemEngine::GetCurrentDiskUsage() const {
+  return store_.GetCurrentDiskUsage();
+}
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
@@ -0,0 +1,487 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/detail/log_engine.h"
+
+#include <utility>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/log.h"
+#include "maidsafe/common/make_unique.h"
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/nfs/log.h"
+
+namespace fs = boost::filesystem;
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+namespace {
+
+// Each record is a type byte, then the key size, reference count and value size as 32-bit
+// little-endian integers, then the key and the value.
+const std::size_t kRecordHeaderSize(13);
+const std::uint64_t kMinCompactionSize(1 << 20);
+
+void AppendInteger(std::string& buffer, std::uint32_t value) {
+  for (int i(0); i != 4; ++i)
+    buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+std::uint32_t ParseInteger(const char* bytes) {
+  std::uint32_t value(0);
+  for (int i(3); i >= 0; --i)
+    value = (value << 8) | static_cast<unsigned char>(bytes[i]);
+  return value;
+}
+
+std::uint64_t RecordSize(const std::string& key, std::uint32_t value_size) {
+  return kRecordHeaderSize + key.size() + value_size;
+}
+
+template<typename Result>
+void SetValue(boost::promise<Result>& promise, const std::function<Result()>& operation) {
+  promise.set_value(operation());
+}
+
+void SetValue(boost::promise<void>& promise, const std::function<void()>& operation) {
+  operation();
+  promise.set_value();
+}
+
+}  // unnamed namespace
+
+LogEngine::LogEngine(const fs::path& disk_path, DiskUsage max_disk_usage)
+  : StorageEngine(),
+    kLogPath_(disk_path / "store.log"),
+    kMaxDiskUsage_(std::move(max_disk_usage)),
+    mutex_(),
+    log_(),
+    log_size_(0),
+    live_bytes_(0),
+    current_disk_usage_(0),
+    chunks_(),
+    versions_() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  boost::system::error_code error_code;
+  fs::create_directories(disk_path, error_code);
+  if (error_code) {
+    LOG(kError) << "Can't create " << disk_path << ": " << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  OpenLog();
+  Replay();
+  if (current_disk_usage_ > kMaxDiskUsage_)
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::cannot_exceed_limit));
+}
+
+LogEngine::~LogEngine() {}
+
+std::uint32_t LogEngine::Capabilities() const { return kPersistent | kSingleFile; }
+
+template<typename Result>
+boost::future<Result> LogEngine::Complete(const std::function<Result()>& operation) {
+  boost::promise<Result> promise;
+  auto future(promise.get_future());
+  try {
+    SetValue(promise, operation);
+  } catch (...) {
+    promise.set_exception(boost::current_exception());
+  }
+  return future;
+}
+
+boost::future<void> LogEngine::PutChunk(const ImmutableData& data) {
+  return Complete<void>([this, &data] {
+    const std::string key(data.name().value.string());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (chunks_.count(key) != 0) {
+      AddReference(key);
+      return;
+    }
+
+    const std::string value(data.Serialise().data.string());
+    if (current_disk_usage_.data + value.size() > kMaxDiskUsage_.data) {
+      LOG(kError) << "Out of space.";
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::cannot_exceed_limit));
+    }
+    Location location;
+    location.offset = Append(RecordType::kChunk, key, 1, value);
+    location.size = static_cast<std::uint32_t>(value.size());
+    location.reference_count = 1;
+    chunks_[key] = location;
+    live_bytes_ += RecordSize(key, location.size);
+    current_disk_usage_.data += location.size;
+    CompactIfWorthwhile();
+  });
+}
+
+boost::future<ImmutableData> LogEngine::GetChunk(const ImmutableData::Name& name) {
+  return Complete<ImmutableData>([this, &name]() -> ImmutableData {
+    std::string value;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto found(chunks_.find(name.value.string()));
+      if (found == std::end(chunks_))
+        BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+      value = Read(found->second);
+    }
+    return ImmutableData(name, ImmutableData::serialised_type(NonEmptyString(value)));
+  });
+}
+
+boost::future<void> LogEngine::DeleteChunk(const ImmutableData::Name& name) {
+  return Complete<void>([this, &name] {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ReleaseReference(name.value.string());
+    CompactIfWorthwhile();
+  });
+}
+
+void LogEngine::IncrementReferenceCount(const std::vector<ImmutableData::Name>& names) {
+  try {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& name : names)
+      AddReference(name.value.string());
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "IncrementReferenceCount failed: " << boost::diagnostic_information(e);
+  }
+}
+
+void LogEngine::DecrementReferenceCount(const std::vector<ImmutableData::Name>& names) {
+  try {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& name : names)
+      ReleaseReference(name.value.string());
+    CompactIfWorthwhile();
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "DecrementReferenceCount failed: " << boost::diagnostic_information(e);
+  }
+}
+
+boost::future<void> LogEngine::CreateVersions(
+    const ContainerId& container_id,
+    const ContainerVersion& initial_version,
+    std::uint32_t max_versions,
+    std::uint32_t max_branches) {
+  return Complete<void>([&] {
+    StructuredDataVersions versions(max_versions, max_branches);
+    versions.Put(ContainerVersion(), initial_version);
+    const std::string key(container_id.data.value.string());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (versions_.count(key) != 0)
+      BOOST_THROW_EXCEPTION(MakeError(VaultErrors::data_already_exists));
+    WriteVersions(key, versions);
+  });
+}
+
+boost::future<void> LogEngine::PutVersion(
+    const ContainerId& container_id,
+    const ContainerVersion& old_version,
+    const ContainerVersion& new_version) {
+  return Complete<void>([&] {
+    const std::string key(container_id.data.value.string());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto versions(ReadVersions(key));
+    if (!versions)
+      BOOST_THROW_EXCEPTION(MakeError(VaultErrors::no_such_account));
+    versions->Put(old_version, new_version);
+    WriteVersions(key, *versions);
+    CompactIfWorthwhile();
+  });
+}
+
+boost::future<std::vector<ContainerVersion>> LogEngine::GetVersions(
+    const ContainerId& container_id) {
+  return Complete<std::vector<ContainerVersion>>([&]() -> std::vector<ContainerVersion> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto versions(ReadVersions(container_id.data.value.string()));
+    if (!versions)
+      BOOST_THROW_EXCEPTION(MakeError(VaultErrors::no_such_account));
+    return versions->Get();
+  });
+}
+
+boost::future<std::vector<ContainerVersion>> LogEngine::GetBranch(
+    const ContainerId& container_id, const ContainerVersion& tip) {
+  return Complete<std::vector<ContainerVersion>>([&]() -> std::vector<ContainerVersion> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto versions(ReadVersions(container_id.data.value.string()));
+    if (!versions)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+    return versions->GetBranch(tip);
+  });
+}
+
+boost::future<void> LogEngine::DeleteBranchUntilFork(
+    const ContainerId& container_id, const ContainerVersion& tip) {
+  return Complete<void>([&] {
+    const std::string key(container_id.data.value.string());
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto versions(ReadVersions(key));
+    if (!versions)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+    versions->DeleteBranchUntilFork(tip);
+    WriteVersions(key, *versions);
+    CompactIfWorthwhile();
+  });
+}
+
+DiskUsage LogEngine::GetCurrentDiskUsage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return current_disk_usage_;
+}
+
+void LogEngine::Compact() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DoCompact();
+}
+
+std::uint64_t LogEngine::GetLogSize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return log_size_;
+}
+
+void LogEngine::OpenLog() {
+  if (!fs::exists(kLogPath_))
+    std::ofstream create(kLogPath_.string(), std::ios::out | std::ios::binary);
+  log_.open(kLogPath_.string(), std::ios::in | std::ios::out | std::ios::binary);
+  if (!log_) {
+    LOG(kError) << "Can't open " << kLogPath_;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+}
+
+void LogEngine::Replay() {
+  const std::uint64_t file_size(fs::file_size(kLogPath_));
+  std::uint64_t offset(0);
+  std::string header(kRecordHeaderSize, 0);
+  log_.seekg(0);
+  while (offset + kRecordHeaderSize <= file_size) {
+    if (!log_.read(&header[0], kRecordHeaderSize))
+      break;
+    const std::uint32_t key_size(ParseInteger(&header[1]));
+    const std::uint32_t reference_count(ParseInteger(&header[5]));
+    const std::uint32_t value_size(ParseInteger(&header[9]));
+    const std::uint64_t value_offset(offset + kRecordHeaderSize + key_size);
+    const auto type(static_cast<unsigned char>(header[0]));
+    if (type > static_cast<unsigned char>(RecordType::kVersions) ||
+        value_offset + value_size > file_size) {
+      break;
+    }
+    std::string key(key_size, 0);
+    if (key_size != 0 && !log_.read(&key[0], key_size))
+      break;
+    log_.seekg(value_size, std::ios::cur);
+
+    Location location;
+    location.offset = value_offset;
+    location.size = value_size;
+    location.reference_count = reference_count;
+    switch (static_cast<RecordType>(type)) {
+      case RecordType::kChunk:
+        chunks_[key] = location;
+        live_bytes_ += RecordSize(key, value_size);
+        current_disk_usage_.data += value_size;
+        break;
+      case RecordType::kReferenceCount: {
+        const auto found(chunks_.find(key));
+        if (found == std::end(chunks_))
+          break;
+        if (reference_count == 0) {
+          live_bytes_ -= RecordSize(key, found->second.size);
+          current_disk_usage_.data -= found->second.size;
+          chunks_.erase(found);
+        } else {
+          found->second.reference_count = reference_count;
+        }
+        break;
+      }
+      case RecordType::kVersions: {
+        const auto found(versions_.find(key));
+        if (found != std::end(versions_)) {
+          live_bytes_ -= RecordSize(key, found->second.size);
+          current_disk_usage_.data -= found->second.size;
+        }
+        versions_[key] = location;
+        live_bytes_ += RecordSize(key, value_size);
+        current_disk_usage_.data += value_size;
+        break;
+      }
+    }
+    offset = value_offset + value_size;
+  }
+
+  log_.clear();
+  if (offset != file_size) {
+    LOG(kWarning) << "Discarding " << file_size - offset << " bytes of incomplete record from "
+                  << kLogPath_;
+    log_.close();
+    fs::resize_file(kLogPath_, offset);
+    OpenLog();
+  }
+  log_size_ = offset;
+}
+
+std::uint64_t LogEngine::Append(RecordType type, const std::string& key,
+                                std::uint32_t reference_count, const std::string& value) {
+  std::string record;
+  record.reserve(RecordSize(key, static_cast<std::uint32_t>(value.size())));
+  record.push_back(static_cast<char>(type));
+  AppendInteger(record, static_cast<std::uint32_t>(key.size()));
+  AppendInteger(record, reference_count);
+  AppendInteger(record, static_cast<std::uint32_t>(value.size()));
+  record += key;
+  record += value;
+
+  log_.seekp(log_size_);
+  log_.write(record.data(), record.size());
+  log_.flush();
+  if (!log_) {
+    log_.clear();
+    LOG(kError) << "Failed to append to " << kLogPath_;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  const std::uint64_t value_offset(log_size_ + kRecordHeaderSize + key.size());
+  log_size_ += record.size();
+  return value_offset;
+}
+
+std::string LogEngine::Read(const Location& location) const {
+  std::string value(location.size, 0);
+  log_.seekg(location.offset);
+  if (!log_.read(&value[0], location.size)) {
+    log_.clear();
+    LOG(kError) << "Failed to read from " << kLogPath_;
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  return value;
+}
+
+std::unique_ptr<StructuredDataVersions> LogEngine::ReadVersions(const std::string& key) const {
+  const auto found(versions_.find(key));
+  if (found == std::end(versions_))
+    return std::unique_ptr<StructuredDataVersions>();
+  return maidsafe::make_unique<StructuredDataVersions>(
+      StructuredDataVersions::serialised_type(NonEmptyString(Read(found->second))));
+}
+
+void LogEngine::WriteVersions(const std::string& key, const StructuredDataVersions& versions) {
+  const std::string value(versions.Serialise().data.string());
+  const auto found(versions_.find(key));
+  const std::uint64_t replaced_size(found == std::end(versions_) ? 0 : found->second.size);
+  if (current_disk_usage_.data - replaced_size + value.size() > kMaxDiskUsage_.data) {
+    LOG(kError) << "Out of space.";
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::cannot_exceed_limit));
+  }
+  Location location;
+  location.offset = Append(RecordType::kVersions, key, 1, value);
+  location.size = static_cast<std::uint32_t>(value.size());
+  location.reference_count = 1;
+  if (found != std::end(versions_))
+    live_bytes_ -= RecordSize(key, found->second.size);
+  versions_[key] = location;
+  live_bytes_ += RecordSize(key, location.size);
+  current_disk_usage_.data = current_disk_usage_.data - replaced_size + location.size;
+}
+
+void LogEngine::AddReference(const std::string& key) {
+  const auto found(chunks_.find(key));
+  if (found == std::end(chunks_))
+    return;
+  Append(RecordType::kReferenceCount, key, found->second.reference_count + 1, std::string());
+  ++found->second.reference_count;
+}
+
+void LogEngine::ReleaseReference(const std::string& key) {
+  const auto found(chunks_.find(key));
+  if (found == std::end(chunks_)) {
+    LOG(kWarning) << HexSubstr(key) << " already deleted.";
+    return;
+  }
+  Append(RecordType::kReferenceCount, key, found->second.reference_count - 1, std::string());
+  if (--found->second.reference_count == 0) {
+    live_bytes_ -= RecordSize(key, found->second.size);
+    current_disk_usage_.data -= found->second.size;
+    chunks_.erase(found);
+  }
+}
+
+void LogEngine::CompactIfWorthwhile() {
+  if (log_size_ >= kMinCompactionSize && log_size_ - live_bytes_ > live_bytes_)
+    DoCompact();
+}
+
+void LogEngine::DoCompact() {
+  const fs::path compacted_path(kLogPath_.string() + ".compact");
+  std::uint64_t compacted_size(0);
+  Index compacted_chunks, compacted_versions;
+  {
+    std::ofstream compacted(compacted_path.string(),
+                            std::ios::out | std::ios::binary | std::ios::trunc);
+    auto copy([&](RecordType type, const Index& from, Index& to) {
+      for (const auto& entry : from) {
+        std::string record;
+        record.push_back(static_cast<char>(type));
+        AppendInteger(record, static_cast<std::uint32_t>(entry.first.size()));
+        AppendInteger(record, entry.second.reference_count);
+        AppendInteger(record, entry.second.size);
+        record += entry.first;
+        record += Read(entry.second);
+        compacted.write(record.data(), record.size());
+
+        Location location(entry.second);
+        location.offset = compacted_size + kRecordHeaderSize + entry.first.size();
+        to[entry.first] = location;
+        compacted_size += record.size();
+      }
+    });
+    copy(RecordType::kChunk, chunks_, compacted_chunks);
+    copy(RecordType::kVersions, versions_, compacted_versions);
+    compacted.flush();
+    if (!compacted) {
+      LOG(kError) << "Failed to write " << compacted_path;
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+    }
+  }
+
+  log_.close();
+  boost::system::error_code error_code;
+  fs::rename(compacted_path, kLogPath_, error_code);
+  OpenLog();
+  if (error_code) {
+    LOG(kError) << "Failed to replace " << kLogPath_ << ": " << error_code.message();
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::filesystem_io_error));
+  }
+  NFS_LOG(kVerbose) << "Compacted " << kLogPath_ << " from " << log_size_ << " to "
+                    << compacted_size << " bytes.";
+  chunks_.swap(compacted_chunks);
+  versions_.swap(compacted_versions);
+  log_size_ = compacted_size;
+  live_bytes_ = compacted_size;
+}
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
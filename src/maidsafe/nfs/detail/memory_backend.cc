@@ -0,0 +1,174 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/detail/memory_backend.h"
+
+#include <thread>
+#include <utility>
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/make_unique.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+namespace {
+template<typename Result>
+void SetValue(boost::promise<Result>& promise, const std::function<Result()>& operation) {
+  promise.set_value(operation());
+}
+
+void SetValue(boost::promise<void>& promise, const std::function<void()>& operation) {
+  operation();
+  promise.set_value();
+}
+}  // namespace
+
+MemoryBackend::MemoryBackend()
+  : Network::Interface(),
+    executor_(),
+    latency_(std::chrono::steady_clock::duration::zero()),
+    chunks_(),
+    sdvs_() {
+}
+
+MemoryBackend::MemoryBackend(Executor executor, std::chrono::steady_clock::duration latency)
+  : Network::Interface(),
+    executor_(std::move(executor)),
+    latency_(std::move(latency)),
+    chunks_(),
+    sdvs_() {
+}
+
+MemoryBackend::~MemoryBackend() {}
+
+template<typename Value>
+MemoryBackend::Shard<Value>& MemoryBackend::GetShard(
+    ShardedMap<Value>& map, const std::string& key) {
+  // Keys are hashes already, so the leading byte spreads evenly across shards
+  return map[key.empty() ? 0 : static_cast<unsigned char>(key[0]) % map.size()];
+}
+
+template<typename Result>
+boost::future<Result> MemoryBackend::Complete(std::function<Result()> operation) {
+  const auto promise(std::make_shared<boost::promise<Result>>());
+  auto future(promise->get_future());
+  const auto latency(latency_);
+  auto task([promise, operation, latency] {
+    if (latency != std::chrono::steady_clock::duration::zero())
+      std::this_thread::sleep_for(latency);
+    try {
+      SetValue(*promise, operation);
+    } catch (...) {
+      promise->set_exception(boost::current_exception());
+    }
+  });
+
+  if (executor_) {
+    executor_(std::move(task));
+  } else {
+    task();
+  }
+  return future;
+}
+
+boost::future<void> MemoryBackend::DoCreateSDV(
+    const ContainerId& container_id,
+    const ContainerVersion& initial_version,
+    std::uint32_t max_versions,
+    std::uint32_t max_branches) {
+  return Complete<void>([this, container_id, initial_version, max_versions, max_branches] {
+    auto versions(maidsafe::make_unique<StructuredDataVersions>(max_versions, max_branches));
+    versions->Put(ContainerVersion(), initial_version);
+
+    const std::string key(container_id.data.value.string());
+    auto& shard(GetShard(sdvs_, key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.values.emplace(key, std::move(versions)).second)
+      BOOST_THROW_EXCEPTION(MakeError(VaultErrors::data_already_exists));
+  });
+}
+
+boost::future<void> MemoryBackend::DoPutSDVVersion(
+    const ContainerId& container_id,
+    const ContainerVersion& old_version,
+    const ContainerVersion& new_version) {
+  return Complete<void>([this, container_id, old_version, new_version] {
+    const std::string key(container_id.data.value.string());
+    auto& shard(GetShard(sdvs_, key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found(shard.values.find(key));
+    if (found == shard.values.end())
+      BOOST_THROW_EXCEPTION(MakeError(VaultErrors::no_such_account));
+    found->second->Put(old_version, new_version);
+  });
+}
+
+boost::future<std::vector<ContainerVersion>> MemoryBackend::DoGetBranches(
+    const ContainerId& container_id) {
+  return Complete<std::vector<ContainerVersion>>(
+      [this, container_id]() -> std::vector<ContainerVersion> {
+    const std::string key(container_id.data.value.string());
+    auto& shard(GetShard(sdvs_, key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found(shard.values.find(key));
+    if (found == shard.values.end())
+      BOOST_THROW_EXCEPTION(MakeError(VaultErrors::no_such_account));
+    return found->second->Get();
+  });
+}
+
+boost::future<std::vector<ContainerVersion>> MemoryBackend::DoGetBranchVersions(
+    const ContainerId& container_id, const ContainerVersion& tip) {
+  return Complete<std::vector<ContainerVersion>>(
+      [this, container_id, tip]() -> std::vector<ContainerVersion> {
+    const std::string key(container_id.data.value.string());
+    auto& shard(GetShard(sdvs_, key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found(shard.values.find(key));
+    if (found == shard.values.end())
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+    return found->second->GetBranch(tip);
+  });
+}
+
+boost::future<void> MemoryBackend::DoPutChunk(const ImmutableData& data) {
+  return Complete<void>([this, data] {
+    const std::string key(data.name().value.string());
+    auto& shard(GetShard(chunks_, key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.values.emplace(key, data);
+  });
+}
+
+boost::future<ImmutableData> MemoryBackend::DoGetChunk(const ImmutableData::Name& name) {
+  return Complete<ImmutableData>([this, name]() -> ImmutableData {
+    const std::string key(name.value.string());
+    auto& shard(GetShard(chunks_, key));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const auto found(shard.values.find(key));
+    if (found == shard.values.end())
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::no_such_element));
+    return found->second;
+  });
+}
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
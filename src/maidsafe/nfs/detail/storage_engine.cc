@@ -0,0 +1,48 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/detail/storage_engine.h"
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/make_unique.h"
+#include "maidsafe/nfs/detail/filesystem_engine.h"
+#include "maidsafe/nfs/detail/log_engine.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+
+StorageEngine::~StorageEngine() {}
+
+std::unique_ptr<StorageEngine> MakeStorageEngine(
+    StorageEngineType type, const boost::filesystem::path& disk_path, DiskUsage max_disk_usage,
+    Durability durability, const std::chrono::steady_clock::duration& commit_window) {
+  switch (type) {
+    case StorageEngineType::kFilesystem:
+      return maidsafe::make_unique<FilesystemEngine>(disk_path, max_disk_usage, durability,
+                                                     commit_window);
+    case StorageEngineType::kLog:
+      return maidsafe::make_unique<LogEngine>(disk_path, max_disk_usage);
+    default:
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::invalid_parameter));
+  }
+}
+
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
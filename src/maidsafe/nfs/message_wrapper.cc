@@ -18,15 +18,48 @@
 
 #include "maidsafe/nfs/message_wrapper.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+
 #include "maidsafe/common/error.h"
 #include "maidsafe/common/utils.h"
 
+#include "maidsafe/nfs/log.h"
 #include "maidsafe/nfs/message_wrapper.pb.h"
 
 namespace maidsafe {
 
 namespace nfs {
 
+namespace {
+
+const uint32_t kVarintWireType(0), kFixed64WireType(1), kLengthDelimitedWireType(2),
+    kFixed32WireType(5);
+const ptrdiff_t kMaxTagSize(5);
+// Bits 1 to 5, one per MessageWrapper field.
+const unsigned int kAllFieldsSeen(0x3E);
+
+bool ReadVarint(const char*& position, const char* end, uint64_t& value) {
+  value = 0;
+  for (int shift(0); shift < 64 && position != end; shift += 7) {
+    const auto byte(static_cast<uint8_t>(*position++));
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+void Skip(const char*& position, const char* end, size_t count) {
+  if (static_cast<size_t>(end - position) < count)
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  position += count;
+}
+
+}  // unnamed namespace
+
 namespace detail {
 
 MessageId GetNewMessageId() {
@@ -45,27 +78,106 @@ std::string SerialiseMessageWrapper(const TypeErasedMessageWrapper& message_tupl
   auto message_id(std::get<3>(message_tuple));
   proto_message_wrapper.set_message_id(message_id);
   proto_message_wrapper.set_serialised_contents(std::get<4>(message_tuple));
-  LOG(kVerbose) << "Message Wrapper created for message from persona "
-                << std::get<1>(message_tuple).data
-                << " to persona " << std::get<2>(message_tuple).data
-                << " for action " << std::get<0>(message_tuple)
-                << " with id " << message_id.data;
+  NFS_LOG(kVerbose) << "Message Wrapper created for message from persona "
+                    << std::get<1>(message_tuple).data
+                    << " to persona " << std::get<2>(message_tuple).data
+                    << " for action " << std::get<0>(message_tuple)
+                    << " with id " << message_id.data;
   return proto_message_wrapper.SerializeAsString();
 }
 
+// Field numbers from message_wrapper.proto.
+const int kSerialisedContentsField(5);
+
+SerialisedRope MessageWrapperHeader(MessageAction action, Persona source_persona,
+                                    Persona destination_persona, MessageId message_id) {
+  NFS_LOG(kVerbose) << "Message Wrapper created for message from persona " << source_persona
+                    << " to persona " << destination_persona << " for action " << action
+                    << " with id " << message_id.data;
+  SerialisedRope rope;
+  rope.AppendInt32Field(1, static_cast<int32_t>(action));
+  rope.AppendInt32Field(2, static_cast<int32_t>(source_persona));
+  rope.AppendInt32Field(3, static_cast<int32_t>(destination_persona));
+  rope.AppendInt32Field(4, message_id.data);
+  return rope;
+}
+
 }  // namespace detail
 
 TypeErasedMessageWrapper ParseMessageWrapper(const std::string& serialised_message_wrapper) {
-  protobuf::MessageWrapper proto_message_wrapper;
-  if (!proto_message_wrapper.ParseFromString(serialised_message_wrapper))
+  return ParseMessageWrapperView(serialised_message_wrapper).ToTypeErased();
+}
+
+MessageWrapperView::MessageWrapperView(MessageAction action_in, Persona source_persona_in,
+                                       Persona destination_persona_in, MessageId message_id_in,
+                                       boost::string_ref contents_in)
+    : action(action_in),
+      source_persona(source_persona_in),
+      destination_persona(destination_persona_in),
+      message_id(std::move(message_id_in)),
+      contents(contents_in) {}
+
+TypeErasedMessageWrapper MessageWrapperView::ToTypeErased() const {
+  return std::make_tuple(action, detail::SourceTaggedValue(source_persona),
+                         detail::DestinationTaggedValue(destination_persona), message_id,
+                         std::string(contents.data(), contents.size()));
+}
+
+MessageWrapperView ParseMessageWrapperView(const std::string& serialised_message_wrapper) {
+  // Decodes the protobuf wire format of message_wrapper.proto directly.  As with the protobuf
+  // parser, unknown fields (or known fields with an unexpected wire type) are skipped, repeated
+  // fields take the last value, and every required field must be present.
+  const char* position(serialised_message_wrapper.data());
+  const char* const end(position + serialised_message_wrapper.size());
+  int32_t header_fields[4] = {0, 0, 0, 0};
+  boost::string_ref contents;
+  unsigned int seen(0);
+  while (position != end) {
+    const char* const tag_start(position);
+    uint64_t value(0);
+    if (!ReadVarint(position, end, value) || position - tag_start > kMaxTagSize)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+    // Like protobuf, ignore any bits of the tag beyond the low 32.
+    const auto tag(static_cast<uint32_t>(value));
+    const uint32_t field_number(tag >> 3);
+    if (field_number == 0)
+      BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+    switch (tag & 7) {
+      case kVarintWireType:
+        if (!ReadVarint(position, end, value))
+          BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+        if (field_number <= 4) {
+          header_fields[field_number - 1] = static_cast<int32_t>(value);
+          seen |= 1 << field_number;
+        }
+        break;
+      case kFixed64WireType:
+        Skip(position, end, 8);
+        break;
+      case kLengthDelimitedWireType:
+        if (!ReadVarint(position, end, value) ||
+            value > static_cast<uint64_t>(end - position))
+          BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+        if (field_number == static_cast<uint32_t>(detail::kSerialisedContentsField)) {
+          contents = boost::string_ref(position, static_cast<size_t>(value));
+          seen |= 1 << field_number;
+        }
+        position += value;
+        break;
+      case kFixed32WireType:
+        Skip(position, end, 4);
+        break;
+      default:
+        BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+    }
+  }
+  if (seen != kAllFieldsSeen)
     BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
 
-  return std::make_tuple(
-      static_cast<MessageAction>(proto_message_wrapper.action()),
-      detail::SourceTaggedValue(static_cast<Persona>(proto_message_wrapper.source_persona())),
-      detail::DestinationTaggedValue(
-          static_cast<Persona>(proto_message_wrapper.destination_persona())),
-      MessageId(proto_message_wrapper.message_id()), proto_message_wrapper.serialised_contents());
+  return MessageWrapperView(static_cast<MessageAction>(header_fields[0]),
+                            static_cast<Persona>(header_fields[1]),
+                            static_cast<Persona>(header_fields[2]), MessageId(header_fields[3]),
+                            contents);
 }
 
 }  // namespace nfs
@@ -0,0 +1,240 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/public_key_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/utils.h"
+
+#include "maidsafe/nfs/log.h"
+#include "maidsafe/nfs/public_key_cache.pb.h"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace detail {
+
+namespace {
+
+int64_t SecondsSinceEpoch() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}  // unnamed namespace
+
+const size_t PublicKeyCache::kPruneThreshold;
+
+size_t PublicKeyCache::NodeIdHash::operator()(const NodeId& node_id) const {
+  // Node ids are uniformly distributed, so any of their bytes make a good hash.
+  const std::string id(node_id.string());
+  size_t hash(0);
+  std::memcpy(&hash, id.data(), std::min(sizeof(hash), id.size()));
+  return hash;
+}
+
+PublicKeyCache::PublicKeyCache(FetchFunctor fetch, std::chrono::steady_clock::duration ttl,
+                               std::chrono::steady_clock::duration negative_ttl)
+    : fetch_(std::move(fetch)),
+      kTtl_(ttl),
+      kNegativeTtl_(negative_ttl),
+      shards_(),
+      lookups_(0),
+      network_fetches_(0) {}
+
+void PublicKeyCache::GetKey(const NodeId& node_id, routing::GivePublicKeyFunctor give_key) {
+  ++lookups_;
+  auto& shard(GetShard(node_id));
+  {
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    const auto now(std::chrono::steady_clock::now());
+    auto& entry(shard.entries[node_id]);
+    if (now < entry.expiry) {
+      auto key(entry.key);
+      const bool revalidate(entry.loaded && !entry.fetching);
+      if (revalidate) {
+        entry.loaded = false;
+        entry.fetching = true;
+      }
+      lock.unlock();
+      NFS_LOG(kVerbose) << "Public key of " << DebugId(node_id) << " found in cache";
+      give_key(std::move(key));
+      if (revalidate)
+        Fetch(node_id);
+      return;
+    }
+    entry.waiters.push_back(std::move(give_key));
+    if (entry.fetching)
+      return;
+    entry.fetching = true;
+    Prune(shard, now);
+  }
+  Fetch(node_id);
+}
+
+PublicKeyCache::Statistics PublicKeyCache::statistics() const {
+  Statistics statistics = { lookups_.load(), network_fetches_.load() };
+  return statistics;
+}
+
+bool PublicKeyCache::Save(const boost::filesystem::path& path,
+                          const asymm::PrivateKey& private_key) {
+  protobuf::PublicKeyCache::Keys proto_keys;
+  const auto now(std::chrono::steady_clock::now());
+  const int64_t seconds_since_epoch(SecondsSinceEpoch());
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto& entry : shard.entries) {
+      if (!entry.second.key || entry.second.expiry <= now)
+        continue;
+      auto proto_key(proto_keys.add_keys());
+      proto_key->set_node_id(entry.first.string());
+      proto_key->set_encoded_public_key(asymm::EncodeKey(*entry.second.key).string());
+      proto_key->set_expiry(seconds_since_epoch +
+          std::chrono::duration_cast<std::chrono::seconds>(entry.second.expiry - now).count());
+    }
+  }
+
+  // Nothing is left to save, so keys saved previously mustn't be loaded again either.
+  if (proto_keys.keys_size() == 0) {
+    boost::system::error_code error_code;
+    boost::filesystem::remove(path, error_code);
+    if (!error_code)
+      return true;
+    LOG(kError) << "Failed to remove " << path << ": " << error_code.message();
+    return false;
+  }
+  try {
+    protobuf::PublicKeyCache proto_cache;
+    proto_cache.set_serialised_keys(proto_keys.SerializeAsString());
+    proto_cache.set_signature(
+        asymm::Sign(asymm::PlainText(proto_cache.serialised_keys()), private_key).string());
+    if (WriteFile(path, proto_cache.SerializeAsString())) {
+      NFS_LOG(kInfo) << "Saved " << proto_keys.keys_size() << " public keys to " << path;
+      return true;
+    }
+  }
+  catch (const std::exception& e) {
+    LOG(kError) << "Failed to sign public keys: " << boost::diagnostic_information(e);
+  }
+  LOG(kError) << "Failed to save public keys to " << path;
+  return false;
+}
+
+size_t PublicKeyCache::Load(const boost::filesystem::path& path,
+                            const asymm::PublicKey& public_key) {
+  std::string serialised_cache;
+  if (!ReadFile(path, &serialised_cache)) {
+    NFS_LOG(kInfo) << "No saved public keys at " << path;
+    return 0;
+  }
+  size_t added(0);
+  try {
+    protobuf::PublicKeyCache proto_cache;
+    protobuf::PublicKeyCache::Keys proto_keys;
+    if (!proto_cache.ParseFromString(serialised_cache) ||
+        !asymm::CheckSignature(asymm::PlainText(proto_cache.serialised_keys()),
+                               asymm::Signature(proto_cache.signature()), public_key) ||
+        !proto_keys.ParseFromString(proto_cache.serialised_keys())) {
+      LOG(kWarning) << "Ignoring invalid saved public keys at " << path;
+      return 0;
+    }
+    const auto now(std::chrono::steady_clock::now());
+    const int64_t seconds_since_epoch(SecondsSinceEpoch());
+    for (const auto& proto_key : proto_keys.keys()) {
+      if (proto_key.expiry() <= seconds_since_epoch)
+        continue;
+      NodeId node_id(proto_key.node_id());
+      auto& shard(GetShard(node_id));
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto result(shard.entries.insert(std::make_pair(std::move(node_id), Entry())));
+      if (!result.second)
+        continue;
+      auto& entry(result.first->second);
+      entry.key = asymm::DecodeKey(asymm::EncodedPublicKey(proto_key.encoded_public_key()));
+      entry.expiry = now + std::chrono::seconds(proto_key.expiry() - seconds_since_epoch);
+      entry.loaded = true;
+      ++added;
+    }
+  }
+  catch (const std::exception& e) {
+    LOG(kWarning) << "Failed to load saved public keys at " << path << ": "
+                  << boost::diagnostic_information(e);
+  }
+  NFS_LOG(kInfo) << "Loaded " << added << " public keys from " << path;
+  return added;
+}
+
+PublicKeyCache::Shard& PublicKeyCache::GetShard(const NodeId& node_id) {
+  const std::string id(node_id.string());
+  return shards_[static_cast<unsigned char>(id.back()) % shards_.size()];
+}
+
+void PublicKeyCache::Fetch(const NodeId& node_id) {
+  ++network_fetches_;
+  fetch_(node_id, [this, node_id](boost::optional<asymm::PublicKey> key) {
+    OnFetched(node_id, std::move(key));
+  });
+}
+
+void PublicKeyCache::OnFetched(const NodeId& node_id, boost::optional<asymm::PublicKey> key) {
+  std::vector<routing::GivePublicKeyFunctor> waiters;
+  boost::optional<asymm::PublicKey> result;
+  {
+    auto& shard(GetShard(node_id));
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto& entry(shard.entries[node_id]);
+    const auto now(std::chrono::steady_clock::now());
+    // A failed revalidation leaves the key already held in place until it expires.
+    if (key || !entry.key || entry.expiry <= now) {
+      entry.key = key;
+      entry.expiry = now + (key ? kTtl_ : kNegativeTtl_);
+    }
+    entry.fetching = false;
+    waiters.swap(entry.waiters);
+    result = entry.key;
+  }
+  if (!key)
+    LOG(kWarning) << "Failed to fetch public key of " << DebugId(node_id);
+  for (auto& give_key : waiters)
+    give_key(result);
+}
+
+void PublicKeyCache::Prune(Shard& shard, std::chrono::steady_clock::time_point now) {
+  if (shard.entries.size() <= kPruneThreshold)
+    return;
+  for (auto itr(std::begin(shard.entries)); itr != std::end(shard.entries);) {
+    if (!itr->second.fetching && itr->second.expiry <= now)
+      itr = shard.entries.erase(itr);
+    else
+      ++itr;
+  }
+}
+
+}  // namespace detail
+
+}  // namespace nfs
+
+}  // namespace maidsafe
@@ -18,6 +18,8 @@
 
 #include "maidsafe/nfs/public_mpid_helper.h"
 
+#include "maidsafe/nfs/log.h"
+
 namespace maidsafe {
 
 namespace nfs {
@@ -50,7 +52,7 @@ void PublicMpidHelper::AddEntry(boost::future<passport::PublicMpid>&& future,
 
 void PublicMpidHelper::Run() {
   if (!running_) {
-    LOG(kVerbose) << "starting thread !";
+    NFS_LOG(kVerbose) << "starting thread !";
     running_ = true;
     worker_future_ = std::async(std::launch::async, [this]() { this->Poll(); });
   }
@@ -18,6 +18,8 @@
 
 #include "maidsafe/nfs/public_pmid_helper.h"
 
+#include "maidsafe/nfs/log.h"
+
 namespace maidsafe {
 
 namespace nfs {
@@ -50,7 +52,7 @@ void PublicPmidHelper::AddEntry(boost::future<passport::PublicPmid>&& future,
 
 void PublicPmidHelper::Run() {
   if (!running_) {
-    LOG(kVerbose) << "starting thread !";
+    NFS_LOG(kVerbose) << "starting thread !";
     running_ = true;
     worker_future_ = std::async(std::launch::async, [this]() { this->Poll(); });
   }
@@ -70,7 +72,7 @@ void PublicPmidHelper::Poll() {
       new_functors_.resize(0);
 
       if (futures.empty()) {
-        LOG(kVerbose) << "reset running_ to false";
+        NFS_LOG(kVerbose) << "reset running_ to false";
         assert(functors.empty());
         running_ = false;
         break;
@@ -81,8 +83,8 @@ void PublicPmidHelper::Poll() {
     auto index = ready_future_itr - futures.begin();
     try {
       auto public_pmid = ready_future_itr->get();
-      LOG(kVerbose) << " got public_pmid of " << HexSubstr(public_pmid.name()->string())
-                    << " from network";
+      NFS_LOG(kVerbose) << " got public_pmid of " << HexSubstr(public_pmid.name()->string())
+                        << " from network";
       functors.at(index)(boost::optional<asymm::PublicKey>(public_pmid.public_key()));
     } catch (const std::exception& /*e*/) {
       functors.at(index)(boost::optional<asymm::PublicKey>());
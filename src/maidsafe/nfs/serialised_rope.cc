@@ -0,0 +1,108 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/serialised_rope.h"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace {
+
+const uint32_t kVarintWireType(0), kLengthDelimitedWireType(2);
+
+void AppendVarint(uint64_t value, std::string& output) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+}  // unnamed namespace
+
+SerialisedRope::SerialisedRope() : owned_(), pieces_(), size_(0) {}
+
+SerialisedRope::SerialisedRope(SerialisedRope&& other)
+    : owned_(std::move(other.owned_)), pieces_(std::move(other.pieces_)), size_(other.size_) {
+  other.size_ = 0;
+}
+
+void SerialisedRope::AppendVarintField(int field_number, uint64_t value) {
+  std::string fragment;
+  AppendVarint((static_cast<uint64_t>(field_number) << 3) | kVarintWireType, fragment);
+  AppendVarint(value, fragment);
+  AppendFragment(std::move(fragment));
+}
+
+void SerialisedRope::AppendInt32Field(int field_number, int32_t value) {
+  AppendVarintField(field_number, static_cast<uint64_t>(static_cast<int64_t>(value)));
+}
+
+void SerialisedRope::AppendBytesField(int field_number, std::string value) {
+  AppendLengthDelimitedHeader(field_number, value.size());
+  AppendFragment(std::move(value));
+}
+
+void SerialisedRope::AppendBytesFieldReference(int field_number, const std::string& value) {
+  AppendLengthDelimitedHeader(field_number, value.size());
+  AppendReference(value);
+}
+
+void SerialisedRope::AppendEmbeddedField(int field_number, SerialisedRope rope) {
+  AppendLengthDelimitedHeader(field_number, rope.size_);
+  for (auto& fragment : rope.owned_)
+    owned_.push_back(std::move(fragment));
+  pieces_.insert(pieces_.end(), rope.pieces_.begin(), rope.pieces_.end());
+  size_ += rope.size_;
+}
+
+void SerialisedRope::AppendTo(std::string& output) const {
+  output.reserve(output.size() + size_);
+  for (const auto& piece : pieces_)
+    output.append(piece.first, piece.second);
+}
+
+std::string SerialisedRope::Flatten() const {
+  std::string output;
+  AppendTo(output);
+  return output;
+}
+
+void SerialisedRope::AppendLengthDelimitedHeader(int field_number, size_t length) {
+  std::string fragment;
+  AppendVarint((static_cast<uint64_t>(field_number) << 3) | kLengthDelimitedWireType, fragment);
+  AppendVarint(length, fragment);
+  AppendFragment(std::move(fragment));
+}
+
+void SerialisedRope::AppendFragment(std::string fragment) {
+  owned_.emplace_back(new std::string(std::move(fragment)));
+  AppendReference(*owned_.back());
+}
+
+void SerialisedRope::AppendReference(const std::string& payload) {
+  if (payload.empty())
+    return;
+  pieces_.emplace_back(payload.data(), payload.size());
+  size_ += payload.size();
+}
+
+}  // namespace nfs
+
+}  // namespace maidsafe
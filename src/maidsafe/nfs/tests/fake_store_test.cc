@@ -17,6 +17,21 @@
     use of the MaidSafe Software.                                                                 */
 
 #include "maidsafe/nfs/client/fake_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
 #include "maidsafe/common/test.h"
 #include "maidsafe/common/utils.h"
 #include "maidsafe/common/data_types/data_type_values.h"
@@ -96,6 +111,556 @@ TEST_F(FakeStoreTest, BEH_SuccessfulStore) {
   ASSERT_TRUE(retrieved_versions.empty());
 }
 
+TEST_F(FakeStoreTest, BEH_GroupCommit) {
+  maidsafe::test::TestPath store_path(maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  FakeStore store(*store_path, kDefaultMaxDiskUsage, FakeStore::Durability::kGroupCommit,
+                  std::chrono::milliseconds(5));
+  std::vector<ImmutableData> chunks;
+  std::vector<boost::future<void>> futures;
+  for (int i(0); i != 10; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    futures.push_back(store.Put(chunks.back()));
+  }
+  for (auto& future : futures)
+    EXPECT_NO_THROW(future.get());
+  EXPECT_TRUE(DiskUsage(1000) == store.GetCurrentDiskUsage());
+  for (const auto& chunk : chunks)
+    EXPECT_TRUE(chunk.data() == store.Get(chunk.name()).get().data());
+
+  MutableData::Name dir_name(Identity(RandomString(64)));
+  StructuredDataVersions::VersionName version0(0, MakeIdentity());
+  StructuredDataVersions::VersionName version1(1, MakeIdentity());
+  EXPECT_NO_THROW(store.CreateVersionTree(dir_name, version0, 20, 5).get());
+  EXPECT_NO_THROW(store.PutVersion(dir_name, version0, version1).get());
+  EXPECT_TRUE(version1 == store.GetVersions(dir_name).get().front());
+}
+
+TEST_F(FakeStoreTest, BEH_Eviction) {
+  fake_store_.EnableEviction(0.5, 0.75);
+  ImmutableData shared_chunk(NonEmptyString(RandomString(100)));
+  EXPECT_NO_THROW(fake_store_.Put(shared_chunk).get());
+  EXPECT_NO_THROW(fake_store_.Put(shared_chunk).get());
+  MutableData::Name dir_name(Identity(RandomString(64)));
+  StructuredDataVersions::VersionName version0(0, MakeIdentity());
+  EXPECT_NO_THROW(fake_store_.CreateVersionTree(dir_name, version0, 20, 5).get());
+
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 50; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(fake_store_.Put(chunks.back()).get());
+    // Keep the most recent chunk hot
+    EXPECT_NO_THROW(fake_store_.Get(chunks.back().name()).get());
+    EXPECT_TRUE(fake_store_.GetCurrentDiskUsage() <= kDefaultMaxDiskUsage);
+  }
+
+  EXPECT_NO_THROW(fake_store_.Get(shared_chunk.name()).get());
+  EXPECT_TRUE(version0 == fake_store_.GetVersions(dir_name).get().front());
+  EXPECT_NO_THROW(fake_store_.Get(chunks.back().name()).get());
+  EXPECT_THROW(fake_store_.Get(chunks.front().name()).get(), std::exception);
+}
+
+TEST_F(FakeStoreTest, BEH_EvictionNeverRefusesPuts) {
+  fake_store_.EnableEviction(0.5, 0.75);
+  // Puts run concurrently on the store's threads, so eviction can fall behind them.
+  std::vector<boost::future<void>> futures;
+  for (int i(0); i != 200; ++i)
+    futures.push_back(fake_store_.Put(ImmutableData(NonEmptyString(RandomString(100)))));
+  for (auto& future : futures)
+    EXPECT_NO_THROW(future.get());
+
+  auto timeout(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+  while (std::chrono::steady_clock::now() < timeout &&
+         !(fake_store_.GetCurrentDiskUsage() <= kDefaultMaxDiskUsage)) {
+    Sleep(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(fake_store_.GetCurrentDiskUsage() <= kDefaultMaxDiskUsage);
+}
+
+TEST_F(FakeStoreTest, BEH_Scrub) {
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 5; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(fake_store_.Put(chunks.back()).get());
+  }
+  EXPECT_EQ(0U, fake_store_.Scrub(0).get());
+
+  boost::filesystem::path corrupted;
+  for (boost::filesystem::recursive_directory_iterator itr(*fake_store_path_), end; itr != end;
+       ++itr) {
+    if (boost::filesystem::is_regular_file(itr->status())) {
+      corrupted = itr->path();
+      break;
+    }
+  }
+  ASSERT_FALSE(corrupted.empty());
+  ASSERT_TRUE(WriteFile(corrupted, RandomString(100)));
+
+  std::vector<ImmutableData::Name> reported;
+  EXPECT_EQ(1U, fake_store_.Scrub(0, [&reported](const ImmutableData::Name& name) {
+                                       reported.push_back(name);
+                                     }).get());
+  ASSERT_EQ(1U, reported.size());
+  EXPECT_THROW(fake_store_.Get(reported.front()).get(), std::exception);
+  EXPECT_TRUE(DiskUsage(400) == fake_store_.GetCurrentDiskUsage());
+}
+
+TEST_F(FakeStoreTest, BEH_ScrubWithUnreadableCheckpoint) {
+  for (int i(0); i != 5; ++i)
+    EXPECT_NO_THROW(fake_store_.Put(ImmutableData(NonEmptyString(RandomString(100)))).get());
+  // As left by a crash part way through writing the checkpoint.
+  const boost::filesystem::path checkpoint_path(*fake_store_path_ / "scrub.checkpoint");
+  for (const std::string& checkpoint : {std::string(), std::string("garbage")}) {
+    std::ofstream(checkpoint_path.string(), std::ios::out | std::ios::trunc) << checkpoint;
+    EXPECT_EQ(0U, fake_store_.Scrub(0).get());
+    EXPECT_FALSE(boost::filesystem::exists(checkpoint_path));
+  }
+}
+
+TEST_F(FakeStoreTest, BEH_StopScrubbingDuringThrottle) {
+  for (int i(0); i != 5; ++i)
+    EXPECT_NO_THROW(fake_store_.Put(ImmutableData(NonEmptyString(RandomString(100)))).get());
+  // At one byte per second, the first batch earns a wait of at least 100 seconds.
+  auto scrubbed(fake_store_.Scrub(1));
+  Sleep(std::chrono::milliseconds(100));
+  const auto start(std::chrono::steady_clock::now());
+  fake_store_.StopScrubbing();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  EXPECT_EQ(0U, scrubbed.get());
+}
+
+TEST_F(FakeStoreTest, BEH_DeferredDecrement) {
+  fake_store_.SetGarbageCollectionGracePeriod(std::chrono::milliseconds(100));
+  ImmutableData kept(NonEmptyString(RandomString(100)));
+  ImmutableData dropped(NonEmptyString(RandomString(100)));
+  EXPECT_NO_THROW(fake_store_.Put(kept).get());
+  EXPECT_NO_THROW(fake_store_.Put(dropped).get());
+
+  fake_store_.DecrementReferenceCount(std::vector<ImmutableData::Name>{kept.name(),
+                                                                       dropped.name()});
+  // Logically removed straight away, but the space is only reclaimed by garbage collection.
+  EXPECT_THROW(fake_store_.Get(dropped.name()).get(), std::exception);
+  EXPECT_TRUE(DiskUsage(200) == fake_store_.GetCurrentDiskUsage());
+  // Re-putting within the grace period revokes the decrement.
+  EXPECT_NO_THROW(fake_store_.Put(kept).get());
+
+  auto timeout(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+  while (std::chrono::steady_clock::now() < timeout &&
+         fake_store_.GetCurrentDiskUsage() != DiskUsage(100)) {
+    Sleep(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(DiskUsage(100) == fake_store_.GetCurrentDiskUsage());
+  EXPECT_TRUE(kept.data() == fake_store_.Get(kept.name()).get().data());
+  EXPECT_THROW(fake_store_.Get(dropped.name()).get(), std::exception);
+}
+
+TEST_F(FakeStoreTest, BEH_CollectionCrashRecovery) {
+  maidsafe::test::TestPath store_path(maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  ImmutableData applied(NonEmptyString(RandomString(100)));
+  ImmutableData unapplied(NonEmptyString(RandomString(100)));
+  {
+    FakeStore store(*store_path, kDefaultMaxDiskUsage);
+    EXPECT_NO_THROW(store.Put(applied).get());
+    EXPECT_NO_THROW(store.Put(applied).get());
+    EXPECT_NO_THROW(store.Put(unapplied).get());
+  }
+
+  // Recreate a crash part way through a collection batch: both intents were journalled and
+  // 'applied' went from two references to one, but 'unapplied' was never removed.
+  auto count_chunks([&store_path](const std::string& extension) {
+    int count(0);
+    for (boost::filesystem::recursive_directory_iterator itr(*store_path), end; itr != end; ++itr)
+      count += (itr->path().extension() == extension) ? 1 : 0;
+    return count;
+  });
+  auto file_name([](const ImmutableData& chunk) {
+    return maidsafe::detail::GetFileName(DataNameVariant(chunk.name())).string();
+  });
+  boost::filesystem::path twice_referenced;
+  for (boost::filesystem::recursive_directory_iterator itr(*store_path), end; itr != end; ++itr) {
+    if (itr->path().extension() == ".2")
+      twice_referenced = itr->path();
+  }
+  ASSERT_FALSE(twice_referenced.empty());
+  boost::filesystem::rename(twice_referenced,
+                            boost::filesystem::path(twice_referenced).replace_extension(".1"));
+  const boost::filesystem::path journal_path(*store_path / "refcount.journal");
+  ASSERT_TRUE(WriteFile(journal_path, file_name(applied) + " 1\n" + file_name(unapplied) + " 1\n" +
+                                          file_name(applied) + " -1 2\n" + file_name(unapplied) +
+                                          " -1 1\n" + file_name(applied) + " 1"));
+  ASSERT_EQ(2, count_chunks(".1"));
+
+  // Replay must neither re-apply the decrement of 'applied' nor count the torn final line.
+  FakeStore store(*store_path, kDefaultMaxDiskUsage);
+  store.SetGarbageCollectionGracePeriod(std::chrono::milliseconds(0));
+  auto timeout(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+  while (std::chrono::steady_clock::now() < timeout &&
+         (count_chunks(".1") != 1 || boost::filesystem::exists(journal_path))) {
+    Sleep(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1, count_chunks(".1"));
+  EXPECT_FALSE(boost::filesystem::exists(journal_path));
+  EXPECT_TRUE(applied.data() == store.Get(applied.name()).get().data());
+  EXPECT_THROW(store.Get(unapplied.name()).get(), std::exception);
+}
+
+TEST_F(FakeStoreTest, FUNC_DecrementLatency) {
+  const int kChunkCount(100000);
+  maidsafe::test::TestPath store_path(maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  FakeStore store(*store_path, DiskUsage(kChunkCount * 2 * 10));
+  store.SetGarbageCollectionGracePeriod(std::chrono::milliseconds(0));
+  std::vector<ImmutableData::Name> deleted_names, decremented_names;
+  std::vector<boost::future<void>> futures;
+  for (int i(0); i != 2 * kChunkCount; ++i) {
+    ImmutableData chunk(NonEmptyString(RandomString(10)));
+    (i % 2 == 0 ? deleted_names : decremented_names).push_back(chunk.name());
+    futures.push_back(store.Put(chunk));
+  }
+  for (auto& future : futures)
+    future.get();
+  futures.clear();
+
+  // Per-chunk synchronous removal, which is what DecrementReferenceCount used to do.
+  auto start(std::chrono::steady_clock::now());
+  for (const auto& name : deleted_names)
+    futures.push_back(store.Delete(name));
+  for (auto& future : futures)
+    future.get();
+  std::cout << "Synchronous removal of " << kChunkCount << " chunks: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+
+  start = std::chrono::steady_clock::now();
+  store.DecrementReferenceCount(decremented_names);
+  std::cout << "Journalled decrement of " << kChunkCount << " chunks: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+  // Collecting this many chunks takes much longer than the other waits in this file allow.
+  const auto timeout(start + std::chrono::seconds(60));
+  while (std::chrono::steady_clock::now() < timeout &&
+         store.GetCurrentDiskUsage() != DiskUsage(0)) {
+    Sleep(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(store.GetCurrentDiskUsage() == DiskUsage(0));
+  std::cout << "Garbage collected after "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+}
+
+TEST_F(FakeStoreTest, BEH_ExportImport) {
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 5; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(fake_store_.Put(chunks.back()).get());
+  }
+  EXPECT_NO_THROW(fake_store_.Put(chunks.front()).get());
+  MutableData::Name dir_name(Identity(RandomString(64)));
+  StructuredDataVersions::VersionName version0(0, MakeIdentity());
+  EXPECT_NO_THROW(fake_store_.CreateVersionTree(dir_name, version0, 20, 5).get());
+
+  for (bool compress : {false, true}) {
+    const auto archive_path(*fake_store_path_ / "store.archive");
+    fake_store_.Export(archive_path, compress);
+    for (const auto& chunk : chunks) {
+      EXPECT_TRUE(chunk.data() ==
+                  FakeStore::GetFromArchive(archive_path, DataNameVariant(chunk.name())));
+    }
+    EXPECT_THROW(FakeStore::GetFromArchive(
+                     archive_path, DataNameVariant(ImmutableData::Name(Identity(
+                                       RandomString(64))))),
+                 std::exception);
+
+    maidsafe::test::TestPath import_path(
+        maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+    FakeStore imported(*import_path, kDefaultMaxDiskUsage);
+    imported.Import(archive_path);
+    EXPECT_TRUE(fake_store_.GetCurrentDiskUsage() == imported.GetCurrentDiskUsage());
+    for (const auto& chunk : chunks)
+      EXPECT_TRUE(chunk.data() == imported.Get(chunk.name()).get().data());
+    EXPECT_TRUE(version0 == imported.GetVersions(dir_name).get().front());
+    // The first chunk was stored twice, so survives one delete.
+    EXPECT_NO_THROW(imported.Delete(chunks.front().name()).get());
+    EXPECT_NO_THROW(imported.Get(chunks.front().name()).get());
+    boost::filesystem::remove(archive_path);
+  }
+}
+
+TEST_F(FakeStoreTest, BEH_ExportClosedStore) {
+  maidsafe::test::TestPath store_path(maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  std::vector<ImmutableData> chunks;
+  {
+    FakeStore store(*store_path, kDefaultMaxDiskUsage);
+    for (int i(0); i != 5; ++i) {
+      chunks.emplace_back(NonEmptyString(RandomString(100)));
+      EXPECT_NO_THROW(store.Put(chunks.back()).get());
+    }
+  }
+  auto list_files([&]() -> std::map<std::string, std::pair<uintmax_t, std::time_t>> {
+    std::map<std::string, std::pair<uintmax_t, std::time_t>> files;
+    for (boost::filesystem::recursive_directory_iterator it(*store_path), end; it != end; ++it) {
+      files[it->path().string()] = boost::filesystem::is_regular_file(it->status())
+          ? std::make_pair(boost::filesystem::file_size(it->path()),
+                           boost::filesystem::last_write_time(it->path()))
+          : std::make_pair(uintmax_t(0), std::time_t(0));
+    }
+    return files;
+  });
+  const auto before(list_files());
+
+  const auto archive_path(*fake_store_path_ / "store.archive");
+  FakeStore::Export(*store_path, archive_path, false);
+  EXPECT_TRUE(before == list_files());
+  for (const auto& chunk : chunks) {
+    EXPECT_TRUE(chunk.data() ==
+                FakeStore::GetFromArchive(archive_path, DataNameVariant(chunk.name())));
+  }
+  EXPECT_THROW(FakeStore::Export(*store_path / "absent", archive_path, false), std::exception);
+}
+
+TEST_F(FakeStoreTest, BEH_KeyFilter) {
+  ImmutableData data(NonEmptyString(RandomString(100)));
+  EXPECT_NO_THROW(fake_store_.Put(data).get());
+  auto timeout(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+  while (std::chrono::steady_clock::now() < timeout &&
+         fake_store_.GetKeyFilterStats().capacity == 0) {
+    Sleep(std::chrono::milliseconds(10));
+  }
+  ASSERT_NE(0U, fake_store_.GetKeyFilterStats().capacity);
+
+  EXPECT_NO_THROW(fake_store_.Get(data.name()).get());
+  const int kMisses(1000);
+  for (int i(0); i != kMisses; ++i) {
+    EXPECT_THROW(fake_store_.Get(ImmutableData::Name(Identity(RandomString(64)))).get(),
+                 std::exception);
+  }
+  auto stats(fake_store_.GetKeyFilterStats());
+  EXPECT_EQ(1U, stats.entries);
+  EXPECT_EQ(kMisses + 1U, stats.lookups);
+  EXPECT_EQ(kMisses, static_cast<int>(stats.definite_misses + stats.false_positives));
+  EXPECT_LT(stats.observed_false_positive_rate, 0.05);
+}
+
+TEST_F(FakeStoreTest, BEH_Enumerate) {
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 5; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(fake_store_.Put(chunks.back()).get());
+  }
+  EXPECT_NO_THROW(fake_store_.Put(chunks.front()).get());
+  MutableData::Name dir_name(Identity(RandomString(64)));
+  StructuredDataVersions::VersionName version0(0, MakeIdentity());
+  EXPECT_NO_THROW(fake_store_.CreateVersionTree(dir_name, version0, 20, 5).get());
+
+  auto enumerate_all([](const FakeStore& store, const std::vector<DataTagValue>& types)
+                         -> std::vector<FakeStore::StoredEntry> {
+    std::vector<FakeStore::StoredEntry> all;
+    FakeStore::EnumerationCursor cursor;
+    while (!cursor.done) {
+      auto page(store.Enumerate(cursor, 2, types));
+      EXPECT_LE(page.size(), 2U);
+      all.insert(std::end(all), std::begin(page), std::end(page));
+    }
+    return all;
+  });
+
+  auto check([&](const FakeStore& store) {
+    auto all(enumerate_all(store, std::vector<DataTagValue>()));
+    EXPECT_EQ(chunks.size() + 1, all.size());
+    EXPECT_EQ(1, std::count_if(std::begin(all), std::end(all),
+                               [](const FakeStore::StoredEntry& entry) { return entry.versions; }));
+    auto immutables(enumerate_all(store, std::vector<DataTagValue>(
+                                             1, DataTagValue::kImmutableDataValue)));
+    ASSERT_EQ(chunks.size(), immutables.size());
+    for (const auto& entry : immutables) {
+      EXPECT_FALSE(entry.versions);
+      EXPECT_EQ(100U, entry.size);
+      const bool is_first(entry.name == DataNameVariant(chunks.front().name()));
+      EXPECT_EQ(is_first ? 2U : 1U, entry.reference_count);
+    }
+  });
+  check(fake_store_);
+
+  // A store reopened over an existing directory builds its index from disk.
+  maidsafe::test::TestPath copy_path(maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  const auto archive_path(*copy_path / "store.archive");
+  fake_store_.Export(archive_path, false);
+  {
+    FakeStore copy(*copy_path / "store", kDefaultMaxDiskUsage);
+    copy.Import(archive_path);
+  }
+  FakeStore reopened(*copy_path / "store", kDefaultMaxDiskUsage);
+  check(reopened);
+}
+
+TEST_F(FakeStoreTest, BEH_UsageStats) {
+  maidsafe::test::TestPath store_path(maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  std::vector<ImmutableData> chunks;
+  MutableData::Name dir_name(Identity(RandomString(64)));
+  auto wait_until_exact([](const FakeStore& store) -> FakeStore::UsageStats {
+    auto timeout(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+    while (std::chrono::steady_clock::now() < timeout && !store.GetUsageStats().exact)
+      Sleep(std::chrono::milliseconds(10));
+    return store.GetUsageStats();
+  });
+  auto check([&](const FakeStore::UsageStats& stats) {
+    const auto immutables(stats.by_type.find(DataTagValue::kImmutableDataValue));
+    ASSERT_TRUE(immutables != std::end(stats.by_type));
+    EXPECT_EQ(200U, immutables->second.bytes);
+    EXPECT_EQ(2U, immutables->second.objects);
+    EXPECT_EQ(3U, immutables->second.references);
+    const auto versions(stats.by_type.find(DataTagValue::kMutableDataValue));
+    ASSERT_TRUE(versions != std::end(stats.by_type));
+    EXPECT_EQ(1U, versions->second.objects);
+    EXPECT_NE(0U, versions->second.bytes);
+  });
+
+  {
+    FakeStore store(*store_path, kDefaultMaxDiskUsage);
+    for (int i(0); i != 3; ++i) {
+      chunks.emplace_back(NonEmptyString(RandomString(100)));
+      EXPECT_NO_THROW(store.Put(chunks.back()).get());
+    }
+    EXPECT_NO_THROW(store.Put(chunks.front()).get());
+    EXPECT_NO_THROW(store.Delete(chunks.back().name()).get());
+    StructuredDataVersions::VersionName version0(0, MakeIdentity());
+    EXPECT_NO_THROW(store.CreateVersionTree(dir_name, version0, 20, 5).get());
+    auto stats(wait_until_exact(store));
+    EXPECT_TRUE(stats.exact);
+    check(stats);
+  }
+
+  // The figures saved at shutdown are reported straight away on reopening.
+  FakeStore reopened(*store_path, kDefaultMaxDiskUsage);
+  check(reopened.GetUsageStats());
+  check(wait_until_exact(reopened));
+}
+
+TEST_F(FakeStoreTest, BEH_SnapshotAndClone) {
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 3; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(fake_store_.Put(chunks.back()).get());
+  }
+  MutableData::Name dir_name(Identity(RandomString(64)));
+  StructuredDataVersions::VersionName version0(0, MakeIdentity());
+  StructuredDataVersions::VersionName version1(1, MakeIdentity());
+  StructuredDataVersions::VersionName version2(1, MakeIdentity());
+  EXPECT_NO_THROW(fake_store_.CreateVersionTree(dir_name, version0, 20, 5).get());
+
+  maidsafe::test::TestPath clone_path(maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  EXPECT_THROW(fake_store_.Snapshot(*fake_store_path_), std::exception);
+  auto clone(fake_store_.Clone(*clone_path / "clone"));
+  EXPECT_TRUE(fake_store_.GetCurrentDiskUsage() == clone->GetCurrentDiskUsage());
+  for (const auto& chunk : chunks)
+    EXPECT_TRUE(chunk.data() == clone->Get(chunk.name()).get().data());
+
+  // Changes to either side stay on that side.
+  EXPECT_NO_THROW(clone->Delete(chunks.front().name()).get());
+  EXPECT_NO_THROW(clone->PutVersion(dir_name, version0, version1).get());
+  EXPECT_NO_THROW(fake_store_.PutVersion(dir_name, version0, version2).get());
+  EXPECT_THROW(clone->Get(chunks.front().name()).get(), std::exception);
+  EXPECT_NO_THROW(fake_store_.Get(chunks.front().name()).get());
+  EXPECT_TRUE(version1 == clone->GetVersions(dir_name).get().front());
+  EXPECT_TRUE(version2 == fake_store_.GetVersions(dir_name).get().front());
+}
+
+TEST_F(FakeStoreTest, BEH_SnapshotWhileWriting) {
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 3; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(fake_store_.Put(chunks.back()).get());
+  }
+  MutableData::Name dir_name(Identity(RandomString(64)));
+  StructuredDataVersions::VersionName version0(0, MakeIdentity());
+  EXPECT_NO_THROW(fake_store_.CreateVersionTree(dir_name, version0, 5, 1).get());
+
+  // The version tree's file is rewritten by every PutVersion.
+  std::atomic<bool> done(false);
+  std::thread writer([&] {
+    StructuredDataVersions::VersionName tip(version0);
+    for (uint64_t index(1); !done; ++index) {
+      StructuredDataVersions::VersionName next(index, MakeIdentity());
+      EXPECT_NO_THROW(fake_store_.PutVersion(dir_name, tip, next).get());
+      tip = next;
+    }
+  });
+  maidsafe::test::TestPath snapshot_path(
+      maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  const int kSnapshotCount(5);
+  for (int i(0); i != kSnapshotCount; ++i)
+    fake_store_.Snapshot(*snapshot_path / std::to_string(i));
+  done = true;
+  writer.join();
+
+  for (int i(0); i != kSnapshotCount; ++i) {
+    FakeStore snapshot(*snapshot_path / std::to_string(i), DiskUsage(1 << 20));
+    for (const auto& chunk : chunks)
+      EXPECT_TRUE(chunk.data() == snapshot.Get(chunk.name()).get().data());
+    EXPECT_EQ(1U, snapshot.GetVersions(dir_name).get().size());
+  }
+}
+
+TEST_F(FakeStoreTest, BEH_UsageAfterSnapshot) {
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 3; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(fake_store_.Put(chunks.back()).get());
+  }
+  const DiskUsage usage(fake_store_.GetCurrentDiskUsage());
+  auto wait_until_indexed([](const FakeStore& store) {
+    auto timeout(std::chrono::steady_clock::now() + std::chrono::seconds(5));
+    while (std::chrono::steady_clock::now() < timeout && !store.GetUsageStats().exact)
+      Sleep(std::chrono::milliseconds(10));
+  });
+
+  // A store opened over a snapshot starts from the snapshot's usage, as a seeded test store does.
+  maidsafe::test::TestPath snapshot_path(
+      maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+  fake_store_.Snapshot(*snapshot_path / "snapshot");
+  {
+    FakeStore seeded(*snapshot_path / "snapshot", kDefaultMaxDiskUsage);
+    EXPECT_TRUE(usage == seeded.GetCurrentDiskUsage());
+    wait_until_indexed(seeded);
+    EXPECT_TRUE(usage == seeded.GetCurrentDiskUsage());
+    EXPECT_NO_THROW(seeded.Delete(chunks.front().name()).get());
+    EXPECT_TRUE(DiskUsage(usage.data - 100) == seeded.GetCurrentDiskUsage());
+  }
+
+  // Without a ledger, as after a crash, the usage is recomputed once the index is built.
+  boost::filesystem::remove(*snapshot_path / "snapshot" / "usage.ledger");
+  FakeStore reopened(*snapshot_path / "snapshot", kDefaultMaxDiskUsage);
+  wait_until_indexed(reopened);
+  EXPECT_TRUE(DiskUsage(usage.data - 100) == reopened.GetCurrentDiskUsage());
+}
+
+TEST_F(FakeStoreTest, FUNC_GroupCommitThroughput) {
+  const int kChunkCount(500);
+  const DiskUsage kMaxDiskUsage(kChunkCount * 1024);
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != kChunkCount; ++i)
+    chunks.emplace_back(NonEmptyString(RandomString(1024)));
+
+  auto run([&](FakeStore::Durability durability, std::chrono::milliseconds window) {
+    maidsafe::test::TestPath store_path(
+        maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore"));
+    FakeStore store(*store_path, kMaxDiskUsage, durability, window);
+    std::vector<boost::future<void>> futures;
+    auto start(std::chrono::steady_clock::now());
+    for (const auto& chunk : chunks)
+      futures.push_back(store.Put(chunk));
+    for (auto& future : futures)
+      EXPECT_NO_THROW(future.get());
+    auto elapsed(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start));
+    std::cout << (durability == FakeStore::Durability::kNone ? "No flush" : "Group commit")
+              << ", window " << window.count() << " ms: "
+              << (kChunkCount * 1000000.0) / (elapsed.count() + 1) << " puts/s" << std::endl;
+  });
+
+  run(FakeStore::Durability::kNone, std::chrono::milliseconds(0));
+  for (auto window : {0, 1, 2, 5, 10, 20})
+    run(FakeStore::Durability::kGroupCommit, std::chrono::milliseconds(window));
+}
+
 }  // namespace test
 }  // namespace nfs
 
@@ -0,0 +1,233 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/client/get_handler.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/asio_service.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+#include "maidsafe/common/data_types/immutable_data.h"
+#include "maidsafe/routing/parameters.h"
+#include "maidsafe/routing/timer.h"
+
+namespace maidsafe {
+
+namespace nfs_client {
+
+namespace test {
+
+namespace {
+
+// Records the task ids of get requests rather than sending them.
+class FakeDispatcher {
+ public:
+  FakeDispatcher() : mutex_(), task_ids_() {}
+
+  template <typename DataName>
+  void SendGetRequest(routing::TaskId task_id, const DataName& /*data_name*/) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ids_.push_back(task_id);
+  }
+
+  std::vector<routing::TaskId> task_ids() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return task_ids_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<routing::TaskId> task_ids_;
+};
+
+}  // unnamed namespace
+
+class GetHandlerTest : public testing::Test {
+ protected:
+  GetHandlerTest()
+      : asio_service_(2), get_timer_(asio_service_), dispatcher_(),
+        get_handler_(get_timer_, dispatcher_) {}
+
+  ~GetHandlerTest() {
+    get_timer_.CancelAll();
+    asio_service_.Stop();
+  }
+
+  BoostAsioService asio_service_;
+  routing::Timer<DataNameAndContentOrReturnCode> get_timer_;
+  FakeDispatcher dispatcher_;
+  GetHandler<FakeDispatcher> get_handler_;
+};
+
+TEST_F(GetHandlerTest, BEH_RetryAfterFailedResponses) {
+  const ImmutableData data(NonEmptyString(RandomString(100)));
+  auto promise(std::make_shared<boost::promise<ImmutableData>>());
+  auto future(promise->get_future());
+  get_handler_.Get(data.name(), promise, std::chrono::seconds(10));
+  ASSERT_EQ(1U, dispatcher_.task_ids().size());
+  const routing::TaskId original_task_id(dispatcher_.task_ids().front());
+  EXPECT_TRUE(get_handler_.IsAwaiting(original_task_id));
+  EXPECT_FALSE(get_handler_.IsAwaiting(original_task_id + 1));
+
+  const DataNameAndContentOrReturnCode failure(data.name(),
+                                               ReturnCode(CommonErrors::no_such_element));
+  for (size_t i(0); i != routing::Parameters::group_size - 1; ++i)
+    get_handler_.AddResponse(original_task_id, failure);
+  ASSERT_EQ(2U, dispatcher_.task_ids().size());
+  const routing::TaskId retry_task_id(dispatcher_.task_ids().back());
+  EXPECT_NE(original_task_id, retry_task_id);
+  EXPECT_FALSE(get_handler_.IsAwaiting(original_task_id));
+  EXPECT_TRUE(get_handler_.IsAwaiting(retry_task_id));
+
+  // Responses to the superseded request are ignored.
+  get_handler_.AddResponse(original_task_id, DataNameAndContentOrReturnCode(data));
+  EXPECT_FALSE(future.is_ready());
+
+  get_handler_.AddResponse(retry_task_id, DataNameAndContentOrReturnCode(data));
+  EXPECT_TRUE(data.data() == future.get().data());
+  // The get is marked finished just after its promise is set.
+  for (int i(0); i != 100 && get_handler_.IsAwaiting(retry_task_id); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(get_handler_.IsAwaiting(retry_task_id));
+}
+
+TEST_F(GetHandlerTest, BEH_InvalidContentIgnored) {
+  const ImmutableData data(NonEmptyString(RandomString(100)));
+  const ImmutableData other_data(NonEmptyString(RandomString(100)));
+  auto promise(std::make_shared<boost::promise<ImmutableData>>());
+  auto future(promise->get_future());
+  get_handler_.Get(data.name(), promise, std::chrono::seconds(10));
+  ASSERT_EQ(1U, dispatcher_.task_ids().size());
+  const routing::TaskId task_id(dispatcher_.task_ids().front());
+
+  get_handler_.AddResponse(task_id, DataNameAndContentOrReturnCode(other_data));
+  EXPECT_FALSE(future.is_ready());
+  EXPECT_TRUE(get_handler_.IsAwaiting(task_id));
+
+  get_handler_.AddResponse(task_id, DataNameAndContentOrReturnCode(data));
+  EXPECT_TRUE(data.data() == future.get().data());
+  // Once a response has been accepted, others aren't validated or passed on.
+  get_handler_.AddResponse(task_id, DataNameAndContentOrReturnCode(other_data));
+  get_handler_.AddResponse(task_id, DataNameAndContentOrReturnCode(data));
+}
+
+TEST_F(GetHandlerTest, BEH_HeldGet) {
+  const ImmutableData data(NonEmptyString(RandomString(100)));
+  ReadyQueue ready_queue;
+  auto held_promise(std::make_shared<boost::promise<ImmutableData>>());
+  auto held_future(held_promise->get_future());
+  get_handler_.Get(data.name(), held_promise, std::chrono::milliseconds(100), &ready_queue);
+  auto promise(std::make_shared<boost::promise<ImmutableData>>());
+  auto future(promise->get_future());
+  get_handler_.Get(data.name(), promise, std::chrono::seconds(10), &ready_queue);
+  EXPECT_TRUE(dispatcher_.task_ids().empty());
+
+  // The timeout runs while the request is held.
+  EXPECT_THROW(held_future.get(), std::exception);
+  EXPECT_FALSE(future.is_ready());
+
+  ready_queue.Release();
+  ASSERT_EQ(2U, dispatcher_.task_ids().size());
+  get_handler_.AddResponse(dispatcher_.task_ids().back(), DataNameAndContentOrReturnCode(data));
+  EXPECT_TRUE(data.data() == future.get().data());
+}
+
+TEST_F(GetHandlerTest, FUNC_ConcurrentReadersOfLargeChunks) {
+  const int kReaderCount(16), kGetsPerReader(16);
+  const ImmutableData data(NonEmptyString(RandomString(1024 * 1024)));
+  const DataNameAndContentOrReturnCode response(data);
+  std::mutex get_mutex;  // so that each reader can tell which task id is its own
+
+  const auto start(std::chrono::steady_clock::now());
+  std::vector<std::thread> readers;
+  for (int reader(0); reader != kReaderCount; ++reader) {
+    readers.emplace_back([&] {
+      for (int i(0); i != kGetsPerReader; ++i) {
+        auto promise(std::make_shared<boost::promise<ImmutableData>>());
+        auto future(promise->get_future());
+        routing::TaskId task_id(0);
+        {
+          std::lock_guard<std::mutex> lock(get_mutex);
+          get_handler_.Get(data.name(), promise, std::chrono::seconds(60));
+          task_id = dispatcher_.task_ids().back();
+        }
+        // In practice each of the group's responses arrives on its own thread.
+        std::vector<std::thread> group;
+        for (size_t j(0); j != routing::Parameters::group_size; ++j)
+          group.emplace_back([&] { get_handler_.AddResponse(task_id, response); });
+        for (auto& member : group)
+          member.join();
+        EXPECT_TRUE(data.data() == future.get().data());
+      }
+    });
+  }
+  for (auto& reader : readers)
+    reader.join();
+  const auto elapsed(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count() + 1);
+  std::cout << kReaderCount << " readers completed " << kReaderCount * kGetsPerReader
+            << " gets of 1 MiB chunks at "
+            << kReaderCount * kGetsPerReader * 1000000.0 / elapsed << " gets/s" << std::endl;
+}
+
+TEST_F(GetHandlerTest, FUNC_ConcurrentGroupResponses) {
+  const int kThreadCount(64), kGetCount(6400);
+  const ImmutableData data(NonEmptyString(RandomString(100)));
+  const DataNameAndContentOrReturnCode response(data);
+  std::vector<boost::future<ImmutableData>> futures;
+  for (int i(0); i != kGetCount; ++i) {
+    auto promise(std::make_shared<boost::promise<ImmutableData>>());
+    futures.push_back(promise->get_future());
+    get_handler_.Get(data.name(), promise, std::chrono::seconds(60));
+  }
+  const auto task_ids(dispatcher_.task_ids());
+  ASSERT_EQ(kGetCount, static_cast<int>(task_ids.size()));
+
+  const auto start(std::chrono::steady_clock::now());
+  std::vector<std::thread> threads;
+  for (int thread_index(0); thread_index != kThreadCount; ++thread_index) {
+    threads.emplace_back([&, thread_index] {
+      for (size_t i(thread_index); i < task_ids.size(); i += kThreadCount) {
+        for (size_t j(0); j != routing::Parameters::group_size; ++j)
+          get_handler_.AddResponse(task_ids[i], response);
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (auto& future : futures)
+    EXPECT_TRUE(data.data() == future.get().data());
+  const auto elapsed(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count() + 1);
+  std::cout << kThreadCount << " threads delivered "
+            << kGetCount * routing::Parameters::group_size << " group responses at "
+            << kGetCount * routing::Parameters::group_size * 1000000.0 / elapsed
+            << " responses/s" << std::endl;
+}
+
+}  // namespace test
+
+}  // namespace nfs_client
+
+}  // namespace maidsafe
@@ -18,6 +18,14 @@
 
 #include "maidsafe/nfs/tests/maid_client_test.h"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#include "boost/filesystem/operations.hpp"
+
 namespace maidsafe {
 
 namespace nfs {
@@ -101,6 +109,114 @@ TEST_F(MaidClientTest, FUNC_DataFlooding) {
   LOG(kVerbose) << "Data flooding test has finished successfully";
 }
 
+TEST_F(MaidClientTest, FUNC_ConcurrentPutThroughput) {
+  // Many threads sharing one client; each thread issues its puts and waits on them in turn.
+  const size_t kPutsPerThread(4);
+  AddClient();
+  for (size_t thread_count(1); thread_count <= 32; thread_count *= 2) {
+    GenerateChunks(thread_count * kPutsPerThread, 1024);
+    std::vector<std::thread> threads;
+    auto start(std::chrono::steady_clock::now());
+    for (size_t thread_index(0); thread_index < thread_count; ++thread_index) {
+      threads.emplace_back([&, thread_index] {
+        for (size_t index(0); index < kPutsPerThread; ++index) {
+          const auto& chunk(chunks_[thread_index * kPutsPerThread + index]);
+          EXPECT_NO_THROW(clients_.back()->Put(chunk).get())
+              << "Store failure " << DebugId(NodeId(chunk.name()->string()));
+        }
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    auto elapsed(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    std::cout << thread_count << " threads: " << chunks_.size() << " puts in " << elapsed
+              << " ms (" << (chunks_.size() * 1000.0) / std::max<int64_t>(elapsed, 1)
+              << " puts/s)" << std::endl;
+  }
+}
+
+// Disabled until the vault's MaidManager handles PutManyRequest; until then every batch times out.
+TEST_F(MaidClientTest, DISABLED_FUNC_PutManyVersusPut) {
+  const size_t kChunkCount(64);
+  AddClient();
+  auto elapsed_ms([](std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+  });
+
+  GenerateChunks(kChunkCount);
+  auto start(std::chrono::steady_clock::now());
+  std::vector<boost::future<void>> put_futures;
+  for (const auto& chunk : chunks_)
+    put_futures.push_back(clients_.back()->Put(chunk));
+  for (size_t index(0); index < put_futures.size(); ++index) {
+    EXPECT_NO_THROW(put_futures[index].get())
+        << "Store failure " << DebugId(NodeId(chunks_[index].name()->string()));
+  }
+  const auto put_elapsed(elapsed_ms(start));
+
+  GenerateChunks(kChunkCount);
+  start = std::chrono::steady_clock::now();
+  auto put_many_futures(clients_.back()->PutMany(chunks_));
+  ASSERT_EQ(chunks_.size(), put_many_futures.size());
+  for (size_t index(0); index < put_many_futures.size(); ++index) {
+    EXPECT_NO_THROW(put_many_futures[index].get())
+        << "Store failure " << DebugId(NodeId(chunks_[index].name()->string()));
+  }
+  const auto put_many_elapsed(elapsed_ms(start));
+  std::cout << kChunkCount << " chunks stored in " << put_elapsed << " ms with Put and "
+            << put_many_elapsed << " ms with PutMany" << std::endl;
+
+  std::vector<boost::future<ImmutableData>> get_futures;
+  for (const auto& chunk : chunks_)
+    get_futures.push_back(clients_.back()->Get<ImmutableData::Name>(chunk.name()));
+  CompareGetResult(chunks_, get_futures);
+}
+
+TEST_F(MaidClientTest, FUNC_TimeToFirstGet) {
+  AddClient();
+  ImmutableData data(NonEmptyString(RandomString(1024)));
+  ASSERT_NO_THROW(clients_.back()->Put(data).get());
+  auto time_to_first_get([&](std::function<std::shared_ptr<nfs_client::MaidClient>()> make) {
+    auto start(std::chrono::steady_clock::now());
+    clients_.emplace_back(make());
+    EXPECT_EQ(data.data(), clients_.back()->Get(data.name()).get().data());
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+  });
+  std::cout << "Time to first Get with MakeShared: " << time_to_first_get([] {
+    return nfs_client::MaidClient::MakeShared(passport::CreateMaidAndSigner().first);
+  }) << " ms" << std::endl;
+  for (int ready_health : {100, 50, 20}) {
+    std::cout << "Time to first Get with MakeSharedAsync, ready at health " << ready_health
+              << ": " << time_to_first_get([ready_health] {
+      return nfs_client::MaidClient::MakeSharedAsync(passport::CreateMaidAndSigner().first,
+                                                     ready_health);
+    }) << " ms" << std::endl;
+  }
+}
+
+TEST_F(MaidClientTest, FUNC_JoinWithColdAndWarmKeyCache) {
+  maidsafe::test::TestPath key_cache_dir(maidsafe::test::CreateTestPath("MaidSafe_Test_KeyCache"));
+  const auto key_cache_path(*key_cache_dir / "public_keys");
+  auto maid_and_signer(passport::CreateMaidAndSigner());
+  nfs_client::MaidClient::MakeShared(maid_and_signer)->Stop();
+  auto time_to_join([&] {
+    auto start(std::chrono::steady_clock::now());
+    auto client(nfs_client::MaidClient::MakeShared(maid_and_signer.first, key_cache_path));
+    auto elapsed(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    client->Stop();
+    return elapsed;
+  });
+  auto cold(time_to_join());
+  ASSERT_TRUE(boost::filesystem::exists(key_cache_path));
+  auto warm(time_to_join());
+  std::cout << "Time to join with a cold public key cache: " << cold << " ms, with a warm one: "
+            << warm << " ms" << std::endl;
+}
+
 /*
 // The test below is disbaled as its proper operation assumes a delete funcion is in place
 TEST_F(MaidClientTest, DISABLED_FUNC_PutMultipleCopies) {
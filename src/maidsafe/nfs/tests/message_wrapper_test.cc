@@ -18,7 +18,16 @@
 
 #include "maidsafe/nfs/message_wrapper.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include "boost/variant/static_visitor.hpp"
 #include "boost/variant/variant.hpp"
@@ -26,6 +35,7 @@
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/test.h"
 #include "maidsafe/common/utils.h"
+#include "maidsafe/routing/parameters.h"
 
 #include "maidsafe/nfs/message_types.h"
 #include "maidsafe/nfs/client/messages.h"
@@ -43,6 +53,52 @@ namespace {
 typedef PutRequestFromMaidNodeToMaidManager PutRequest;
 typedef DeleteRequestFromMaidNodeToMaidManager DeleteRequest;
 
+std::atomic<uint64_t> g_allocation_count(0);
+
+// Counts the blocks it takes from the heap, to compare std::allocate_shared with the pool.
+template <typename T>
+class CountingAllocator {
+ public:
+  typedef T value_type;
+  template <typename U>
+  struct rebind {
+    typedef CountingAllocator<U> other;
+  };
+
+  CountingAllocator() {}
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& /*other*/) {}  // NOLINT (implicit by design)
+
+  T* allocate(size_t count) {
+    ++g_allocation_count;
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T* pointer, size_t count) { std::allocator<T>().deallocate(pointer, count); }
+};
+
+template <typename T, typename U>
+bool operator==(const CountingAllocator<T>& /*lhs*/, const CountingAllocator<U>& /*rhs*/) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const CountingAllocator<T>& /*lhs*/, const CountingAllocator<U>& /*rhs*/) {
+  return false;
+}
+
+// Serialises 'message' the way MessageWrapper did before contents were written via a rope.
+template <MessageAction action, typename SourcePersona, typename Sender,
+          typename DestinationPersona, typename Receiver, typename Contents>
+std::string SerialiseViaProtobuf(const MessageWrapper<action, SourcePersona, Sender,
+                                                      DestinationPersona, Receiver, Contents>&
+                                     message) {
+  return detail::SerialiseMessageWrapper(std::make_tuple(
+      action, detail::SourceTaggedValue(SourcePersona::value),
+      detail::DestinationTaggedValue(DestinationPersona::value), message.id,
+      message.contents->Serialise()));
+}
+
 }  // unnamed namespace
 
 template <typename ServiceImpl>
@@ -151,6 +207,166 @@ TEST(MessageWrapperTest, BEH_CheckVariant) {
   EXPECT_THROW(data_manager_service.HandleMessage(tuple_del), maidsafe_error);
 }
 
+TEST(MessageWrapperTest, BEH_RopeSerialisationMatchesProtobuf) {
+  ImmutableData data(NonEmptyString(RandomString(1024 * 1024)));
+  for (auto message_id : {0, 1, 300, -1, -123456}) {
+    PutRequest put(MessageId(message_id), nfs_vault::DataNameAndContent(data));
+    DeleteRequest del(MessageId(message_id), DeleteRequest::Contents(data.name()));
+    EXPECT_EQ(SerialiseViaProtobuf(put), put.Serialise());
+    EXPECT_EQ(SerialiseViaProtobuf(del), del.Serialise());
+    auto parsed(ParseMessageWrapper(put.Serialise()));
+    EXPECT_EQ(MessageId(message_id), std::get<3>(parsed));
+    EXPECT_EQ(*put.contents, PutRequest::Contents(std::get<4>(parsed)));
+  }
+}
+
+TEST(MessageWrapperTest, BEH_PutManyMessages) {
+  typedef PutManyRequestFromMaidNodeToMaidManager PutManyRequest;
+  typedef PutManyResponseFromMaidManagerToMaidNode PutManyResponse;
+  std::vector<nfs_vault::DataNameAndContent> items;
+  for (size_t size : {1, 1024, 1024 * 1024})
+    items.emplace_back(ImmutableData(NonEmptyString(RandomString(size))));
+  PutManyRequest request(MessageId(42), PutManyRequest::Contents(items));
+  EXPECT_EQ(SerialiseViaProtobuf(request), request.Serialise());
+  EXPECT_EQ(*request.contents,
+            PutManyRequest::Contents(std::get<4>(ParseMessageWrapper(request.Serialise()))));
+
+  std::vector<nfs_client::DataNameAndReturnCode> results;
+  results.emplace_back(items[0].name, nfs_client::ReturnCode(CommonErrors::success));
+  results.emplace_back(items[1].name, nfs_client::ReturnCode(CommonErrors::invalid_argument));
+  results.emplace_back(items[2].name, nfs_client::ReturnCode(CommonErrors::success));
+  PutManyResponse response(MessageId(42), PutManyResponse::Contents(results));
+  auto parsed(ParseMessageWrapper(response.Serialise()));
+  EXPECT_EQ(MessageAction::kPutManyResponse, std::get<0>(parsed));
+  EXPECT_EQ(*response.contents, PutManyResponse::Contents(std::get<4>(parsed)));
+}
+
+TEST(MessageWrapperTest, BEH_ParseMessageWrapperView) {
+  ImmutableData data(NonEmptyString(RandomString(1024)));
+  PutRequest put(MessageId(-7), nfs_vault::DataNameAndContent(data));
+  const auto serialised(put.Serialise());
+  const auto view(ParseMessageWrapperView(serialised));
+  EXPECT_EQ(MessageAction::kPutRequest, view.action);
+  EXPECT_EQ(PutRequest::SourcePersona::value, view.source_persona);
+  EXPECT_EQ(PutRequest::DestinationPersona::value, view.destination_persona);
+  EXPECT_EQ(MessageId(-7), view.message_id);
+  // The contents are borrowed from the serialised buffer, not copied.
+  EXPECT_GE(view.contents.data(), serialised.data());
+  EXPECT_LE(view.contents.data() + view.contents.size(), serialised.data() + serialised.size());
+  EXPECT_EQ(put.contents->Serialise(), view.contents.to_string());
+  EXPECT_EQ(view.ToTypeErased(), ParseMessageWrapper(serialised));
+
+  // Unknown trailing fields are skipped, as by protobuf.
+  EXPECT_EQ(MessageId(-7), ParseMessageWrapperView(serialised + "\x30\x05").message_id);
+  EXPECT_THROW(ParseMessageWrapperView(serialised.substr(0, serialised.size() - 1)),
+               maidsafe_error);
+  EXPECT_THROW(ParseMessageWrapperView(serialised.substr(0, 4)), maidsafe_error);
+  EXPECT_THROW(ParseMessageWrapperView(serialised + "\x07"), maidsafe_error);
+  EXPECT_THROW(ParseMessageWrapperView(""), maidsafe_error);
+}
+
+TEST(MessageWrapperTest, FUNC_GroupGetResponseFanIn) {
+  // One response per group member; all but the first arrive after the get has completed.
+  typedef GetResponseFromDataManagerToDataGetter GetResponse;
+  const int kRounds(20);
+  ImmutableData data(NonEmptyString(RandomString(1024 * 1024)));
+  const auto serialised(GetResponse(MessageId(1), GetResponse::Contents(data)).Serialise());
+  auto time([&](const std::function<void()>& handle_late_response) {
+    auto start(std::chrono::steady_clock::now());
+    for (int i(0); i < kRounds * static_cast<int>(routing::Parameters::group_size - 1); ++i)
+      handle_late_response();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start).count() /
+           (kRounds * static_cast<int>(routing::Parameters::group_size - 1));
+  });
+  std::cout << "Late 1 MB get response handled with full parse in " << time([&] {
+    GetResponse response(ParseMessageWrapper(serialised));
+    EXPECT_TRUE(static_cast<bool>(response.contents->content));
+  }) << " us, with header-only parse in " << time([&] {
+    EXPECT_EQ(MessageId(1), ParseMessageWrapperView(serialised).message_id);
+  }) << " us" << std::endl;
+}
+
+TEST(MessageWrapperTest, BEH_PooledContents) {
+  typedef GetResponseFromDataManagerToDataGetter GetResponse;
+  ImmutableData data(NonEmptyString(RandomString(100)));
+  const auto parsed(ParseMessageWrapper(
+      GetResponse(MessageId(1), GetResponse::Contents(data)).Serialise()));
+  const GetResponse::Contents* first_contents(nullptr);
+  for (int i(0); i < 3; ++i) {
+    GetResponse response(parsed);
+    EXPECT_EQ(data.Serialise().data.string(), response.contents->content->data);
+    // Once freed, a message's contents block is reused by the next message of the same type.
+    if (first_contents)
+      EXPECT_EQ(first_contents, response.contents.get());
+    first_contents = response.contents.get();
+  }
+  GetResponse copy(parsed);
+  {
+    GetResponse response(parsed);
+    copy = response;
+  }
+  EXPECT_EQ(data.Serialise().data.string(), copy.contents->content->data);
+}
+
+TEST(MessageWrapperTest, FUNC_InboundContentsAllocation) {
+  typedef GetResponseFromDataManagerToDataGetter GetResponse;
+  const int kIterations(100000);
+  ImmutableData data(NonEmptyString(RandomString(100)));
+  const auto serialised_contents(GetResponse::Contents(data).Serialise());
+  const int kThreadCount(4);
+  // Only the allocation of the contents object (with its shared_ptr control block) is counted;
+  // any made by the contents' own members are the same either way.
+  auto allocations_per_message([&](const std::function<void()>& make_contents,
+                                   const std::atomic<uint64_t>& allocation_count,
+                                   int thread_count) {
+    std::vector<std::thread> threads;
+    const uint64_t initial_count(allocation_count);
+    for (int i(0); i < thread_count; ++i) {
+      threads.emplace_back([&] {
+        for (int j(0); j < kIterations; ++j)
+          make_contents();
+      });
+    }
+    for (auto& thread : threads)
+      thread.join();
+    return static_cast<double>(allocation_count - initial_count) /
+           (static_cast<double>(kIterations) * thread_count);
+  });
+  const std::function<void()> make_shared([&] {
+    std::allocate_shared<GetResponse::Contents>(CountingAllocator<GetResponse::Contents>(),
+                                                serialised_contents);
+  });
+  const std::function<void()> from_pool([&] {
+    detail::MakeContents<GetResponse::Contents>(serialised_contents);
+  });
+  const auto& pool_allocations(detail::PoolHeapAllocations());
+  std::cout << "Heap allocations of contents per inbound get response: "
+            << allocations_per_message(make_shared, g_allocation_count, 1)
+            << " with make_shared, " << allocations_per_message(from_pool, pool_allocations, 1)
+            << " from the pool, "
+            << allocations_per_message(from_pool, pool_allocations, kThreadCount)
+            << " from the pool on " << kThreadCount << " threads" << std::endl;
+}
+
+TEST(MessageWrapperTest, FUNC_SerialisePut) {
+  const int kIterations(20);
+  ImmutableData data(NonEmptyString(RandomString(1024 * 1024)));
+  PutRequest put(MessageId(1), nfs_vault::DataNameAndContent(data));
+  auto time([&](const std::function<std::string()>& serialise) {
+    size_t size(0);
+    auto start(std::chrono::steady_clock::now());
+    for (int i(0); i < kIterations; ++i)
+      size += serialise().size();
+    EXPECT_EQ(kIterations * put.Serialise().size(), size);
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start).count() / kIterations;
+  });
+  std::cout << "1 MB Put serialised via protobuf in " << time([&] {
+    return SerialiseViaProtobuf(put);
+  }) << " us, via rope in " << time([&] { return put.Serialise(); }) << " us" << std::endl;
+}
+
 /*
  TEST_F(MessageWrapperTest, BEH_SerialiseThenParse) {
   auto serialised_message(message_.Serialise());
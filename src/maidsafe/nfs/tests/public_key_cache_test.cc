@@ -0,0 +1,237 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/public_key_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/rsa.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace test {
+
+namespace {
+
+// Records fetches so that the test can complete them when it chooses.
+struct FakeNetwork {
+  FakeNetwork() : mutex(), pending() {}
+
+  detail::PublicKeyCache::FetchFunctor Fetcher() {
+    return [this](const NodeId& node_id, routing::GivePublicKeyFunctor give_key) {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending.emplace_back(node_id, std::move(give_key));
+    };
+  }
+
+  void CompleteAll(const boost::optional<asymm::PublicKey>& key) {
+    std::vector<std::pair<NodeId, routing::GivePublicKeyFunctor>> completing;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      completing.swap(pending);
+    }
+    for (auto& fetch : completing)
+      fetch.second(key);
+  }
+
+  std::mutex mutex;
+  std::vector<std::pair<NodeId, routing::GivePublicKeyFunctor>> pending;
+};
+
+}  // unnamed namespace
+
+TEST(PublicKeyCacheTest, BEH_CachesAndCoalesces) {
+  FakeNetwork network;
+  detail::PublicKeyCache cache(network.Fetcher());
+  const auto key(asymm::GenerateKeyPair().public_key);
+  const NodeId node_id(RandomString(NodeId::kSize));
+  int given(0);
+  auto give_key([&](boost::optional<asymm::PublicKey> public_key) {
+    ASSERT_TRUE(public_key);
+    EXPECT_TRUE(asymm::MatchingKeys(key, *public_key));
+    ++given;
+  });
+
+  for (int i(0); i < 5; ++i)
+    cache.GetKey(node_id, give_key);
+  EXPECT_EQ(1U, network.pending.size());
+  EXPECT_EQ(0, given);
+  network.CompleteAll(key);
+  EXPECT_EQ(5, given);
+
+  cache.GetKey(node_id, give_key);
+  EXPECT_EQ(6, given);
+  EXPECT_TRUE(network.pending.empty());
+  EXPECT_EQ(6U, cache.statistics().lookups);
+  EXPECT_EQ(1U, cache.statistics().network_fetches);
+}
+
+TEST(PublicKeyCacheTest, BEH_Expiry) {
+  FakeNetwork network;
+  detail::PublicKeyCache cache(network.Fetcher(), std::chrono::milliseconds(200),
+                               std::chrono::milliseconds(100));
+  const NodeId found(RandomString(NodeId::kSize)), missing(RandomString(NodeId::kSize));
+  int found_given(0), missing_given(0);
+  auto give_found([&](boost::optional<asymm::PublicKey> public_key) {
+    EXPECT_TRUE(public_key);
+    ++found_given;
+  });
+  auto give_missing([&](boost::optional<asymm::PublicKey> public_key) {
+    EXPECT_FALSE(public_key);
+    ++missing_given;
+  });
+
+  cache.GetKey(found, give_found);
+  network.CompleteAll(asymm::GenerateKeyPair().public_key);
+  cache.GetKey(missing, give_missing);
+  network.CompleteAll(boost::none);
+  // Both outcomes are cached...
+  cache.GetKey(found, give_found);
+  cache.GetKey(missing, give_missing);
+  EXPECT_EQ(2, found_given);
+  EXPECT_EQ(2, missing_given);
+  EXPECT_EQ(2U, cache.statistics().network_fetches);
+
+  // ...but the failure for less long.
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  cache.GetKey(found, give_found);
+  cache.GetKey(missing, give_missing);
+  EXPECT_EQ(3, found_given);
+  EXPECT_EQ(2, missing_given);
+  EXPECT_EQ(3U, cache.statistics().network_fetches);
+  network.CompleteAll(boost::none);
+  EXPECT_EQ(3, missing_given);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  cache.GetKey(found, give_found);
+  EXPECT_EQ(4U, cache.statistics().network_fetches);
+}
+
+TEST(PublicKeyCacheTest, BEH_SaveAndLoad) {
+  maidsafe::test::TestPath test_path(maidsafe::test::CreateTestPath("MaidSafe_Test_KeyCache"));
+  const auto path(*test_path / "public_keys");
+  const auto owner(asymm::GenerateKeyPair()), peer(asymm::GenerateKeyPair());
+  const NodeId node_id(RandomString(NodeId::kSize));
+  {
+    FakeNetwork network;
+    detail::PublicKeyCache cache(network.Fetcher());
+    cache.GetKey(node_id, [](boost::optional<asymm::PublicKey>) {});
+    network.CompleteAll(peer.public_key);
+    cache.GetKey(NodeId(RandomString(NodeId::kSize)), [](boost::optional<asymm::PublicKey>) {});
+    network.CompleteAll(boost::none);
+    ASSERT_TRUE(cache.Save(path, owner.private_key));
+  }
+
+  // Only the owner's signature is accepted, and failed lookups aren't saved.
+  FakeNetwork network;
+  detail::PublicKeyCache other(network.Fetcher());
+  EXPECT_EQ(0U, other.Load(path, asymm::GenerateKeyPair().public_key));
+  detail::PublicKeyCache cache(network.Fetcher());
+  EXPECT_EQ(1U, cache.Load(path, owner.public_key));
+
+  // A loaded key is given without waiting, then fetched again in the background.
+  int given(0);
+  auto give_key([&](boost::optional<asymm::PublicKey> public_key) {
+    ASSERT_TRUE(public_key);
+    EXPECT_TRUE(asymm::MatchingKeys(peer.public_key, *public_key));
+    ++given;
+  });
+  cache.GetKey(node_id, give_key);
+  EXPECT_EQ(1, given);
+  ASSERT_EQ(1U, network.pending.size());
+  cache.GetKey(node_id, give_key);
+  EXPECT_EQ(2, given);
+  EXPECT_EQ(1U, network.pending.size());
+  network.CompleteAll(peer.public_key);
+  cache.GetKey(node_id, give_key);
+  EXPECT_EQ(3, given);
+  EXPECT_TRUE(network.pending.empty());
+  EXPECT_EQ(1U, cache.statistics().network_fetches);
+
+  // A failed background fetch doesn't displace a loaded key.
+  detail::PublicKeyCache revalidated(network.Fetcher());
+  EXPECT_EQ(1U, revalidated.Load(path, owner.public_key));
+  revalidated.GetKey(node_id, give_key);
+  EXPECT_EQ(4, given);
+  network.CompleteAll(boost::none);
+  revalidated.GetKey(node_id, give_key);
+  EXPECT_EQ(5, given);
+  EXPECT_EQ(1U, revalidated.statistics().network_fetches);
+
+  // A corrupted file is ignored.
+  std::string contents;
+  ASSERT_TRUE(ReadFile(path, &contents));
+  contents[contents.size() / 2] ^= 1;
+  ASSERT_TRUE(WriteFile(path, contents));
+  detail::PublicKeyCache corrupted(network.Fetcher());
+  EXPECT_EQ(0U, corrupted.Load(path, owner.public_key));
+
+  // Saving without any keys removes the file rather than leaving the old keys in it.
+  ASSERT_TRUE(corrupted.Save(path, owner.private_key));
+  EXPECT_FALSE(boost::filesystem::exists(path));
+}
+
+TEST(PublicKeyCacheTest, FUNC_LookupsDuringChurn) {
+  // Routing repeatedly asks for the keys of a population of nodes, a few of which leave and are
+  // replaced by new ones each round.  Fetches complete immediately.
+  const size_t kNodes(64), kLeavingPerRound(4), kLookupsPerRound(1000);
+  const int kRounds(100);
+  const auto key(asymm::GenerateKeyPair().public_key);
+  detail::PublicKeyCache cache(
+      [&key](const NodeId& /*node_id*/, routing::GivePublicKeyFunctor give_key) {
+        give_key(key);
+      });
+  std::vector<NodeId> nodes;
+  for (size_t i(0); i < kNodes; ++i)
+    nodes.push_back(NodeId(RandomString(NodeId::kSize)));
+
+  auto start(std::chrono::steady_clock::now());
+  for (int round(0); round < kRounds; ++round) {
+    for (size_t i(0); i < kLeavingPerRound; ++i)
+      nodes[RandomUint32() % kNodes] = NodeId(RandomString(NodeId::kSize));
+    for (size_t i(0); i < kLookupsPerRound; ++i)
+      cache.GetKey(nodes[RandomUint32() % kNodes], [](boost::optional<asymm::PublicKey>) {});
+  }
+  auto elapsed(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  const auto statistics(cache.statistics());
+  std::cout << statistics.lookups << " key lookups at "
+            << statistics.lookups * 1000000.0 / std::max<int64_t>(elapsed, 1)
+            << " per second; " << statistics.lookups - statistics.network_fetches << " of "
+            << statistics.lookups << " network fetches avoided" << std::endl;
+  EXPECT_LE(statistics.network_fetches, kNodes + kRounds * kLeavingPerRound);
+}
+
+}  // namespace test
+
+}  // namespace nfs
+
+}  // namespace maidsafe
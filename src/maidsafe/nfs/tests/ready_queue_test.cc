@@ -0,0 +1,86 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/client/ready_queue.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+namespace maidsafe {
+
+namespace nfs_client {
+
+namespace test {
+
+TEST(ReadyQueueTest, BEH_HeldUntilReleased) {
+  ReadyQueue queue;
+  std::vector<int> run;
+  for (int i(0); i < 3; ++i)
+    queue.Run([&run, i] { run.push_back(i); });
+  EXPECT_FALSE(queue.released());
+  EXPECT_TRUE(run.empty());
+  queue.Release();
+  EXPECT_TRUE(queue.released());
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), run);
+  queue.Run([&run] { run.push_back(3); });
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), run);
+  queue.Release();
+  EXPECT_EQ(4U, run.size());
+}
+
+TEST(ReadyQueueTest, BEH_ClearDiscardsHeld) {
+  ReadyQueue queue;
+  int run(0);
+  queue.Run([&run] { ++run; });
+  queue.Clear();
+  queue.Release();
+  EXPECT_EQ(0, run);
+}
+
+TEST(ReadyQueueTest, BEH_OrderKeptWhileReleasing) {
+  const int kRequests(10000);
+  ReadyQueue queue;
+  std::mutex mutex;
+  std::vector<int> run;
+  auto request([&](int i) {
+    return [&, i] {
+      std::lock_guard<std::mutex> lock(mutex);
+      run.push_back(i);
+    };
+  });
+  for (int i(0); i < 10; ++i)
+    queue.Run(request(i));
+  std::thread requester([&] {
+    for (int i(10); i < kRequests; ++i)
+      queue.Run(request(i));
+  });
+  queue.Release();
+  requester.join();
+  ASSERT_EQ(static_cast<size_t>(kRequests), run.size());
+  for (int i(0); i < kRequests; ++i)
+    EXPECT_EQ(i, run[i]);
+}
+
+}  // namespace test
+
+}  // namespace nfs_client
+
+}  // namespace maidsafe
@@ -0,0 +1,87 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/client/send_gate.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "maidsafe/common/test.h"
+
+namespace maidsafe {
+
+namespace nfs_client {
+
+namespace test {
+
+TEST(SendGateTest, BEH_ConcurrentSendersAndStop) {
+  SendGate gate;
+  std::atomic<int> inside(0), most_inside(0), sent_after_stop(0);
+  std::atomic<bool> stopped(false);
+  std::vector<std::thread> senders;
+  for (int i(0); i < 8; ++i) {
+    senders.emplace_back([&] {
+      for (;;) {
+        SendGate::Pass pass(gate);
+        if (!pass)
+          return;
+        if (stopped)
+          ++sent_after_stop;
+        int now(++inside), most(most_inside);
+        while (now > most && !most_inside.compare_exchange_weak(most, now)) {}
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        --inside;
+      }
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  gate.Stop();
+  stopped = true;
+  EXPECT_EQ(0, inside);
+  for (auto& sender : senders)
+    sender.join();
+  EXPECT_EQ(0, sent_after_stop);
+  // Senders must not have been serialised.
+  EXPECT_GT(most_inside, 1);
+  EXPECT_FALSE(gate.Enter());
+}
+
+TEST(SendGateTest, BEH_StopWaitsForSenderInside) {
+  SendGate gate;
+  ASSERT_TRUE(gate.Enter());
+  std::atomic<bool> stop_returned(false);
+  std::thread stopper([&] {
+    gate.Stop();
+    stop_returned = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(stop_returned);
+  EXPECT_FALSE(gate.Enter());
+  EXPECT_FALSE(stop_returned);
+  gate.Leave();
+  stopper.join();
+  EXPECT_TRUE(stop_returned);
+}
+
+}  // namespace test
+
+}  // namespace nfs_client
+
+}  // namespace maidsafe
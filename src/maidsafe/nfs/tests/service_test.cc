@@ -18,6 +18,10 @@
 
 #include "maidsafe/nfs/service.h"
 
+#include <chrono>
+#include <iostream>
+#include <type_traits>
+
 #include "maidsafe/common/asio_service.h"
 #include "maidsafe/common/test.h"
 #include "maidsafe/common/types.h"
@@ -93,6 +97,115 @@ TEST_F(ServiceTest, BEH_All) {
   asio_service.Stop();
 }
 
+namespace {
+
+// Has both public and vault messages, and reports which action each message was dispatched as.
+class FakePersonaService {
+ public:
+  typedef MaidNodeServiceMessages PublicMessages;
+  typedef DataGetterServiceMessages VaultMessages;
+  typedef MessageAction HandleMessageReturnType;
+
+  template <typename Message, typename Sender, typename Receiver>
+  MessageAction HandleMessage(const Message& /*message*/, const Sender& /*sender*/,
+                              const Receiver& /*receiver*/) {
+    return Message::Action::value;
+  }
+};
+
+typedef nfs_client::MaidNodeService::PutResponse PutResponse;
+typedef nfs_client::DataGetterService::GetResponse GetResponse;
+
+// Shares PutResponse's action and personas, but has a different routing sender type.
+typedef MessageWrapper<MessageAction::kPutResponse, PutResponse::SourcePersona,
+                       routing::SingleSource, PutResponse::DestinationPersona,
+                       PutResponse::Receiver, PutResponse::Contents> SingleSourcePutResponse;
+
+// Lists SingleSourcePutResponse ahead of PutResponse, and reports whether PutResponse was the type
+// dispatched to.
+class SharedKeyPersonaService {
+ public:
+  typedef boost::variant<SingleSourcePutResponse, PutResponse> PublicMessages;
+  typedef DataGetterServiceMessages VaultMessages;
+  typedef bool HandleMessageReturnType;
+
+  template <typename Message, typename Sender, typename Receiver>
+  bool HandleMessage(const Message& /*message*/, const Sender& /*sender*/,
+                     const Receiver& /*receiver*/) {
+    return std::is_same<Message, PutResponse>::value;
+  }
+};
+
+}  // unnamed namespace
+
+TEST_F(ServiceTest, BEH_DispatchTable) {
+  Service<FakePersonaService> service(
+      std::unique_ptr<FakePersonaService>(new FakePersonaService));
+  const PutResponse::Sender sender(routing::GroupId(NodeId(RandomString(NodeId::kSize))),
+                                   routing::SingleId(NodeId(RandomString(NodeId::kSize))));
+  const PutResponse::Receiver receiver(NodeId(RandomString(NodeId::kSize)));
+  ImmutableData data(NonEmptyString(RandomString(10)));
+
+  const PutResponse public_message(PutResponse::Contents(CommonErrors::success));
+  EXPECT_EQ(MessageAction::kPutResponse,
+            service.HandleMessage(ParseMessageWrapper(public_message.Serialise()), sender,
+                                  receiver));
+  const GetResponse vault_message(GetResponse::Contents{data});
+  EXPECT_EQ(MessageAction::kGetResponse,
+            service.HandleMessage(ParseMessageWrapper(vault_message.Serialise()), sender,
+                                  receiver));
+
+  // Neither of the service's variants has a message with this action and persona combination.
+  const PutRequestFromMaidNodeToMaidManager unknown_message(
+      PutRequestFromMaidNodeToMaidManager::Contents{data});
+  EXPECT_THROW(service.HandleMessage(ParseMessageWrapper(unknown_message.Serialise()), sender,
+                                     receiver),
+               maidsafe_error);
+  // Right message, wrong routing sender type.
+  const routing::SingleSource single_sender(NodeId(RandomString(NodeId::kSize)));
+  EXPECT_THROW(service.HandleMessage(ParseMessageWrapper(public_message.Serialise()),
+                                     single_sender, receiver),
+               maidsafe_error);
+}
+
+TEST_F(ServiceTest, BEH_DispatchTableSharedKey) {
+  Service<SharedKeyPersonaService> service(
+      std::unique_ptr<SharedKeyPersonaService>(new SharedKeyPersonaService));
+  const PutResponse::Sender group_sender(routing::GroupId(NodeId(RandomString(NodeId::kSize))),
+                                         routing::SingleId(NodeId(RandomString(NodeId::kSize))));
+  const routing::SingleSource single_sender(NodeId(RandomString(NodeId::kSize)));
+  const PutResponse::Receiver receiver(NodeId(RandomString(NodeId::kSize)));
+  const auto message(
+      ParseMessageWrapper(PutResponse(PutResponse::Contents(CommonErrors::success)).Serialise()));
+
+  // Each sender type reaches the type declared with it, whichever is listed first.
+  EXPECT_TRUE(service.HandleMessage(message, group_sender, receiver));
+  EXPECT_FALSE(service.HandleMessage(message, single_sender, receiver));
+}
+
+TEST_F(ServiceTest, FUNC_DispatchTable) {
+  const int kIterations(100000);
+  Service<FakePersonaService> service(
+      std::unique_ptr<FakePersonaService>(new FakePersonaService));
+  const PutResponse::Sender sender(routing::GroupId(NodeId(RandomString(NodeId::kSize))),
+                                   routing::SingleId(NodeId(RandomString(NodeId::kSize))));
+  const PutResponse::Receiver receiver(NodeId(RandomString(NodeId::kSize)));
+  ImmutableData data(NonEmptyString(RandomString(10)));
+  auto time([&](const TypeErasedMessageWrapper& message) {
+    auto start(std::chrono::steady_clock::now());
+    for (int i(0); i < kIterations; ++i)
+      service.HandleMessage(message, sender, receiver);
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start).count() / kIterations;
+  });
+  std::cout << "Public message dispatched in "
+            << time(ParseMessageWrapper(
+                   PutResponse(PutResponse::Contents(CommonErrors::success)).Serialise()))
+            << " ns, vault message dispatched in "
+            << time(ParseMessageWrapper(GetResponse(GetResponse::Contents{data}).Serialise()))
+            << " ns" << std::endl;
+}
+
 }  // namespace test
 
 }  // namespace nfs
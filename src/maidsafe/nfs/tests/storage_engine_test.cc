@@ -0,0 +1,246 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/detail/storage_engine.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/utils.h"
+#include "maidsafe/nfs/detail/disk_backend.h"
+#include "maidsafe/nfs/detail/log_engine.h"
+
+namespace maidsafe {
+namespace nfs {
+namespace detail {
+namespace test {
+
+namespace {
+
+const DiskUsage kMaxDiskUsage(1 << 26);
+
+ContainerVersion MakeContainerVersion(ContainerVersion::Index index) {
+  return ContainerVersion(index, MakeIdentity());
+}
+
+ContainerId MakeContainerId() { return ContainerId(MutableData::Name(MakeIdentity())); }
+
+}  // unnamed namespace
+
+// Every engine is run through the same conformance tests and benchmark workload.
+class StorageEngineTest : public testing::TestWithParam<StorageEngineType> {
+ protected:
+  StorageEngineTest()
+      : engine_path_(maidsafe::test::CreateTestPath("MaidSafe_Test_StorageEngine")),
+        engine_(MakeStorageEngine(GetParam(), *engine_path_ / "engine", kMaxDiskUsage)) {}
+
+  void Reopen() {
+    engine_.reset();
+    engine_ = MakeStorageEngine(GetParam(), *engine_path_ / "engine", kMaxDiskUsage);
+  }
+
+  bool Supports(StorageEngine::Capability capability) const {
+    return (engine_->Capabilities() & capability) != 0;
+  }
+
+  maidsafe::test::TestPath engine_path_;
+  std::unique_ptr<StorageEngine> engine_;
+};
+
+TEST_P(StorageEngineTest, BEH_ChunkReferenceCounting) {
+  const ImmutableData chunk(NonEmptyString(RandomString(1000)));
+  EXPECT_THROW(engine_->GetChunk(chunk.name()).get(), std::exception);
+  EXPECT_NO_THROW(engine_->PutChunk(chunk).get());
+  EXPECT_TRUE(chunk.data() == engine_->GetChunk(chunk.name()).get().data());
+  EXPECT_EQ(DiskUsage(1000), engine_->GetCurrentDiskUsage());
+
+  // A second put adds a reference rather than another copy.
+  EXPECT_NO_THROW(engine_->PutChunk(chunk).get());
+  EXPECT_EQ(DiskUsage(1000), engine_->GetCurrentDiskUsage());
+  EXPECT_NO_THROW(engine_->DeleteChunk(chunk.name()).get());
+  EXPECT_TRUE(chunk.data() == engine_->GetChunk(chunk.name()).get().data());
+  EXPECT_NO_THROW(engine_->DeleteChunk(chunk.name()).get());
+  EXPECT_THROW(engine_->GetChunk(chunk.name()).get(), std::exception);
+  EXPECT_EQ(DiskUsage(0), engine_->GetCurrentDiskUsage());
+  EXPECT_NO_THROW(engine_->DeleteChunk(chunk.name()).get());
+}
+
+TEST_P(StorageEngineTest, BEH_DecrementReferenceCount) {
+  if (Supports(StorageEngine::kDeferredCollection)) {
+    SUCCEED() << "Decrements are collected later by this engine.";
+    return;
+  }
+  const ImmutableData chunk(NonEmptyString(RandomString(100)));
+  EXPECT_NO_THROW(engine_->PutChunk(chunk).get());
+  engine_->IncrementReferenceCount(std::vector<ImmutableData::Name>(1, chunk.name()));
+  engine_->DecrementReferenceCount(std::vector<ImmutableData::Name>(1, chunk.name()));
+  EXPECT_NO_THROW(engine_->GetChunk(chunk.name()).get());
+  engine_->DecrementReferenceCount(std::vector<ImmutableData::Name>(1, chunk.name()));
+  EXPECT_THROW(engine_->GetChunk(chunk.name()).get(), std::exception);
+}
+
+TEST_P(StorageEngineTest, BEH_Versions) {
+  const ContainerId container_id(MakeContainerId());
+  const ContainerVersion v0(MakeContainerVersion(0)), v1(MakeContainerVersion(1));
+  EXPECT_THROW(engine_->GetVersions(container_id).get(), std::exception);
+  EXPECT_THROW(engine_->PutVersion(container_id, v0, v1).get(), std::exception);
+
+  EXPECT_NO_THROW(engine_->CreateVersions(container_id, v0, 10, 1).get());
+  EXPECT_THROW(engine_->CreateVersions(container_id, v0, 10, 1).get(), std::exception);
+  EXPECT_NO_THROW(engine_->PutVersion(container_id, v0, v1).get());
+  auto tips(engine_->GetVersions(container_id).get());
+  ASSERT_EQ(1U, tips.size());
+  EXPECT_EQ(v1, tips.front());
+  auto branch(engine_->GetBranch(container_id, v1).get());
+  ASSERT_EQ(2U, branch.size());
+  EXPECT_EQ(v1, branch.front());
+  EXPECT_EQ(v0, branch.back());
+}
+
+TEST_P(StorageEngineTest, BEH_Reopen) {
+  if (!Supports(StorageEngine::kPersistent)) {
+    SUCCEED() << "Engine isn't persistent.";
+    return;
+  }
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != 10; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    EXPECT_NO_THROW(engine_->PutChunk(chunks.back()).get());
+  }
+  EXPECT_NO_THROW(engine_->PutChunk(chunks.front()).get());
+  EXPECT_NO_THROW(engine_->DeleteChunk(chunks.back().name()).get());
+  const ContainerId container_id(MakeContainerId());
+  const ContainerVersion v0(MakeContainerVersion(0));
+  EXPECT_NO_THROW(engine_->CreateVersions(container_id, v0, 10, 1).get());
+  const DiskUsage usage(engine_->GetCurrentDiskUsage());
+
+  Reopen();
+  EXPECT_EQ(usage, engine_->GetCurrentDiskUsage());
+  for (size_t i(0); i != chunks.size() - 1; ++i)
+    EXPECT_TRUE(chunks[i].data() == engine_->GetChunk(chunks[i].name()).get().data());
+  EXPECT_THROW(engine_->GetChunk(chunks.back().name()).get(), std::exception);
+  EXPECT_NO_THROW(engine_->DeleteChunk(chunks.front().name()).get());
+  EXPECT_NO_THROW(engine_->GetChunk(chunks.front().name()).get());
+  EXPECT_EQ(v0, engine_->GetVersions(container_id).get().front());
+}
+
+TEST_P(StorageEngineTest, FUNC_Workload) {
+  const int kChunkCount(1000);
+  std::vector<ImmutableData> chunks;
+  for (int i(0); i != kChunkCount; ++i)
+    chunks.emplace_back(NonEmptyString(RandomString(4096)));
+
+  auto measure([](const std::function<void()>& operation) -> int64_t {
+    const auto start(std::chrono::steady_clock::now());
+    operation();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count() + 1;
+  });
+  const auto put_time(measure([&] {
+    std::vector<boost::future<void>> futures;
+    for (const auto& chunk : chunks)
+      futures.push_back(engine_->PutChunk(chunk));
+    for (auto& future : futures)
+      EXPECT_NO_THROW(future.get());
+  }));
+  const auto get_time(measure([&] {
+    for (const auto& chunk : chunks)
+      EXPECT_NO_THROW(engine_->GetChunk(chunk.name()).get());
+  }));
+  const auto delete_time(measure([&] {
+    for (const auto& chunk : chunks)
+      EXPECT_NO_THROW(engine_->DeleteChunk(chunk.name()).get());
+  }));
+  std::cout << (GetParam() == StorageEngineType::kFilesystem ? "Filesystem" : "Log")
+            << " engine: " << kChunkCount * 1000000.0 / put_time << " puts/s, "
+            << kChunkCount * 1000000.0 / get_time << " gets/s, "
+            << kChunkCount * 1000000.0 / delete_time << " deletes/s" << std::endl;
+}
+
+INSTANTIATE_TEST_CASE_P(Engines, StorageEngineTest,
+                        testing::Values(StorageEngineType::kFilesystem, StorageEngineType::kLog));
+
+TEST(LogEngineTest, BEH_CompactionAndRecovery) {
+  maidsafe::test::TestPath engine_path(
+      maidsafe::test::CreateTestPath("MaidSafe_Test_StorageEngine"));
+  std::vector<ImmutableData> chunks;
+  {
+    LogEngine engine(*engine_path, kMaxDiskUsage);
+    for (int i(0); i != 100; ++i) {
+      chunks.emplace_back(NonEmptyString(RandomString(1000)));
+      EXPECT_NO_THROW(engine.PutChunk(chunks.back()).get());
+    }
+    for (size_t i(1); i != chunks.size(); ++i)
+      EXPECT_NO_THROW(engine.DeleteChunk(chunks[i].name()).get());
+    const auto size_before(engine.GetLogSize());
+    engine.Compact();
+    EXPECT_LT(engine.GetLogSize() * 10, size_before);
+    EXPECT_TRUE(chunks.front().data() == engine.GetChunk(chunks.front().name()).get().data());
+  }
+
+  // A torn record left by a crash mid-append is dropped on reopening.
+  {
+    std::ofstream log((*engine_path / "store.log").string(),
+                      std::ios::out | std::ios::binary | std::ios::app);
+    const char kTornHeader[] = {0, 64, 0, 0, 0, 1, 0, 0, 0, 0, 4, 0, 0};
+    log.write(kTornHeader, sizeof(kTornHeader));
+    log << RandomString(100);
+  }
+  LogEngine engine(*engine_path, kMaxDiskUsage);
+  EXPECT_TRUE(chunks.front().data() == engine.GetChunk(chunks.front().name()).get().data());
+  EXPECT_EQ(DiskUsage(1000), engine.GetCurrentDiskUsage());
+  EXPECT_NO_THROW(engine.PutChunk(chunks.back()).get());
+  EXPECT_TRUE(chunks.back().data() == engine.GetChunk(chunks.back().name()).get().data());
+}
+
+TEST(DiskBackendTest, BEH_GroupCommit) {
+  maidsafe::test::TestPath backend_path(
+      maidsafe::test::CreateTestPath("MaidSafe_Test_StorageEngine"));
+  DiskBackend disk_backend(*backend_path, kMaxDiskUsage, StorageEngineType::kFilesystem,
+                           Durability::kGroupCommit, std::chrono::milliseconds(5));
+  Network::Interface& backend(disk_backend);
+  std::vector<ImmutableData> chunks;
+  std::vector<boost::future<void>> futures;
+  for (int i(0); i != 10; ++i) {
+    chunks.emplace_back(NonEmptyString(RandomString(100)));
+    futures.push_back(backend.DoPutChunk(chunks.back()));
+  }
+  for (auto& future : futures)
+    EXPECT_NO_THROW(future.get());
+  for (const auto& chunk : chunks)
+    EXPECT_TRUE(chunk.data() == backend.DoGetChunk(chunk.name()).get().data());
+
+  const ContainerId container_id(MakeContainerId());
+  const ContainerVersion v0(MakeContainerVersion(0)), v1(MakeContainerVersion(1));
+  EXPECT_NO_THROW(backend.DoCreateSDV(container_id, v0, 10, 1).get());
+  EXPECT_NO_THROW(backend.DoPutSDVVersion(container_id, v0, v1).get());
+  EXPECT_EQ(v1, backend.DoGetBranches(container_id).get().front());
+}
+
+}  // namespace test
+}  // namespace detail
+}  // namespace nfs
+}  // namespace maidsafe
@@ -15,8 +15,13 @@
 
     See the Licences for the specific language governing permissions and limitations relating to
     use of the MaidSafe Software.                                                                 */
+#include <chrono>
 #include <iostream>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <string>
+#include <thread>
 
 #include "boost/program_options/parsers.hpp"
 #include "boost/program_options/variables_map.hpp"
@@ -25,7 +30,9 @@
 #include "maidsafe/common/log.h"
 #include "maidsafe/common/test.h"
 #include "maidsafe/passport/passport.h"
+#include "maidsafe/nfs/client/fake_store.h"
 #include "maidsafe/nfs/detail/disk_backend.h"
+#include "maidsafe/nfs/detail/memory_backend.h"
 #include "maidsafe/nfs/detail/network_backend.h"
 #include "maidsafe/nfs/tests/network_fixture.h"
 
@@ -37,18 +44,31 @@ const auto create_network_backend = []() {
       maidsafe::passport::CreateMaidAndSigner());
 };
 
-const auto create_disk_backend = []() {
-  // shared_ptr that erases folder when refcount == 0
-  const auto disk_space = ::maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore");
-
-  const auto delete_disk_backend =
-  [disk_space](maidsafe::nfs::detail::Network::Interface* interface) {
-    const std::unique_ptr<maidsafe::nfs::detail::Network::Interface> ptr(interface);
+std::function<std::shared_ptr<maidsafe::nfs::detail::Network::Interface>()> disk_backend_creator(
+    maidsafe::nfs::detail::StorageEngineType engine_type,
+    std::shared_ptr<maidsafe::nfs::FakeStore> seed = nullptr) {
+  return [engine_type, seed]() {
+    // shared_ptr that erases folder when refcount == 0
+    const auto disk_space = ::maidsafe::test::CreateTestPath("MaidSafe_Test_FakeStore");
+    if (seed)
+      seed->Snapshot(*disk_space);
+
+    const auto delete_disk_backend =
+    [disk_space](maidsafe::nfs::detail::Network::Interface* interface) {
+      const std::unique_ptr<maidsafe::nfs::detail::Network::Interface> ptr(interface);
+    };
+
+    // A seeded store keeps the seed's usage, so gets the default allowance on top of it.
+    const maidsafe::DiskUsage max_disk_usage(
+        kDefaultMaxDiskUsage.data + (seed ? seed->GetCurrentDiskUsage().data : 0));
+    return std::shared_ptr<maidsafe::nfs::detail::Network::Interface>(
+        new maidsafe::nfs::detail::DiskBackend(*disk_space, max_disk_usage, engine_type),
+        delete_disk_backend);
   };
+}
 
-  return std::shared_ptr<maidsafe::nfs::detail::Network::Interface>(
-      new maidsafe::nfs::detail::DiskBackend(*disk_space, kDefaultMaxDiskUsage),
-      delete_disk_backend);
+const auto create_memory_backend = []() {
+  return std::make_shared<maidsafe::nfs::detail::MemoryBackend>();
 };
 
 }  // namespace
@@ -59,6 +79,10 @@ int main(int argc, char** argv) {
     po::options_description description("NFS Test Options");
     description.add_options()
       ("local", "Use local disk for tests")
+      ("log", "Use local disk with the single-file log storage engine for tests")
+      ("seed", po::value<std::string>(), "Start each local disk test from a snapshot of the "
+                                         "pre-populated store at this path")
+      ("memory", "Use in-memory backend for tests")
       ("network", "Use Local Network Controller for tests");
 
     try {
@@ -69,15 +93,41 @@ int main(int argc, char** argv) {
       po::notify(options);
 
       const bool local_test = (options.count("local") != 0);
+      const bool log_test = (options.count("log") != 0);
+      const bool memory_test = (options.count("memory") != 0);
       const bool network_test = (options.count("network") != 0);
-      if (local_test && network_test) {
-        throw po::error("Cannot specify --local and --network");
+      if ((local_test ? 1 : 0) + (log_test ? 1 : 0) + (memory_test ? 1 : 0) +
+          (network_test ? 1 : 0) > 1) {
+        throw po::error("Only one of --local, --log, --memory and --network can be specified");
       }
+      if (options.count("seed") != 0 && (log_test || memory_test || network_test))
+        throw po::error("--seed can only be used with local disk tests");
 
       if (network_test) {
         maidsafe::nfs::detail::test::NetworkFixture::SetCreator(create_network_backend);
+      } else if (memory_test) {
+        maidsafe::nfs::detail::test::NetworkFixture::SetCreator(create_memory_backend);
+      } else if (log_test) {
+        maidsafe::nfs::detail::test::NetworkFixture::SetCreator(
+            disk_backend_creator(maidsafe::nfs::detail::StorageEngineType::kLog));
       } else {  // default to local
-        maidsafe::nfs::detail::test::NetworkFixture::SetCreator(create_disk_backend);
+        std::shared_ptr<maidsafe::nfs::FakeStore> seed;
+        if (options.count("seed") != 0) {
+          seed = std::make_shared<maidsafe::nfs::FakeStore>(
+              options.at("seed").as<std::string>(),
+              maidsafe::DiskUsage(std::numeric_limits<uint64_t>::max()));
+          // Until its index is built, the seed's usage is just what its ledger (if any) recorded,
+          // and that is what each test's snapshot and max usage would be based on.
+          const auto timeout(std::chrono::steady_clock::now() + std::chrono::minutes(5));
+          while (std::chrono::steady_clock::now() < timeout && !seed->GetUsageStats().exact)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          if (!seed->GetUsageStats().exact) {
+            std::cerr << "Timed out indexing the seed store" << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+        maidsafe::nfs::detail::test::NetworkFixture::SetCreator(
+            disk_backend_creator(maidsafe::nfs::detail::StorageEngineType::kFilesystem, seed));
       }
     } catch (const po::error& e) {
       // SystemLog hasn't been initialised yet
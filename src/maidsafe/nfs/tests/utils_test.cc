@@ -0,0 +1,120 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include "maidsafe/nfs/utils.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "maidsafe/common/error.h"
+#include "maidsafe/common/test.h"
+#include "maidsafe/common/data_types/immutable_data.h"
+#include "maidsafe/routing/parameters.h"
+
+#include "maidsafe/nfs/log.h"
+#include "maidsafe/nfs/client/messages.h"
+
+namespace maidsafe {
+
+namespace nfs {
+
+namespace test {
+
+class OpDataTest : public testing::Test {
+ protected:
+  typedef nfs_client::ReturnCode ReturnCode;
+
+  OpDataTest() : results_() {}
+
+  std::function<void(ReturnCode)> Callback() {
+    return [this](ReturnCode result) { results_.push_back(result); };
+  }
+
+  std::vector<ReturnCode> results_;
+};
+
+TEST_F(OpDataTest, BEH_SucceedsOnNthSuccess) {
+  OpData<ReturnCode> op_data(2, Callback());
+  op_data.HandleResponseContents(ReturnCode(CommonErrors::no_such_element));
+  op_data.HandleResponseContents(ReturnCode(CommonErrors::success));
+  EXPECT_TRUE(results_.empty());
+  op_data.HandleResponseContents(ReturnCode(CommonErrors::success));
+  ASSERT_EQ(1U, results_.size());
+  EXPECT_TRUE(IsSuccess(results_.front()));
+  op_data.HandleResponseContents(ReturnCode(CommonErrors::success));
+  EXPECT_EQ(1U, results_.size());
+}
+
+TEST_F(OpDataTest, BEH_FailsOnceSuccessIsUnreachable) {
+  OpData<ReturnCode> op_data(routing::Parameters::group_size - 1, Callback());
+  op_data.HandleResponseContents(ReturnCode(CommonErrors::no_such_element));
+  EXPECT_TRUE(results_.empty());
+  op_data.HandleResponseContents(ReturnCode(CommonErrors::invalid_parameter));
+  ASSERT_EQ(1U, results_.size());
+  EXPECT_EQ(make_error_code(CommonErrors::no_such_element), ErrorCode(results_.front()));
+}
+
+TEST_F(OpDataTest, BEH_ReturnsMostFrequentFailure) {
+  ASSERT_GE(routing::Parameters::group_size, 4U);
+  OpData<ReturnCode> op_data(1, Callback());
+  op_data.HandleResponseContents(ReturnCode(CommonErrors::invalid_parameter));
+  while (results_.empty())
+    op_data.HandleResponseContents(ReturnCode(CommonErrors::no_such_element));
+  ASSERT_EQ(1U, results_.size());
+  EXPECT_EQ(make_error_code(CommonErrors::no_such_element), ErrorCode(results_.front()));
+}
+
+TEST(NfsLogTest, BEH_ArgumentsOnlyEvaluatedWhenCompiledIn) {
+  int evaluations(0);
+  auto argument([&evaluations]() -> int { return ++evaluations; });
+  NFS_LOG(kVerbose) << argument();
+  EXPECT_EQ(NFS_LOG_ENABLED(kVerbose) ? 1 : 0, evaluations);
+  evaluations = 0;
+  NFS_LOG(kError) << argument();
+  EXPECT_EQ(NFS_LOG_ENABLED(kError) ? 1 : 0, evaluations);
+}
+
+TEST(NfsLogTest, FUNC_VerboseArgumentCost) {
+  // The verbose log arguments on the FakeStore::Put and DataGetterService get response paths.
+  const int kIterations(100);
+  const ImmutableData data(NonEmptyString(RandomString(1024 * 1024)));
+  const nfs_client::DataNameAndContentOrReturnCode get_response(data);
+  auto time([&](const std::function<void()>& log) {
+    auto start(std::chrono::steady_clock::now());
+    for (int i(0); i < kIterations; ++i)
+      log();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start).count() / kIterations;
+  });
+  std::cout << "Verbose logging per 1 MB Put and Get costs " << time([&] {
+    LOG(kVerbose) << HexSubstr(data.Serialise().data);
+    LOG(kVerbose) << HexSubstr(get_response.Serialise());
+  }) << " us with LOG and " << time([&] {
+    NFS_LOG(kVerbose) << HexSubstr(data.Serialise().data);
+    NFS_LOG(kVerbose) << HexSubstr(get_response.Serialise());
+  }) << " us with NFS_LOG (verbose " << (NFS_LOG_ENABLED(kVerbose) ? "compiled in" : "stripped")
+            << ")" << std::endl;
+}
+
+}  // namespace test
+
+}  // namespace nfs
+
+}  // namespace maidsafe
@@ -0,0 +1,81 @@
+/*  Copyright 2014 MaidSafe.net limited
+
+    This MaidSafe Software is licensed to you under (1) the MaidSafe.net Commercial License,
+    version 1.0 or later, or (2) The General Public License (GPL), version 3, depending on which
+    licence you accepted on initial access to the Software (the "Licences").
+
+    By contributing code to the MaidSafe Software, or to this project generally, you agree to be
+    bound by the terms of the MaidSafe Contributor Agreement, version 1.0, found in the root
+    directory of this project at LICENSE, COPYING and CONTRIBUTOR respectively and also
+    available at: http://www.maidsafe.net/licenses
+
+    Unless required by applicable law or agreed to in writing, the MaidSafe Software distributed
+    under the GPL Licence is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS
+    OF ANY KIND, either express or implied.
+
+    See the Licences for the specific language governing permissions and limitations relating to
+    use of the MaidSafe Software.                                                                 */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "maidsafe/common/log.h"
+#include "maidsafe/nfs/client/fake_store.h"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+int Usage() {
+  std::cerr << "Usage:\n"
+            << "  fake_store_archive export <store directory> <archive> [--compress]\n"
+            << "  fake_store_archive import <archive> <store directory>" << std::endl;
+  return EXIT_FAILURE;
+}
+
+void PrintThroughput(const fs::path& archive_path,
+                     const std::chrono::steady_clock::time_point& start) {
+  const auto elapsed(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  const double megabytes(static_cast<double>(fs::file_size(archive_path)) / (1024 * 1024));
+  std::cout << megabytes << " MB in " << elapsed << " ms ("
+            << (megabytes * 1000.0) / (elapsed + 1) << " MB/s)" << std::endl;
+}
+
+}  // unnamed namespace
+
+int main(int argc, char** argv) {
+  maidsafe::log::Logging::Instance().Initialise(argc, argv);
+  if (argc < 4)
+    return Usage();
+
+  const std::string command(argv[1]);
+  const maidsafe::DiskUsage kUnlimited(std::numeric_limits<uint64_t>::max());
+  try {
+    if (command == "export") {
+      const bool compress(argc > 4 && std::string(argv[4]) == "--compress");
+      const fs::path archive_path(argv[3]);
+      const auto start(std::chrono::steady_clock::now());
+      maidsafe::nfs::FakeStore::Export(argv[2], archive_path, compress);
+      PrintThroughput(archive_path, start);
+    } else if (command == "import") {
+      const fs::path archive_path(argv[2]);
+      maidsafe::nfs::FakeStore store(argv[3], kUnlimited);
+      const auto start(std::chrono::steady_clock::now());
+      store.Import(archive_path);
+      PrintThroughput(archive_path, start);
+    } else {
+      return Usage();
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Failed: " << boost::diagnostic_information(e) << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
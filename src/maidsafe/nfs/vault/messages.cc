@@ -413,11 +413,82 @@ bool operator==(const DataNameAndContent& lhs, const DataNameAndContent& rhs) {
   return lhs.name == rhs.name && lhs.content == rhs.content;
 }
 
+void AppendSerialised(nfs::SerialisedRope& rope, int field_number,
+                      const DataNameAndContent& contents) {
+  // Field numbers from protobuf::DataNameAndContent.
+  nfs::SerialisedRope contents_rope;
+  contents_rope.AppendBytesField(1, contents.name.Serialise());
+  contents_rope.AppendBytesFieldReference(2, contents.content.string());
+  rope.AppendEmbeddedField(field_number, std::move(contents_rope));
+}
+
 void swap(DataNameAndContent& lhs, DataNameAndContent& rhs) MAIDSAFE_NOEXCEPT {
   using std::swap;
   swap(lhs.name, rhs.name);
   swap(lhs.content, rhs.content);
 }
+
+// ========================== DataNamesAndContents =================================================
+
+DataNamesAndContents::DataNamesAndContents(
+    std::vector<DataNameAndContent> data_names_and_contents_in)
+    : data_names_and_contents(std::move(data_names_and_contents_in)) {}
+
+DataNamesAndContents::DataNamesAndContents() : data_names_and_contents() {}
+
+DataNamesAndContents::DataNamesAndContents(const DataNamesAndContents& other)
+    : data_names_and_contents(other.data_names_and_contents) {}
+
+DataNamesAndContents::DataNamesAndContents(DataNamesAndContents&& other)
+    : data_names_and_contents(std::move(other.data_names_and_contents)) {}
+
+DataNamesAndContents& DataNamesAndContents::operator=(DataNamesAndContents other) {
+  swap(*this, other);
+  return *this;
+}
+
+DataNamesAndContents::DataNamesAndContents(const std::string& serialised_copy)
+    : data_names_and_contents() {
+  protobuf::DataNamesAndContents proto_copy;
+  if (!proto_copy.ParseFromString(serialised_copy))
+    BOOST_THROW_EXCEPTION(MakeError(CommonErrors::parsing_error));
+  data_names_and_contents.reserve(proto_copy.data_names_and_contents_size());
+  for (int index(0); index < proto_copy.data_names_and_contents_size(); ++index) {
+    const auto& proto_item(proto_copy.data_names_and_contents(index));
+    DataNameAndContent item;
+    item.name = DataName(proto_item.serialised_name());
+    item.content = NonEmptyString(proto_item.content());
+    data_names_and_contents.push_back(std::move(item));
+  }
+}
+
+std::string DataNamesAndContents::Serialise() const {
+  protobuf::DataNamesAndContents proto_copy;
+  for (const auto& item : data_names_and_contents) {
+    auto proto_item(proto_copy.add_data_names_and_contents());
+    proto_item->set_serialised_name(item.name.Serialise());
+    proto_item->set_content(item.content.string());
+  }
+  return proto_copy.SerializeAsString();
+}
+
+bool operator==(const DataNamesAndContents& lhs, const DataNamesAndContents& rhs) {
+  return lhs.data_names_and_contents == rhs.data_names_and_contents;
+}
+
+void swap(DataNamesAndContents& lhs, DataNamesAndContents& rhs) MAIDSAFE_NOEXCEPT {
+  using std::swap;
+  swap(lhs.data_names_and_contents, rhs.data_names_and_contents);
+}
+
+void AppendSerialised(nfs::SerialisedRope& rope, int field_number,
+                      const DataNamesAndContents& contents) {
+  // Field numbers from protobuf::DataNamesAndContents.
+  nfs::SerialisedRope contents_rope;
+  for (const auto& item : contents.data_names_and_contents)
+    AppendSerialised(contents_rope, 1, item);
+  rope.AppendEmbeddedField(field_number, std::move(contents_rope));
+}
 // ========================== Content ==============================================================
 
 Content::Content(const std::string& data_in) : data(data_in) {}